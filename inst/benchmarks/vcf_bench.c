@@ -0,0 +1,745 @@
+// Benchmark harness for the VCF/BCF Arrow stream and the DuckDB bcf_read scan
+//
+// Generates synthetic VCF/BCF files (parameterised by samples, INFO and FORMAT
+// fields, CSQ transcripts per record and record count), reads them through
+// vcf_arrow_stream_init()/get_next() and, when a DuckDB CLI and the bcf_reader
+// extension are given, through bcf_read() and a bcf_read() -> Parquet COPY
+// (reader "parquet", the conversion stage). Each run happens in a forked child
+// so that peak RSS is per case and stage. Results are printed as TSV and can be
+// checked against a baseline file (see Makefile: make bench, make check, make
+// baseline); cases whose record count differs from the baseline are skipped.
+//
+// Usage:
+//   vcf_bench [--data DIR] [--repeat N] [--scale X] [--case NAME]
+//             [--custom SAMPLES,INFO,FORMAT,CSQ,RECORDS]
+//             [--duckdb PATH --extension PATH]
+//             [--baseline FILE] [--tolerance X]
+//
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_arrow_stream.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// =============================================================================
+// Outside R
+// =============================================================================
+
+// vcf_arrow_stream.c reports header/spec mismatches through Rf_warning()
+void Rf_warning(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "[vcf_bench] ");
+    vfprintf(stderr, fmt, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+}
+
+// Allocations made by the package code linked into this binary (not htslib),
+// counted through the linker's --wrap (see Makefile)
+static uint64_t bench_n_allocs;
+
+#ifdef VCF_BENCH_COUNT_ALLOCS
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    bench_n_allocs++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    bench_n_allocs++;
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    bench_n_allocs++;
+    return __real_realloc(ptr, size);
+}
+#endif
+
+// =============================================================================
+// Cases
+// =============================================================================
+
+typedef struct {
+    char name[64];
+    int n_samples;
+    int n_info;               // INFO fields besides CSQ
+    int n_format;             // FORMAT fields (GT, AD, DP, GQ, PL, then floats)
+    int n_csq;                // CSQ transcripts per record (0 = no CSQ)
+    int n_records;
+} bench_case_t;
+
+// Sites only, growing sample counts (FORMAT decoding must stay linear in
+// samples), and VEP parsing
+static const bench_case_t default_cases[] = {
+    {"sites",          0, 8, 0, 0, 200000},
+    {"samples_10",    10, 4, 5, 0,  50000},
+    {"samples_100",  100, 4, 5, 0,  10000},
+    {"samples_1000", 1000, 4, 5, 0,  1000},
+    {"csq_5",          0, 4, 0, 5,  50000},
+};
+
+#define N_DEFAULT_CASES ((int)(sizeof(default_cases) / sizeof(default_cases[0])))
+
+static const char* format_names[] = {"GT", "AD", "DP", "GQ", "PL"};
+
+#define CSQ_FORMAT "Allele|Consequence|IMPACT|SYMBOL|Gene|Feature_type|Feature|" \
+                   "BIOTYPE|EXON|INTRON|HGVSc|HGVSp|cDNA_position|CDS_position|" \
+                   "Protein_position|Amino_acids|Codons|Existing_variation|AF|gnomADe_AF"
+
+typedef struct {
+    const char* reader;       // "arrow" or "bcf_read"
+    const char* format;       // "bcf" or "vcf.gz"
+    double seconds;           // Best of the repeats
+    int64_t records;          // Rows returned
+    double peak_rss_mb;       // Max over the repeats
+    double allocs_per_record; // < 0 when not measured
+    int64_t file_bytes;
+} bench_result_t;
+
+// =============================================================================
+// Synthetic data
+// =============================================================================
+
+static uint64_t bench_rng = 0x9E3779B97F4A7C15ULL;
+
+// xorshift64*, fixed seed so generated files are identical across runs
+static uint32_t bench_rand(void) {
+    bench_rng ^= bench_rng >> 12;
+    bench_rng ^= bench_rng << 25;
+    bench_rng ^= bench_rng >> 27;
+    return (uint32_t)((bench_rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static bcf_hdr_t* bench_header(const bench_case_t* c) {
+    bcf_hdr_t* hdr = bcf_hdr_init("w");
+    char line[512];
+
+    for (int i = 1; i <= 4; i++) {
+        snprintf(line, sizeof(line), "##contig=<ID=chr%d,length=200000000>", i);
+        bcf_hdr_append(hdr, line);
+    }
+    for (int i = 0; i < c->n_info; i++) {
+        switch (i % 4) {
+        case 0:
+            snprintf(line, sizeof(line),
+                     "##INFO=<ID=I%d,Number=1,Type=Integer,Description=\"Integer\">", i);
+            break;
+        case 1:
+            snprintf(line, sizeof(line),
+                     "##INFO=<ID=F%d,Number=A,Type=Float,Description=\"Per-allele float\">", i);
+            break;
+        case 2:
+            snprintf(line, sizeof(line),
+                     "##INFO=<ID=S%d,Number=1,Type=String,Description=\"String\">", i);
+            break;
+        default:
+            snprintf(line, sizeof(line),
+                     "##INFO=<ID=G%d,Number=0,Type=Flag,Description=\"Flag\">", i);
+            break;
+        }
+        bcf_hdr_append(hdr, line);
+    }
+    if (c->n_csq > 0) {
+        bcf_hdr_append(hdr, "##INFO=<ID=CSQ,Number=.,Type=String,Description=\"Consequence "
+                            "annotations from Ensembl VEP. Format: " CSQ_FORMAT "\">");
+    }
+    if (c->n_samples > 0) {
+        static const char* format_lines[] = {
+            "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">",
+            "##FORMAT=<ID=AD,Number=R,Type=Integer,Description=\"Allelic depths\">",
+            "##FORMAT=<ID=DP,Number=1,Type=Integer,Description=\"Read depth\">",
+            "##FORMAT=<ID=GQ,Number=1,Type=Integer,Description=\"Genotype quality\">",
+            "##FORMAT=<ID=PL,Number=G,Type=Integer,Description=\"Phred-scaled likelihoods\">",
+        };
+        for (int i = 0; i < c->n_format; i++) {
+            if (i < 5) {
+                bcf_hdr_append(hdr, format_lines[i]);
+            } else {
+                snprintf(line, sizeof(line),
+                         "##FORMAT=<ID=FX%d,Number=1,Type=Float,Description=\"Float\">", i);
+                bcf_hdr_append(hdr, line);
+            }
+        }
+        for (int i = 0; i < c->n_samples; i++) {
+            snprintf(line, sizeof(line), "S%05d", i);
+            bcf_hdr_add_sample(hdr, line);
+        }
+    }
+    bcf_hdr_add_sample(hdr, NULL);
+    if (bcf_hdr_sync(hdr) < 0) {
+        bcf_hdr_destroy(hdr);
+        return NULL;
+    }
+    return hdr;
+}
+
+static void bench_csq(kstring_t* s, const bench_case_t* c, const char* alt) {
+    static const char* consequences[] = {
+        "missense_variant", "synonymous_variant", "intron_variant",
+        "upstream_gene_variant", "3_prime_UTR_variant"
+    };
+    static const char* impacts[] = {"MODERATE", "LOW", "MODIFIER", "MODIFIER", "MODIFIER"};
+
+    s->l = 0;
+    for (int t = 0; t < c->n_csq; t++) {
+        int k = bench_rand() % 5;
+        uint32_t gene = bench_rand() % 20000;
+        if (t > 0) kputc(',', s);
+        ksprintf(s, "%s|%s|%s|GENE%u|ENSG%011u|Transcript|ENST%011u|protein_coding|"
+                    "%d/12||ENST%011u.1:c.%uA>G|ENSP%011u.1:p.Lys%uGlu|%u|%u|%u|K/E|"
+                    "Aag/Gag|rs%u|0.%04u|0.%04u",
+                 alt, consequences[k], impacts[k], gene, gene, gene * 10 + t,
+                 1 + t % 12, gene * 10 + t, bench_rand() % 3000,
+                 gene * 10 + t, bench_rand() % 1000, bench_rand() % 3000,
+                 bench_rand() % 3000, bench_rand() % 1000, bench_rand(),
+                 bench_rand() % 10000, bench_rand() % 10000);
+    }
+}
+
+static int bench_generate(const bench_case_t* c, int vcf, const char* path) {
+    htsFile* fp = hts_open(path, vcf ? "wz" : "wb");
+    if (!fp) {
+        fprintf(stderr, "Cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    bench_rng = 0x9E3779B97F4A7C15ULL;
+    bcf_hdr_t* hdr = bench_header(c);
+    if (!hdr || bcf_hdr_write(fp, hdr) < 0) {
+        if (hdr) bcf_hdr_destroy(hdr);
+        hts_close(fp);
+        unlink(path);
+        return -1;
+    }
+
+    // At most two ALT alleles: AD has 3 values per sample, PL 6
+    int ns = c->n_samples;
+    int32_t* gt = (int32_t*)malloc(sizeof(int32_t) * (ns * 2 + 1));
+    int32_t* vals = (int32_t*)malloc(sizeof(int32_t) * (ns * 6 + 1));
+    float* fvals = (float*)malloc(sizeof(float) * (ns + 2));
+    int pass = bcf_hdr_id2int(hdr, BCF_DT_ID, "PASS");
+    bcf1_t* rec = bcf_init();
+    kstring_t str = {0, 0, NULL};
+    static const char* bases[] = {"A", "C", "G", "T"};
+    int64_t pos = 0;
+    int ret = 0;
+
+    for (int r = 0; r < c->n_records && ret == 0; r++) {
+        int rid = (int)((int64_t)r * 4 / c->n_records);
+        if (r == 0 || rid != (int)((int64_t)(r - 1) * 4 / c->n_records)) pos = 0;
+        pos += 1 + bench_rand() % 200;
+
+        bcf_clear(rec);
+        rec->rid = rid;
+        rec->pos = pos;
+        rec->qual = (float)(bench_rand() % 10000) / 10.0f;
+
+        int n_alt = (bench_rand() % 10 == 0) ? 2 : 1;
+        int ref = bench_rand() % 4;
+        str.l = 0;
+        kputs(bases[ref], &str);
+        for (int a = 1; a <= n_alt; a++) {
+            kputc(',', &str);
+            kputs(bases[(ref + a) % 4], &str);
+        }
+        bcf_update_alleles_str(hdr, rec, str.s);
+        if (r % 4 == 0) {
+            str.l = 0;
+            ksprintf(&str, "rs%d", r + 1);
+            bcf_update_id(hdr, rec, str.s);
+        }
+        bcf_update_filter(hdr, rec, &pass, 1);
+
+        char key[32];
+        for (int i = 0; i < c->n_info; i++) {
+            switch (i % 4) {
+            case 0:
+                snprintf(key, sizeof(key), "I%d", i);
+                vals[0] = bench_rand() % 1000;
+                bcf_update_info_int32(hdr, rec, key, vals, 1);
+                break;
+            case 1:
+                snprintf(key, sizeof(key), "F%d", i);
+                for (int a = 0; a < n_alt; a++) fvals[a] = (float)(bench_rand() % 1000) / 1000.0f;
+                bcf_update_info_float(hdr, rec, key, fvals, n_alt);
+                break;
+            case 2:
+                snprintf(key, sizeof(key), "S%d", i);
+                str.l = 0;
+                ksprintf(&str, "value_%u", bench_rand() % 100);
+                bcf_update_info_string(hdr, rec, key, str.s);
+                break;
+            default:
+                snprintf(key, sizeof(key), "G%d", i);
+                if (bench_rand() % 2) bcf_update_info_flag(hdr, rec, key, NULL, 1);
+                break;
+            }
+        }
+        if (c->n_csq > 0) {
+            bench_csq(&str, c, bases[(ref + 1) % 4]);
+            bcf_update_info_string(hdr, rec, "CSQ", str.s);
+        }
+
+        if (ns > 0) {
+            int n_all = n_alt + 1;
+            int n_gl = n_all * (n_all + 1) / 2;
+            for (int f = 0; f < c->n_format; f++) {
+                const char* name = f < 5 ? format_names[f] : NULL;
+                if (f == 0) {
+                    for (int s = 0; s < ns; s++) {
+                        gt[2 * s] = bcf_gt_unphased(bench_rand() % n_all);
+                        gt[2 * s + 1] = bcf_gt_unphased(bench_rand() % n_all);
+                    }
+                    bcf_update_genotypes(hdr, rec, gt, ns * 2);
+                } else if (f == 1 || f == 4) {
+                    int per = f == 1 ? n_all : n_gl;
+                    for (int i = 0; i < ns * per; i++) vals[i] = bench_rand() % 60;
+                    bcf_update_format_int32(hdr, rec, name, vals, ns * per);
+                } else if (f < 5) {
+                    for (int s = 0; s < ns; s++) vals[s] = bench_rand() % 99;
+                    bcf_update_format_int32(hdr, rec, name, vals, ns);
+                } else {
+                    snprintf(key, sizeof(key), "FX%d", f);
+                    for (int s = 0; s < ns; s++) fvals[s] = (float)(bench_rand() % 1000) / 100.0f;
+                    bcf_update_format_float(hdr, rec, key, fvals, ns);
+                }
+            }
+        }
+
+        if (bcf_write(fp, hdr, rec) < 0) ret = -1;
+    }
+
+    free(str.s);
+    free(gt);
+    free(vals);
+    free(fvals);
+    bcf_destroy(rec);
+    bcf_hdr_destroy(hdr);
+    if (hts_close(fp) != 0) ret = -1;
+    if (ret != 0) unlink(path);
+    return ret;
+}
+
+// =============================================================================
+// Runs
+// =============================================================================
+
+typedef struct {
+    int ok;
+    double seconds;
+    int64_t records;
+    uint64_t allocs;
+} bench_child_t;
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double bench_rss_mb(const struct rusage* ru) {
+#ifdef __APPLE__
+    return ru->ru_maxrss / (1024.0 * 1024.0);  // bytes
+#else
+    return ru->ru_maxrss / 1024.0;             // kilobytes
+#endif
+}
+
+// Runs in the child: the whole file through the Arrow stream, every column
+static void bench_arrow(const bench_case_t* c, const char* path, bench_child_t* out) {
+    vcf_arrow_options_t opts;
+    vcf_arrow_options_init(&opts);
+    opts.parse_vep = c->n_csq > 0;
+
+    struct ArrowArrayStream stream;
+    memset(&stream, 0, sizeof(stream));
+    uint64_t allocs0 = bench_n_allocs;
+    double t0 = bench_now();
+
+    if (vcf_arrow_stream_init(&stream, path, &opts) != 0) {
+        const char* err = stream.get_last_error ? stream.get_last_error(&stream) : NULL;
+        fprintf(stderr, "%s: %s\n", path, err ? err : "stream init failed");
+        if (stream.release) stream.release(&stream);
+        return;
+    }
+
+    struct ArrowSchema schema;
+    if (stream.get_schema(&stream, &schema) == 0) schema.release(&schema);
+
+    int64_t records = 0;
+    for (;;) {
+        struct ArrowArray batch;
+        if (stream.get_next(&stream, &batch) != 0) {
+            const char* err = stream.get_last_error(&stream);
+            fprintf(stderr, "%s: %s\n", path, err ? err : "read failed");
+            stream.release(&stream);
+            return;
+        }
+        if (!batch.release) break;
+        records += batch.length;
+        batch.release(&batch);
+    }
+    stream.release(&stream);
+
+    out->seconds = bench_now() - t0;
+    out->records = records;
+    out->allocs = bench_n_allocs - allocs0;
+    out->ok = 1;
+}
+
+// Runs in the child: through the DuckDB CLI, either a bcf_read() scan with
+// the output discarded ("bcf_read") or a Parquet conversion ("parquet",
+// written next to the input and removed by the parent)
+static void bench_bcf_read(const char* duckdb, const char* extension, const char* path,
+                           const char* reader) {
+    int fds[2];
+    if (pipe(fds) != 0) _exit(1);
+    pid_t pid = fork();
+    if (pid < 0) _exit(1);
+    if (pid == 0) {
+        dup2(fds[0], STDIN_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execlp(duckdb, duckdb, "-unsigned", (char*)NULL);
+        _exit(127);
+    }
+    close(fds[0]);
+    FILE* sql = fdopen(fds[1], "w");
+    fprintf(sql, ".bail on\n.mode trash\nLOAD '%s';\n", extension);
+    if (strcmp(reader, "parquet") == 0) {
+        fprintf(sql, "COPY (SELECT * FROM bcf_read('%s')) TO '%s.bench.parquet' (FORMAT PARQUET);\n",
+                path, path);
+    } else {
+        fprintf(sql, "SELECT * FROM bcf_read('%s');\n", path);
+    }
+    fclose(sql);
+    int status;
+    waitpid(pid, &status, 0);
+    _exit(WIFEXITED(status) ? WEXITSTATUS(status) : 1);
+}
+
+// One run in a fresh process; returns 0 and fills seconds/records/rss/allocs
+static int bench_run_once(const bench_case_t* c, const char* path, const char* reader,
+                          const char* duckdb, const char* extension,
+                          bench_child_t* res, double* rss_mb) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+
+    double t0 = bench_now();
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        close(fds[0]);
+        if (strcmp(reader, "arrow") == 0) {
+            bench_child_t out;
+            memset(&out, 0, sizeof(out));
+            bench_arrow(c, path, &out);
+            ssize_t w = write(fds[1], &out, sizeof(out));
+            _exit(w == (ssize_t)sizeof(out) && out.ok ? 0 : 1);
+        }
+        bench_bcf_read(duckdb, extension, path, reader);
+    }
+    close(fds[1]);
+
+    memset(res, 0, sizeof(*res));
+    ssize_t got = read(fds[0], res, sizeof(*res));
+    close(fds[0]);
+
+    int status;
+    struct rusage ru;
+    if (wait4(pid, &status, 0, &ru) < 0) return -1;
+    double elapsed = bench_now() - t0;
+    if (strcmp(reader, "parquet") == 0) {
+        char parquet[4200];
+        snprintf(parquet, sizeof(parquet), "%s.bench.parquet", path);
+        unlink(parquet);
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return -1;
+
+    if (strcmp(reader, "arrow") == 0) {
+        if (got != (ssize_t)sizeof(*res) || !res->ok) return -1;
+    } else {
+        // Includes CLI startup; the scan dominates at benchmark sizes
+        res->ok = 1;
+        res->seconds = elapsed;
+        res->records = c->n_records;
+        res->allocs = 0;
+    }
+    *rss_mb = bench_rss_mb(&ru);
+    return 0;
+}
+
+static int bench_run(const bench_case_t* c, const char* path, const char* reader,
+                     const char* format, int repeat, const char* duckdb,
+                     const char* extension, bench_result_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->reader = reader;
+    out->format = format;
+    out->seconds = -1;
+    out->allocs_per_record = -1;
+
+    struct stat st;
+    out->file_bytes = stat(path, &st) == 0 ? (int64_t)st.st_size : 0;
+
+    for (int i = 0; i < repeat; i++) {
+        bench_child_t res;
+        double rss;
+        if (bench_run_once(c, path, reader, duckdb, extension, &res, &rss) != 0) {
+            fprintf(stderr, "%s %s %s: run failed\n", c->name, reader, format);
+            return -1;
+        }
+        if (out->seconds < 0 || res.seconds < out->seconds) out->seconds = res.seconds;
+        if (rss > out->peak_rss_mb) out->peak_rss_mb = rss;
+        out->records = res.records;
+#ifdef VCF_BENCH_COUNT_ALLOCS
+        if (strcmp(reader, "arrow") == 0 && res.records > 0) {
+            out->allocs_per_record = (double)res.allocs / res.records;
+        }
+#endif
+    }
+    return 0;
+}
+
+// =============================================================================
+// Report and baseline
+// =============================================================================
+
+#define BENCH_HEADER "case\treader\tformat\trecords\tsamples\tseconds\trecords_per_sec\t" \
+                     "mb_per_sec\tns_per_genotype\tpeak_rss_mb\tallocs_per_record"
+
+static void bench_print(FILE* out, const bench_case_t* c, const bench_result_t* r) {
+    double secs = r->seconds > 0 ? r->seconds : 1e-9;
+    int64_t genotypes = r->records * (c->n_samples > 0 ? c->n_samples : 1);
+    fprintf(out, "%s\t%s\t%s\t%" PRId64 "\t%d\t%.4f\t%.0f\t%.2f\t%.2f\t%.1f\t",
+            c->name, r->reader, r->format, r->records, c->n_samples, r->seconds,
+            r->records / secs, r->file_bytes / secs / 1e6,
+            genotypes > 0 ? secs * 1e9 / genotypes : 0.0, r->peak_rss_mb);
+    if (r->allocs_per_record >= 0) {
+        fprintf(out, "%.2f\n", r->allocs_per_record);
+    } else {
+        fprintf(out, "NA\n");
+    }
+}
+
+typedef struct {
+    char key[128];            // case/reader/format
+    int64_t records;          // Cases only compare at the same size
+    double records_per_sec;
+    double peak_rss_mb;
+    double allocs_per_record; // < 0 when NA
+} bench_baseline_t;
+
+static int bench_read_baseline(const char* path, bench_baseline_t** out) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Cannot read baseline %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    int n = 0, cap = 0;
+    bench_baseline_t* b = NULL;
+    char line[1024];
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#' || strncmp(line, "case\t", 5) == 0) continue;
+        char name[64], reader[32], format[16], allocs[32];
+        double secs, rps, mbps, nspg, rss;
+        long long records;
+        int samples;
+        if (sscanf(line, "%63s %31s %15s %lld %d %lf %lf %lf %lf %lf %31s",
+                   name, reader, format, &records, &samples, &secs, &rps,
+                   &mbps, &nspg, &rss, allocs) != 11) {
+            continue;
+        }
+        if (n == cap) {
+            cap = cap ? cap * 2 : 16;
+            b = (bench_baseline_t*)realloc(b, cap * sizeof(*b));
+        }
+        snprintf(b[n].key, sizeof(b[n].key), "%s/%s/%s", name, reader, format);
+        b[n].records = records;
+        b[n].records_per_sec = rps;
+        b[n].peak_rss_mb = rss;
+        b[n].allocs_per_record = strcmp(allocs, "NA") == 0 ? -1 : atof(allocs);
+        n++;
+    }
+    fclose(fp);
+    *out = b;
+    return n;
+}
+
+// Throughput and memory get a tolerance (machines differ); allocation
+// counts are deterministic and only allow a small margin. A case run at
+// another --scale than its baseline has other fixed costs per record and
+// is skipped
+static int bench_check(const bench_case_t* c, const bench_result_t* r,
+                       const bench_baseline_t* base, int n_base, double tol) {
+    char key[128];
+    snprintf(key, sizeof(key), "%s/%s/%s", c->name, r->reader, r->format);
+    for (int i = 0; i < n_base; i++) {
+        if (strcmp(base[i].key, key) != 0) continue;
+        if (base[i].records != r->records) {
+            fprintf(stderr, "SKIP %s: %" PRId64 " records, baseline %" PRId64 "\n",
+                    key, r->records, base[i].records);
+            return 0;
+        }
+        int bad = 0;
+        double rps = r->records / (r->seconds > 0 ? r->seconds : 1e-9);
+        if (rps < base[i].records_per_sec * (1.0 - tol)) {
+            fprintf(stderr, "REGRESSION %s: %.0f records/s, baseline %.0f\n",
+                    key, rps, base[i].records_per_sec);
+            bad = 1;
+        }
+        if (r->peak_rss_mb > base[i].peak_rss_mb * (1.0 + tol) + 16.0) {
+            fprintf(stderr, "REGRESSION %s: peak RSS %.1f MB, baseline %.1f MB\n",
+                    key, r->peak_rss_mb, base[i].peak_rss_mb);
+            bad = 1;
+        }
+        if (r->allocs_per_record >= 0 && base[i].allocs_per_record >= 0 &&
+            r->allocs_per_record > base[i].allocs_per_record * 1.05 + 0.5) {
+            fprintf(stderr, "REGRESSION %s: %.2f allocations/record, baseline %.2f\n",
+                    key, r->allocs_per_record, base[i].allocs_per_record);
+            bad = 1;
+        }
+        return bad;
+    }
+    return 0;  // Not in the baseline
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+static void usage(void) {
+    fprintf(stderr,
+            "Usage: vcf_bench [--data DIR] [--repeat N] [--scale X] [--case NAME]\n"
+            "                 [--custom SAMPLES,INFO,FORMAT,CSQ,RECORDS]\n"
+            "                 [--duckdb PATH --extension PATH]\n"
+            "                 [--baseline FILE] [--tolerance X]\n");
+}
+
+int main(int argc, char** argv) {
+    const char* data_dir = "bench_data";
+    const char* only = NULL;
+    const char* duckdb = NULL;
+    const char* extension = NULL;
+    const char* baseline = NULL;
+    double scale = 1.0, tol = 0.3;
+    int repeat = 3;
+    bench_case_t cases[N_DEFAULT_CASES + 1];
+    int n_cases = N_DEFAULT_CASES;
+    memcpy(cases, default_cases, sizeof(default_cases));
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "--help") == 0 || strcmp(a, "-h") == 0) {
+            usage();
+            return 0;
+        }
+        if (!v) {
+            usage();
+            return 2;
+        }
+        i++;
+        if (strcmp(a, "--data") == 0) data_dir = v;
+        else if (strcmp(a, "--repeat") == 0) repeat = atoi(v);
+        else if (strcmp(a, "--scale") == 0) scale = atof(v);
+        else if (strcmp(a, "--case") == 0) only = v;
+        else if (strcmp(a, "--duckdb") == 0) duckdb = v;
+        else if (strcmp(a, "--extension") == 0) extension = v;
+        else if (strcmp(a, "--baseline") == 0) baseline = v;
+        else if (strcmp(a, "--tolerance") == 0) tol = atof(v);
+        else if (strcmp(a, "--custom") == 0) {
+            bench_case_t* c = &cases[n_cases];
+            memset(c, 0, sizeof(*c));
+            if (sscanf(v, "%d,%d,%d,%d,%d", &c->n_samples, &c->n_info, &c->n_format,
+                       &c->n_csq, &c->n_records) != 5 || c->n_records <= 0) {
+                usage();
+                return 2;
+            }
+            snprintf(c->name, sizeof(c->name), "custom_%d_%d_%d_%d",
+                     c->n_samples, c->n_info, c->n_format, c->n_csq);
+            if (c->n_samples > 0 && c->n_format == 0) c->n_format = 1;
+            only = c->name;
+            n_cases++;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (repeat < 1 || scale <= 0 || (duckdb && !extension)) {
+        usage();
+        return 2;
+    }
+
+    bench_baseline_t* base = NULL;
+    int n_base = 0;
+    if (baseline && (n_base = bench_read_baseline(baseline, &base)) < 0) return 2;
+
+    if (mkdir(data_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create %s: %s\n", data_dir, strerror(errno));
+        return 2;
+    }
+
+    static const char* formats[] = {"bcf", "vcf.gz"};
+    int failed = 0, regressions = 0;
+    printf("%s\n", BENCH_HEADER);
+    fflush(stdout);
+
+    for (int i = 0; i < n_cases; i++) {
+        bench_case_t c = cases[i];
+        if (only && strcmp(only, c.name) != 0) continue;
+        if (i < N_DEFAULT_CASES) {
+            c.n_records = (int)(c.n_records * scale);
+            if (c.n_records < 1) c.n_records = 1;
+        }
+
+        for (int f = 0; f < 2; f++) {
+            char path[4096];
+            snprintf(path, sizeof(path), "%s/%s_%d.%s", data_dir, c.name, c.n_records, formats[f]);
+            if (access(path, R_OK) != 0) {
+                fprintf(stderr, "Generating %s\n", path);
+                if (bench_generate(&c, f == 1, path) != 0) {
+                    fprintf(stderr, "Failed to generate %s\n", path);
+                    failed = 1;
+                    continue;
+                }
+            }
+
+            const char* readers[] = {"arrow", "bcf_read", "parquet"};
+            for (int r = 0; r < (duckdb ? 3 : 1); r++) {
+                bench_result_t res;
+                if (bench_run(&c, path, readers[r], formats[f], repeat,
+                              duckdb, extension, &res) != 0) {
+                    failed = 1;
+                    continue;
+                }
+                bench_print(stdout, &c, &res);
+                fflush(stdout);
+                if (n_base > 0) regressions += bench_check(&c, &res, base, n_base, tol);
+            }
+        }
+    }
+
+    free(base);
+    if (regressions > 0) {
+        fprintf(stderr, "%d regression(s) against %s\n", regressions, baseline);
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
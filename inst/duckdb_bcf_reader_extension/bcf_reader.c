@@ -17,6 +17,7 @@
  *   LOAD 'bcf_reader.duckdb_extension';
  *   SELECT * FROM bcf_read('path/to/file.vcf.gz');
  *   SELECT * FROM bcf_read('path/to/file.bcf', region := 'chr1:1000-2000');
+ *   SELECT * FROM bcf_read('path/to/file.bcf', regions := ['chr1:1-2000', 'chr2']);
  *
  * Build:
  *   make (uses package htslib from RBCFTools)
@@ -31,6 +32,9 @@
 #include "duckdb_extension.h"
 #include "vcf_types.h"
 #include "vep_parser.h"
+#include "vcf_region_plan.h"
+#include "vcf_variantkey.h"
+#include "vcf_region_batch.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -56,6 +60,9 @@ DUCKDB_EXTENSION_EXTERN
 // =============================================================================
 
 #define BCF_READER_DEFAULT_BATCH_SIZE 2048
+#define BCF_READER_MAX_THREADS 64
+#define BCF_READER_BIN_MIN_SHIFT 14
+#define BCF_READER_BIN_LEVELS 5
 #define VEP_TRANSCRIPT_ALL 0
 #define VEP_TRANSCRIPT_FIRST 1
 
@@ -95,6 +102,8 @@ typedef struct {
 typedef struct {
     char* file_path;
     char* region;              // Optional region filter
+    char** regions;            // Optional batch of regions (owned, NULL entries allowed)
+    int n_regions;
     int include_info;          // Include INFO fields
     int include_format;        // Include FORMAT/sample fields
     int n_samples;             // Number of samples
@@ -104,6 +113,11 @@ typedef struct {
     int tidy_format;           // If true, emit one row per variant-sample with SAMPLE_ID column
     int sample_id_col_idx;     // Column index for SAMPLE_ID (when tidy_format=true)
     
+    // Computed columns
+    int bin_col_idx;           // Column index for BIN (when bin=true), -1 otherwise
+    int variantkey_col_idx;    // Column index for VARIANTKEY (when variantkey=true), -1 otherwise
+    int region_id_col_idx;     // Column index for REGION_ID (when regions is set), -1 otherwise
+    
     // Field metadata
     int n_info_fields;
     field_meta_t* info_fields;
@@ -124,8 +138,8 @@ typedef struct {
     
     // Parallel scan info (populated if index exists)
     int has_index;             // Whether an index was found
-    int n_contigs;             // Number of contigs for parallel scan
-    char** contig_names;       // Contig names (owned)
+    int n_units;               // Number of planned regions for parallel scan
+    char** unit_regions;       // Region strings, largest first (owned)
 } bcf_bind_data_t;
 
 // =============================================================================
@@ -133,9 +147,9 @@ typedef struct {
 // =============================================================================
 
 typedef struct {
-    volatile int current_contig;  // Next contig to assign (use atomic ops!)
-    int n_contigs;                // Total number of contigs
-    char** contig_names;          // Contig names (reference to bind data)
+    volatile int current_unit;    // Next region to assign (use atomic ops!)
+    int n_units;                  // Total number of planned regions
+    char** unit_regions;          // Region strings (reference to bind data)
     int has_region;               // User specified a region
 } bcf_global_init_data_t;
 
@@ -163,9 +177,17 @@ typedef struct {
     
     // Parallel scan state
     int is_parallel;
-    int assigned_contig;       // Which contig this thread is scanning (-1 = all)
-    const char* contig_name;   // Name of assigned contig (reference, don't free)
-    int needs_next_contig;     // Flag to request next contig assignment
+    int assigned_unit;         // Which planned region this thread is scanning (-1 = all)
+    const char* unit_region;   // Region string of assigned unit (reference, don't free)
+    hts_pos_t unit_beg;        // Records starting before this belong to the previous window
+    int needs_next_unit;       // Flag to request next region assignment
+    
+    // Region batch state: a record overlapping several regions is emitted
+    // once per region
+    vcf_region_batch_t* region_batch;
+    int region_hit;            // Next match of the current record to emit
+    int region_n_hits;         // Matches of the current record
+    int32_t region_id;         // Region id of the row being emitted
     
     // Tidy format state: tracks which sample we're emitting for current record
     int tidy_current_sample;   // Current sample index in tidy mode (-1 = need to read next record)
@@ -193,12 +215,21 @@ static void duckdb_vcf_warning(const char* msg, void* ctx) {
 // Memory Management
 // =============================================================================
 
+static void free_region_list(char** regions, int n_regions) {
+    if (!regions) return;
+    for (int i = 0; i < n_regions; i++) {
+        if (regions[i]) duckdb_free(regions[i]);
+    }
+    duckdb_free(regions);
+}
+
 static void destroy_bind_data(void* data) {
     bcf_bind_data_t* bind = (bcf_bind_data_t*)data;
     if (!bind) return;
     
     if (bind->file_path) duckdb_free(bind->file_path);
     if (bind->region) duckdb_free(bind->region);
+    free_region_list(bind->regions, bind->n_regions);
     
     if (bind->sample_names) {
         for (int i = 0; i < bind->n_samples; i++) {
@@ -221,11 +252,11 @@ static void destroy_bind_data(void* data) {
         duckdb_free(bind->format_fields);
     }
     
-    if (bind->contig_names) {
-        for (int i = 0; i < bind->n_contigs; i++) {
-            if (bind->contig_names[i]) duckdb_free(bind->contig_names[i]);
+    if (bind->unit_regions) {
+        for (int i = 0; i < bind->n_units; i++) {
+            if (bind->unit_regions[i]) duckdb_free(bind->unit_regions[i]);
         }
-        duckdb_free(bind->contig_names);
+        duckdb_free(bind->unit_regions);
     }
 
     if (bind->vep_schema) {
@@ -238,7 +269,7 @@ static void destroy_bind_data(void* data) {
 static void destroy_global_init_data(void* data) {
     bcf_global_init_data_t* global = (bcf_global_init_data_t*)data;
     if (global) {
-        // contig_names is a reference, don't free
+        // unit_regions is a reference, don't free
         duckdb_free(global);
     }
 }
@@ -248,6 +279,7 @@ static void destroy_init_data(void* data) {
     if (!init) return;
     
     if (init->itr) hts_itr_destroy(init->itr);
+    if (init->region_batch) vcf_region_batch_destroy(init->region_batch);
     if (init->tbx) tbx_destroy(init->tbx);
     if (init->idx) hts_idx_destroy(init->idx);
     if (init->rec) bcf_destroy(init->rec);
@@ -361,6 +393,31 @@ static void bcf_read_bind(duckdb_bind_info info) {
     }
     if (region_val) duckdb_destroy_value(&region_val);
     
+    // Get optional regions named parameter (list of region strings)
+    char** regions = NULL;
+    int n_regions = 0;
+    duckdb_value regions_val = duckdb_bind_get_named_parameter(info, "regions");
+    if (regions_val && !duckdb_is_null_value(regions_val)) {
+        n_regions = (int)duckdb_get_list_size(regions_val);
+        if (n_regions > 0) {
+            regions = (char**)duckdb_malloc(n_regions * sizeof(char*));
+            for (int i = 0; i < n_regions; i++) {
+                duckdb_value child = duckdb_get_list_child(regions_val, i);
+                regions[i] = (child && !duckdb_is_null_value(child)) ? duckdb_get_varchar(child) : NULL;
+                if (child) duckdb_destroy_value(&child);
+            }
+        }
+    }
+    if (regions_val) duckdb_destroy_value(&regions_val);
+    
+    if (region && strlen(region) > 0 && n_regions > 0) {
+        duckdb_bind_set_error(info, "region and regions are mutually exclusive");
+        duckdb_free(file_path);
+        duckdb_free(region);
+        free_region_list(regions, n_regions);
+        return;
+    }
+    
     // Get optional tidy_format named parameter (default: false)
     int tidy_format = 0;
     duckdb_value tidy_val = duckdb_bind_get_named_parameter(info, "tidy_format");
@@ -369,6 +426,22 @@ static void bcf_read_bind(duckdb_bind_info info) {
     }
     if (tidy_val) duckdb_destroy_value(&tidy_val);
     
+    // Get optional bin named parameter (default: false)
+    int add_bin = 0;
+    duckdb_value bin_val = duckdb_bind_get_named_parameter(info, "bin");
+    if (bin_val && !duckdb_is_null_value(bin_val)) {
+        add_bin = duckdb_get_bool(bin_val);
+    }
+    if (bin_val) duckdb_destroy_value(&bin_val);
+    
+    // Get optional variantkey named parameter (default: false)
+    int add_variantkey = 0;
+    duckdb_value vk_val = duckdb_bind_get_named_parameter(info, "variantkey");
+    if (vk_val && !duckdb_is_null_value(vk_val)) {
+        add_variantkey = duckdb_get_bool(vk_val);
+    }
+    if (vk_val) duckdb_destroy_value(&vk_val);
+    
     // Open the file to read header
     htsFile* fp = hts_open(file_path, "r");
     if (!fp) {
@@ -377,6 +450,7 @@ static void bcf_read_bind(duckdb_bind_info info) {
         duckdb_bind_set_error(info, err);
         duckdb_free(file_path);
         if (region) duckdb_free(region);
+        free_region_list(regions, n_regions);
         return;
     }
     
@@ -386,19 +460,42 @@ static void bcf_read_bind(duckdb_bind_info info) {
         duckdb_bind_set_error(info, "Failed to read BCF/VCF header");
         duckdb_free(file_path);
         if (region) duckdb_free(region);
+        free_region_list(regions, n_regions);
         return;
     }
     
+    // Reject unknown contigs and malformed regions at bind time
+    if (n_regions > 0) {
+        char err[512];
+        vcf_region_batch_t* batch = vcf_region_batch_init(hdr, (const char* const*)regions,
+                                                          n_regions, err, sizeof(err));
+        if (!batch) {
+            duckdb_bind_set_error(info, err);
+            bcf_hdr_destroy(hdr);
+            hts_close(fp);
+            duckdb_free(file_path);
+            if (region) duckdb_free(region);
+            free_region_list(regions, n_regions);
+            return;
+        }
+        vcf_region_batch_destroy(batch);
+    }
+    
     // Create bind data
     bcf_bind_data_t* bind = (bcf_bind_data_t*)duckdb_malloc(sizeof(bcf_bind_data_t));
     memset(bind, 0, sizeof(bcf_bind_data_t));
     bind->file_path = file_path;
     bind->region = region;
+    bind->regions = regions;
+    bind->n_regions = n_regions;
     bind->include_info = 1;
     bind->include_format = 1;
     bind->n_samples = bcf_hdr_nsamples(hdr);
     bind->tidy_format = tidy_format;
     bind->sample_id_col_idx = -1;  // Will be set if tidy_format=true
+    bind->bin_col_idx = -1;        // Will be set if bin=true
+    bind->variantkey_col_idx = -1; // Will be set if variantkey=true
+    bind->region_id_col_idx = -1;  // Will be set if regions is set
     bind->n_vep_fields = 0;
     bind->vep_col_start = COL_CORE_COUNT;
     bind->info_col_start = COL_CORE_COUNT;
@@ -635,18 +732,51 @@ static void bcf_read_bind(duckdb_bind_info info) {
         }
     }
     
+    // -------------------------------------------------------------------------
+    // BIN - INTEGER, UCSC/CSI bin of [POS, POS + rlen) (optional)
+    // -------------------------------------------------------------------------
+    if (add_bin) {
+        duckdb_logical_type integer_type = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
+        bind->bin_col_idx = col_idx;
+        duckdb_bind_add_result_column(info, "BIN", integer_type);
+        duckdb_destroy_logical_type(&integer_type);
+        col_idx++;
+    }
+    
+    // -------------------------------------------------------------------------
+    // VARIANTKEY - UBIGINT, 64-bit CHROM/POS/REF/ALT key (optional)
+    // -------------------------------------------------------------------------
+    if (add_variantkey) {
+        duckdb_logical_type ubigint_type = duckdb_create_logical_type(DUCKDB_TYPE_UBIGINT);
+        bind->variantkey_col_idx = col_idx;
+        duckdb_bind_add_result_column(info, "VARIANTKEY", ubigint_type);
+        duckdb_destroy_logical_type(&ubigint_type);
+        col_idx++;
+    }
+    
+    // -------------------------------------------------------------------------
+    // REGION_ID - INTEGER, 1-based position in regions (when regions is set)
+    // -------------------------------------------------------------------------
+    if (n_regions > 0) {
+        duckdb_logical_type integer_type = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
+        bind->region_id_col_idx = col_idx;
+        duckdb_bind_add_result_column(info, "REGION_ID", integer_type);
+        duckdb_destroy_logical_type(&integer_type);
+        col_idx++;
+    }
+    
     bind->total_columns = col_idx;
     
     // -------------------------------------------------------------------------
-    // Check for index and extract contig names for parallel scanning
+    // Check for index and plan size-balanced regions for parallel scanning
     // -------------------------------------------------------------------------
     
     bind->has_index = 0;
-    bind->n_contigs = 0;
-    bind->contig_names = NULL;
+    bind->n_units = 0;
+    bind->unit_regions = NULL;
     
-    // Only set up parallel scan if no user-specified region
-    if (!region || strlen(region) == 0) {
+    // Only set up parallel scan if no user-specified region(s)
+    if ((!region || strlen(region) == 0) && n_regions == 0) {
         // Try to load index using *_load3 with minimal flags to avoid network timeouts
         // Only use HTS_IDX_SAVE_REMOTE for actual remote protocols
         int is_remote = (strncmp(file_path, "http://", 7) == 0 || 
@@ -675,15 +805,20 @@ static void bcf_read_bind(duckdb_bind_info info) {
         if (idx || tbx) {
             bind->has_index = 1;
             
-            // Get contig names from header for parallel scan
-            int n_seqs = hdr->n[BCF_DT_CTG];
-            if (n_seqs > 0) {
-                bind->n_contigs = n_seqs;
-                bind->contig_names = (char**)duckdb_malloc(n_seqs * sizeof(char*));
-                
-                for (int i = 0; i < n_seqs; i++) {
-                    bind->contig_names[i] = strdup_duckdb(hdr->id[BCF_DT_CTG][i].key);
+            // Contigs without indexed records are skipped, large ones are
+            // split into windows, and regions are claimed largest first
+            vcf_region_plan_t plan;
+            if (vcf_region_plan_build(tbx ? tbx->idx : idx, tbx, hdr,
+                                      BCF_READER_MAX_THREADS, &plan) == 0) {
+                if (plan.n_units > 0) {
+                    bind->n_units = plan.n_units;
+                    bind->unit_regions = (char**)duckdb_malloc(plan.n_units * sizeof(char*));
+                    
+                    for (int i = 0; i < plan.n_units; i++) {
+                        bind->unit_regions[i] = strdup_duckdb(plan.units[i].region);
+                    }
                 }
+                vcf_region_plan_destroy(&plan);
             }
             
             if (idx) hts_idx_destroy(idx);
@@ -713,25 +848,25 @@ static void bcf_read_global_init(duckdb_init_info info) {
     bcf_global_init_data_t* global = (bcf_global_init_data_t*)duckdb_malloc(sizeof(bcf_global_init_data_t));
     memset(global, 0, sizeof(bcf_global_init_data_t));
     
-    global->current_contig = 0;
-    global->has_region = (bind->region && strlen(bind->region) > 0);
+    global->current_unit = 0;
+    global->has_region = (bind->region && strlen(bind->region) > 0) || bind->n_regions > 0;
     
     // Enable parallel scan if:
     // 1. Index exists
-    // 2. Multiple contigs available
+    // 2. Multiple regions planned
     // 3. No user-specified region (region queries are already filtered)
-    if (bind->has_index && bind->n_contigs > 1 && !global->has_region) {
-        global->n_contigs = bind->n_contigs;
-        global->contig_names = bind->contig_names;  // Reference only
+    if (bind->has_index && bind->n_units > 1 && !global->has_region) {
+        global->n_units = bind->n_units;
+        global->unit_regions = bind->unit_regions;  // Reference only
         
-        // Cap threads at number of contigs or reasonable max
-        idx_t max_threads = bind->n_contigs;
-        if (max_threads > 16) max_threads = 16;
+        // Cap threads at number of regions or reasonable max
+        idx_t max_threads = bind->n_units;
+        if (max_threads > BCF_READER_MAX_THREADS) max_threads = BCF_READER_MAX_THREADS;
         duckdb_init_set_max_threads(info, max_threads);
     } else {
-        // Single-threaded scan (single contig or no index)
-        global->n_contigs = 0;
-        global->contig_names = NULL;
+        // Single-threaded scan (single region or no index)
+        global->n_units = 0;
+        global->unit_regions = NULL;
         duckdb_init_set_max_threads(info, 1);
     }
     
@@ -749,14 +884,16 @@ static void bcf_read_local_init(duckdb_init_info info) {
     memset(local, 0, sizeof(bcf_init_data_t));
     
     // Check if we're in parallel mode based on bind data
-    int is_parallel = (bind->has_index && bind->n_contigs > 1 && 
-                       (!bind->region || strlen(bind->region) == 0));
+    int is_parallel = (bind->has_index && bind->n_units > 1 && 
+                       (!bind->region || strlen(bind->region) == 0) &&
+                       bind->n_regions == 0);
     
     // Initialize parallel scan state
     local->is_parallel = is_parallel;
-    local->assigned_contig = -1;
-    local->contig_name = NULL;
-    local->needs_next_contig = is_parallel;  // Start by requesting first contig
+    local->assigned_unit = -1;
+    local->unit_region = NULL;
+    local->unit_beg = 0;
+    local->needs_next_unit = is_parallel;  // Start by requesting first region
     
     // Open file (each thread gets its own file handle)
     local->fp = hts_open(bind->file_path, "r");
@@ -780,7 +917,7 @@ static void bcf_read_local_init(duckdb_init_info info) {
     
     // Load index for parallel scanning or region queries
     // Use *_load3 with HTS_IDX_SAVE_REMOTE for remote file support
-    if (is_parallel || (bind->region && strlen(bind->region) > 0)) {
+    if (is_parallel || (bind->region && strlen(bind->region) > 0) || bind->n_regions > 0) {
         enum htsExactFormat fmt = hts_get_format(local->fp)->format;
         
         if (fmt == bcf) {
@@ -824,6 +961,33 @@ static void bcf_read_local_init(duckdb_init_info info) {
         }
     }
     
+    // Batched regions: one multi-region iterator over all of them, each
+    // record matched back to the regions it overlaps during the scan
+    if (bind->n_regions > 0) {
+        if (!local->idx && !local->tbx) {
+            duckdb_init_set_error(info, "Region query requires an index file (.tbi or .csi)");
+            destroy_init_data(local);
+            return;
+        }
+        
+        char err[512];
+        local->region_batch = vcf_region_batch_init(local->hdr, (const char* const*)bind->regions,
+                                                     bind->n_regions, err, sizeof(err));
+        if (!local->region_batch) {
+            duckdb_init_set_error(info, err);
+            destroy_init_data(local);
+            return;
+        }
+        local->itr = vcf_region_batch_itr(local->region_batch,
+                                          local->tbx ? local->tbx->idx : local->idx,
+                                          local->tbx, local->hdr);
+        if (!local->itr) {
+            duckdb_init_set_error(info, "Failed to create multi-region iterator");
+            destroy_init_data(local);
+            return;
+        }
+    }
+    
     local->current_row = 0;
     local->done = 0;
     
@@ -971,20 +1135,20 @@ static void print_progress(bcf_init_data_t* init, const char* context) {
 }
 
 // =============================================================================
-// Helper: Claim next contig for parallel scanning
-// Returns 1 if a new contig was claimed, 0 if no more contigs
+// Helper: Claim next planned region for parallel scanning
+// Returns 1 if a new region was claimed, 0 if no more regions
 // =============================================================================
 
-static int claim_next_contig(bcf_init_data_t* init, bcf_global_init_data_t* global) {
-    if (!init->is_parallel || !global || global->n_contigs == 0) {
+static int claim_next_unit(bcf_init_data_t* init, bcf_global_init_data_t* global) {
+    if (!init->is_parallel || !global || global->n_units == 0) {
         return 0;
     }
     
-    // Atomically claim next contig using fetch-and-add
-    // This prevents race conditions where two threads grab the same contig
-    int next = __sync_fetch_and_add(&global->current_contig, 1);
-    if (next >= global->n_contigs) {
-        return 0;  // No more contigs
+    // Atomically claim next region using fetch-and-add
+    // This prevents race conditions where two threads grab the same region
+    int next = __sync_fetch_and_add(&global->current_unit, 1);
+    if (next >= global->n_units) {
+        return 0;  // No more regions
     }
     
     // Destroy old iterator if exists
@@ -993,23 +1157,25 @@ static int claim_next_contig(bcf_init_data_t* init, bcf_global_init_data_t* glob
         init->itr = NULL;
     }
     
-    // Set up iterator for this contig
-    const char* contig = global->contig_names[next];
-    init->assigned_contig = next;
-    init->contig_name = contig;
+    // Set up iterator for this region
+    const char* region = global->unit_regions[next];
+    init->assigned_unit = next;
+    init->unit_region = region;
     
     if (init->idx) {
-        init->itr = bcf_itr_querys(init->idx, init->hdr, contig);
+        init->itr = bcf_itr_querys(init->idx, init->hdr, region);
     } else if (init->tbx) {
-        init->itr = tbx_itr_querys(init->tbx, contig);
+        init->itr = tbx_itr_querys(init->tbx, region);
     }
     
     if (!init->itr) {
-        // This contig might not have any records - try next
-        return claim_next_contig(init, global);
+        // This region might not have any records - try next
+        return claim_next_unit(init, global);
     }
     
-    init->needs_next_contig = 0;
+    // Windows are start-owned: skip records that began in the previous one
+    init->unit_beg = init->itr->beg;
+    init->needs_next_unit = 0;
     return 1;
 }
 
@@ -1047,10 +1213,10 @@ static void bcf_read_function(duckdb_function_info info, duckdb_data_chunk outpu
         }
     }
     
-    // For parallel scans, claim first/next contig if needed
-    if (init->needs_next_contig) {
-        if (!claim_next_contig(init, global)) {
-            // No more contigs to process
+    // For parallel scans, claim first/next region if needed
+    if (init->needs_next_unit) {
+        if (!claim_next_unit(init, global)) {
+            // No more regions to process
             init->done = 1;
             duckdb_data_chunk_set_size(output, 0);
             return;
@@ -1083,6 +1249,17 @@ static void bcf_read_function(duckdb_function_info info, duckdb_data_chunk outpu
             }
         }
         
+        // Region batch: the current record again, for the next region it overlaps
+        if (need_read && init->region_hit < init->region_n_hits) {
+            need_read = 0;
+            init->region_id = vcf_region_batch_hit(init->region_batch, init->region_hit++);
+            if (tidy_mode) {
+                init->tidy_current_sample = 0;
+                init->tidy_record_valid = 1;
+                current_sample = 0;
+            }
+        }
+        
         if (need_read) {
             int ret;
             
@@ -1103,17 +1280,30 @@ static void bcf_read_function(duckdb_function_info info, duckdb_data_chunk outpu
             }
             
             if (ret < 0) {
-                // End of current contig/file
+                // End of current region/file
                 if (init->is_parallel) {
-                    // Try to claim next contig
-                    if (claim_next_contig(init, global)) {
-                        continue;  // Continue reading from new contig
+                    // Try to claim next region
+                    if (claim_next_unit(init, global)) {
+                        continue;  // Continue reading from new region
                     }
                 }
                 init->done = 1;
                 break;
             }
             
+            // Overlaps this window but belongs to the previous one
+            if (init->is_parallel && init->rec->pos < init->unit_beg) {
+                continue;
+            }
+            
+            // Merged index chunks can return records between the batch's regions
+            if (init->region_batch) {
+                init->region_n_hits = vcf_region_batch_match(init->region_batch, init->rec);
+                init->region_hit = 0;
+                if (init->region_n_hits == 0) continue;
+                init->region_id = vcf_region_batch_hit(init->region_batch, init->region_hit++);
+            }
+            
             // Unpack record
             bcf_unpack(init->rec, BCF_UN_ALL);
             
@@ -1227,6 +1417,21 @@ static void bcf_read_function(duckdb_function_info info, duckdb_data_chunk outpu
                 duckdb_list_entry* list_data = (duckdb_list_entry*)duckdb_vector_get_data(vec);
                 list_data[row_count] = entry;
             }
+            else if (bind->bin_col_idx >= 0 && col_id == (idx_t)bind->bin_col_idx) {
+                // Same binning scheme as TBI and default CSI (min_shift 14, 5 levels)
+                int32_t* data = (int32_t*)duckdb_vector_get_data(vec);
+                hts_pos_t end = init->rec->pos + (init->rec->rlen > 0 ? init->rec->rlen : 1);
+                data[row_count] = hts_reg2bin(init->rec->pos, end, BCF_READER_BIN_MIN_SHIFT,
+                                              BCF_READER_BIN_LEVELS);
+            }
+            else if (bind->variantkey_col_idx >= 0 && col_id == (idx_t)bind->variantkey_col_idx) {
+                uint64_t* data = (uint64_t*)duckdb_vector_get_data(vec);
+                data[row_count] = vcf_variantkey(init->hdr, init->rec);
+            }
+            else if (bind->region_id_col_idx >= 0 && col_id == (idx_t)bind->region_id_col_idx) {
+                int32_t* data = (int32_t*)duckdb_vector_get_data(vec);
+                data[row_count] = init->region_id;
+            }
             else if (bind->vep_schema &&
                      col_id >= (idx_t)bind->vep_col_start &&
                      col_id < (idx_t)(bind->vep_col_start + bind->n_vep_fields)) {
@@ -1723,9 +1928,9 @@ static void bcf_read_function(duckdb_function_info info, duckdb_data_chunk outpu
         
         // Print progress every N records (only count actual VCF records, not per-sample rows)
         if (!tidy_mode || !init->tidy_record_valid) {
-            if (init->is_parallel && init->contig_name) {
+            if (init->is_parallel && init->unit_region) {
                 char context[256];
-                snprintf(context, sizeof(context), "scan (contig: %s)", init->contig_name);
+                snprintf(context, sizeof(context), "scan (region: %s)", init->unit_region);
                 print_progress(init, context);
             } else {
                 print_progress(init, "scan");
@@ -1752,7 +1957,12 @@ static void register_bcf_read_function(duckdb_connection connection) {
     duckdb_logical_type bool_type = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
     duckdb_table_function_add_parameter(tf, varchar_type);  // file_path
     duckdb_table_function_add_named_parameter(tf, "region", varchar_type);  // optional region
+    duckdb_logical_type varchar_list_type = duckdb_create_list_type(varchar_type);
+    duckdb_table_function_add_named_parameter(tf, "regions", varchar_list_type);  // optional region batch
+    duckdb_destroy_logical_type(&varchar_list_type);
     duckdb_table_function_add_named_parameter(tf, "tidy_format", bool_type);  // optional tidy format
+    duckdb_table_function_add_named_parameter(tf, "bin", bool_type);  // optional BIN column
+    duckdb_table_function_add_named_parameter(tf, "variantkey", bool_type);  // optional VARIANTKEY column
     duckdb_destroy_logical_type(&varchar_type);
     duckdb_destroy_logical_type(&bool_type);
     
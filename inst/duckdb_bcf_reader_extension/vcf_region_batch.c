@@ -0,0 +1,152 @@
+// Batched multi-region queries for VCF/BCF readers (self-contained copy for the DuckDB extension)
+// Regions go through one htslib multi-region iterator (merged regions,
+// unioned chunks, each BGZF block decompressed once); records are matched
+// back to every input region they overlap.
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_region_batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int rid;                  // Header contig id
+    hts_pos_t beg;            // 0-based start
+    hts_pos_t end;            // 0-based exclusive end
+    int32_t id;               // 1-based position in the input
+} batch_region_t;
+
+struct vcf_region_batch_t {
+    batch_region_t* regs;     // Sorted by (rid, beg)
+    hts_pos_t* max_end;       // Running max of end within each contig
+    char** strings;           // Input region strings, for the iterator
+    int n;
+    int32_t* hits;            // Ids matched by the last vcf_region_batch_match()
+    int n_hits;
+};
+
+static int batch_name2id(void* hdr, const char* name) {
+    return bcf_hdr_name2id((const bcf_hdr_t*)hdr, name);
+}
+
+static int batch_region_cmp(const void* a, const void* b) {
+    const batch_region_t* x = (const batch_region_t*)a;
+    const batch_region_t* y = (const batch_region_t*)b;
+    if (x->rid != y->rid) return x->rid < y->rid ? -1 : 1;
+    if (x->beg != y->beg) return x->beg < y->beg ? -1 : 1;
+    return x->id < y->id ? -1 : (x->id > y->id);
+}
+
+static int batch_id_cmp(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a, y = *(const int32_t*)b;
+    return x < y ? -1 : (x > y);
+}
+
+vcf_region_batch_t* vcf_region_batch_init(const bcf_hdr_t* hdr,
+                                          const char* const* regions, int n_regions,
+                                          char* error_msg, size_t error_len) {
+    if (n_regions <= 0) {
+        snprintf(error_msg, error_len, "No regions given");
+        return NULL;
+    }
+
+    vcf_region_batch_t* b = (vcf_region_batch_t*)calloc(1, sizeof(*b));
+    if (!b) goto fail_oom;
+    b->regs = (batch_region_t*)calloc(n_regions, sizeof(batch_region_t));
+    b->max_end = (hts_pos_t*)calloc(n_regions, sizeof(hts_pos_t));
+    b->strings = (char**)calloc(n_regions, sizeof(char*));
+    b->hits = (int32_t*)calloc(n_regions, sizeof(int32_t));
+    if (!b->regs || !b->max_end || !b->strings || !b->hits) goto fail_oom;
+
+    for (int i = 0; i < n_regions; i++) {
+        batch_region_t* r = &b->regs[b->n];
+        // Same parsing as hts_reglist_create(), so matches agree with the iterator
+        if (!regions[i] ||
+            !hts_parse_region(regions[i], &r->rid, &r->beg, &r->end,
+                              batch_name2id, (void*)hdr, HTS_PARSE_THOUSANDS_SEP) ||
+            r->rid < 0) {
+            snprintf(error_msg, error_len,
+                     "Region not found in file (contig may not exist in header): %s",
+                     regions[i] ? regions[i] : "NA");
+            vcf_region_batch_destroy(b);
+            return NULL;
+        }
+        r->id = i + 1;
+        b->strings[b->n] = strdup(regions[i]);
+        if (!b->strings[b->n]) goto fail_oom;
+        b->n++;
+    }
+
+    qsort(b->regs, b->n, sizeof(batch_region_t), batch_region_cmp);
+    for (int i = 0; i < b->n; i++) {
+        b->max_end[i] = b->regs[i].end;
+        if (i > 0 && b->regs[i - 1].rid == b->regs[i].rid &&
+            b->max_end[i - 1] > b->max_end[i]) {
+            b->max_end[i] = b->max_end[i - 1];
+        }
+    }
+    return b;
+
+fail_oom:
+    snprintf(error_msg, error_len, "Out of memory");
+    vcf_region_batch_destroy(b);
+    return NULL;
+}
+
+hts_itr_t* vcf_region_batch_itr(const vcf_region_batch_t* b, const hts_idx_t* idx,
+                                tbx_t* tbx, bcf_hdr_t* hdr) {
+    if (tbx) return tbx_itr_regarray(tbx, b->strings, (unsigned int)b->n);
+    return bcf_itr_regarray(idx, hdr, b->strings, (unsigned int)b->n);
+}
+
+int vcf_region_batch_match(vcf_region_batch_t* b, const bcf1_t* rec) {
+    b->n_hits = 0;
+    hts_pos_t rec_beg = rec->pos;
+    hts_pos_t rec_end = rec->pos + (rec->rlen > 0 ? rec->rlen : 1);
+
+    // First region past the record: on a later contig, or starting at or
+    // after its end
+    int lo = 0, hi = b->n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        const batch_region_t* r = &b->regs[mid];
+        if (r->rid < rec->rid || (r->rid == rec->rid && r->beg < rec_end)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // Walk back while some earlier region on the contig can still reach it
+    for (int i = lo - 1; i >= 0; i--) {
+        const batch_region_t* r = &b->regs[i];
+        if (r->rid != rec->rid || b->max_end[i] <= rec_beg) break;
+        if (r->end > rec_beg) b->hits[b->n_hits++] = r->id;
+    }
+
+    if (b->n_hits > 1) {
+        qsort(b->hits, b->n_hits, sizeof(int32_t), batch_id_cmp);
+    }
+    return b->n_hits;
+}
+
+int32_t vcf_region_batch_hit(const vcf_region_batch_t* b, int i) {
+    return b->hits[i];
+}
+
+int vcf_region_batch_size(const vcf_region_batch_t* b) {
+    return b->n;
+}
+
+void vcf_region_batch_destroy(vcf_region_batch_t* b) {
+    if (!b) return;
+    if (b->strings) {
+        for (int i = 0; i < b->n; i++) free(b->strings[i]);
+    }
+    free(b->strings);
+    free(b->regs);
+    free(b->max_end);
+    free(b->hits);
+    free(b);
+}
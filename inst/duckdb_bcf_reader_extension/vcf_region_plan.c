@@ -0,0 +1,273 @@
+// Size-balanced region planning for parallel VCF/BCF scans (self-contained copy for the DuckDB extension)
+// Estimates per-contig work from CSI/TBI chunk offsets and builds a
+// largest-first schedule, splitting contigs that are too large to balance.
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_region_plan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+// Bisection stops at the smallest bin of TBI/CSI indexes (2^14 bp)
+#define VCF_PLAN_MIN_WINDOW (1 << 14)
+// Contig extent probing starts here when the header has no length
+#define VCF_PLAN_PROBE_START ((hts_pos_t)1 << 20)
+#define VCF_PLAN_PROBE_MAX ((hts_pos_t)1 << 40)
+
+typedef struct {
+    vcf_region_unit_t unit;
+    int order;                // Header order, for stable ties
+} plan_entry_t;
+
+typedef struct {
+    plan_entry_t* entries;
+    int n;
+    int m;
+} plan_list_t;
+
+// =============================================================================
+// Index Queries
+// =============================================================================
+
+/**
+ * Compressed bytes covered by the index chunks for [beg, end) on tid.
+ * Chunks inside a single BGZF block count as one byte so that non-empty
+ * ranges are never estimated as empty.
+ */
+static uint64_t plan_bytes(const hts_idx_t* idx, int tid, hts_pos_t beg, hts_pos_t end) {
+    hts_itr_t* itr = hts_itr_query(idx, tid, beg, end, NULL);
+    if (!itr) return 0;
+
+    uint64_t bytes = 0;
+    for (int i = 0; i < itr->n_off; i++) {
+        uint64_t u = itr->off[i].u >> 16;
+        uint64_t v = itr->off[i].v >> 16;
+        if (v > u) bytes += v - u;
+    }
+    if (bytes == 0 && itr->n_off > 0) bytes = 1;
+
+    hts_itr_destroy(itr);
+    return bytes;
+}
+
+/**
+ * Upper bound on positions with records: the header length if declared,
+ * otherwise the first power of two past which the index has no chunks.
+ */
+static hts_pos_t plan_extent(const hts_idx_t* idx, int tid, const bcf_hdr_t* hdr,
+                             const char* name) {
+    int rid = bcf_hdr_name2id(hdr, name);
+    if (rid >= 0 && hdr->id[BCF_DT_CTG][rid].val &&
+        hdr->id[BCF_DT_CTG][rid].val->info[0] > 0) {
+        return hdr->id[BCF_DT_CTG][rid].val->info[0];
+    }
+
+    hts_pos_t hi = VCF_PLAN_PROBE_START;
+    while (hi < VCF_PLAN_PROBE_MAX && plan_bytes(idx, tid, hi, HTS_POS_MAX) > 0) {
+        hi <<= 1;
+    }
+    return hi;
+}
+
+/**
+ * Smallest position p in [lo, hi] with bytes(0, p) >= target, to within
+ * VCF_PLAN_MIN_WINDOW.
+ */
+static hts_pos_t plan_bisect(const hts_idx_t* idx, int tid, hts_pos_t lo, hts_pos_t hi,
+                             uint64_t target) {
+    while (hi - lo > VCF_PLAN_MIN_WINDOW) {
+        hts_pos_t mid = lo + (hi - lo) / 2;
+        if (plan_bytes(idx, tid, 0, mid) >= target) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+    return hi;
+}
+
+// =============================================================================
+// Plan Construction
+// =============================================================================
+
+static int plan_add(plan_list_t* list, const char* name, hts_pos_t beg, hts_pos_t end,
+                    uint64_t bytes, uint64_t records, int order) {
+    if (list->n == list->m) {
+        int m = list->m ? list->m * 2 : 64;
+        plan_entry_t* entries = (plan_entry_t*)realloc(list->entries, m * sizeof(plan_entry_t));
+        if (!entries) return ENOMEM;
+        list->entries = entries;
+        list->m = m;
+    }
+
+    vcf_region_unit_t* unit = &list->entries[list->n].unit;
+    memset(unit, 0, sizeof(*unit));
+    unit->contig = strdup(name);
+
+    size_t len = strlen(name) + 48;
+    unit->region = (char*)malloc(len);
+    if (!unit->contig || !unit->region) {
+        free(unit->contig);
+        free(unit->region);
+        return ENOMEM;
+    }
+    if (beg == 0 && end == HTS_POS_MAX) {
+        snprintf(unit->region, len, "%s", name);
+    } else if (end == HTS_POS_MAX) {
+        snprintf(unit->region, len, "%s:%" PRIhts_pos, name, beg + 1);
+    } else {
+        snprintf(unit->region, len, "%s:%" PRIhts_pos "-%" PRIhts_pos, name, beg + 1, end);
+    }
+
+    unit->beg = beg;
+    unit->end = end;
+    unit->bytes = bytes;
+    unit->records = records;
+    list->entries[list->n].order = order;
+    list->n++;
+    return 0;
+}
+
+/**
+ * Split one contig into about n_pieces windows of equal compressed size.
+ */
+static int plan_split(plan_list_t* list, const hts_idx_t* idx, int tid, const bcf_hdr_t* hdr,
+                      const char* name, uint64_t bytes, uint64_t records, int n_pieces,
+                      int order) {
+    hts_pos_t extent = plan_extent(idx, tid, hdr, name);
+    hts_pos_t beg = 0;
+    int first = list->n;
+    int unresolved = 0;
+
+    for (int k = 1; k <= n_pieces; k++) {
+        hts_pos_t end = HTS_POS_MAX;
+        if (k < n_pieces) {
+            end = plan_bisect(idx, tid, beg, extent, bytes / n_pieces * k);
+            if (end >= extent) end = HTS_POS_MAX;
+        }
+        if (end != HTS_POS_MAX && end <= beg) continue;
+
+        uint64_t w_bytes = plan_bytes(idx, tid, beg, end);
+        if (w_bytes >= bytes) unresolved = 1;
+        if (w_bytes > 0) {
+            uint64_t w_records = bytes > 0 ? (uint64_t)((double)records * w_bytes / bytes) : 0;
+            int ret = plan_add(list, name, beg, end, w_bytes, w_records, order);
+            if (ret != 0) return ret;
+        }
+        if (end == HTS_POS_MAX) break;
+        beg = end;
+    }
+
+    // The index cannot separate the records (e.g. all in one BGZF block)
+    if (unresolved && list->n - first > 1) {
+        while (list->n > first) {
+            list->n--;
+            free(list->entries[list->n].unit.contig);
+            free(list->entries[list->n].unit.region);
+        }
+        return plan_add(list, name, 0, HTS_POS_MAX, bytes, records, order);
+    }
+    return 0;
+}
+
+static int plan_entry_cmp(const void* a, const void* b) {
+    const plan_entry_t* x = (const plan_entry_t*)a;
+    const plan_entry_t* y = (const plan_entry_t*)b;
+    if (x->unit.bytes != y->unit.bytes) return x->unit.bytes > y->unit.bytes ? -1 : 1;
+    if (x->unit.records != y->unit.records) return x->unit.records > y->unit.records ? -1 : 1;
+    if (x->order != y->order) return x->order < y->order ? -1 : 1;
+    return x->unit.beg < y->unit.beg ? -1 : (x->unit.beg > y->unit.beg);
+}
+
+int vcf_region_plan_build(const hts_idx_t* idx, tbx_t* tbx, const bcf_hdr_t* hdr,
+                          int n_threads, vcf_region_plan_t* plan) {
+    memset(plan, 0, sizeof(*plan));
+
+    int n_seqs = 0;
+    const char** names = tbx ? tbx_seqnames(tbx, &n_seqs)
+                             : bcf_index_seqnames((hts_idx_t*)idx, (bcf_hdr_t*)hdr, &n_seqs);
+    if (!names) return n_seqs > 0 ? ENOMEM : 0;
+
+    int* tids = (int*)malloc((n_seqs > 0 ? n_seqs : 1) * sizeof(int));
+    uint64_t* bytes = (uint64_t*)calloc(n_seqs > 0 ? n_seqs : 1, sizeof(uint64_t));
+    uint64_t* records = (uint64_t*)calloc(n_seqs > 0 ? n_seqs : 1, sizeof(uint64_t));
+    plan_list_t list = {NULL, 0, 0};
+    int ret = 0;
+    if (!tids || !bytes || !records) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    // Per-contig size from chunk offsets and record counts from index stats
+    for (int i = 0; i < n_seqs; i++) {
+        tids[i] = tbx ? tbx_name2id(tbx, names[i]) : bcf_hdr_name2id(hdr, names[i]);
+        if (tids[i] < 0) continue;
+
+        uint64_t mapped = 0, unmapped = 0;
+        if (hts_idx_get_stat(idx, tids[i], &mapped, &unmapped) == 0) {
+            records[i] = mapped;
+        }
+        bytes[i] = plan_bytes(idx, tids[i], 0, HTS_POS_MAX);
+        plan->total_bytes += bytes[i];
+    }
+
+    uint64_t target = 0;
+    if (n_threads > 1) {
+        target = plan->total_bytes / ((uint64_t)n_threads * VCF_PLAN_UNITS_PER_THREAD);
+        if (target < VCF_PLAN_MIN_SPLIT_BYTES) target = VCF_PLAN_MIN_SPLIT_BYTES;
+    }
+
+    for (int i = 0; i < n_seqs && ret == 0; i++) {
+        // Contigs without indexed records have nothing to read
+        if (tids[i] < 0 || bytes[i] == 0) continue;
+
+        int n_pieces = target > 0 ? (int)((bytes[i] + target - 1) / target) : 1;
+        if (n_pieces > 1) {
+            ret = plan_split(&list, idx, tids[i], hdr, names[i], bytes[i], records[i],
+                             n_pieces, i);
+        } else {
+            ret = plan_add(&list, names[i], 0, HTS_POS_MAX, bytes[i], records[i], i);
+        }
+    }
+    if (ret != 0) goto done;
+
+    // Longest processing time first
+    if (list.n > 1) {
+        qsort(list.entries, list.n, sizeof(plan_entry_t), plan_entry_cmp);
+    }
+
+    plan->units = (vcf_region_unit_t*)malloc((list.n > 0 ? list.n : 1) * sizeof(vcf_region_unit_t));
+    if (!plan->units) {
+        ret = ENOMEM;
+        goto done;
+    }
+    for (int i = 0; i < list.n; i++) {
+        plan->units[i] = list.entries[i].unit;
+    }
+    plan->n_units = list.n;
+    list.n = 0;
+
+done:
+    for (int i = 0; i < list.n; i++) {
+        free(list.entries[i].unit.contig);
+        free(list.entries[i].unit.region);
+    }
+    free(list.entries);
+    free(records);
+    free(bytes);
+    free(tids);
+    free(names);
+    return ret;
+}
+
+void vcf_region_plan_destroy(vcf_region_plan_t* plan) {
+    if (!plan) return;
+    for (int i = 0; i < plan->n_units; i++) {
+        free(plan->units[i].contig);
+        free(plan->units[i].region);
+    }
+    free(plan->units);
+    memset(plan, 0, sizeof(*plan));
+}
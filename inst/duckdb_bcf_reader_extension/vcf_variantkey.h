@@ -0,0 +1,180 @@
+// 64-bit VariantKey encoding of VCF/BCF records (self-contained copy for the DuckDB extension)
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+//
+// The encoding is a port of variantkey.h from VariantKey
+// (https://github.com/tecnickcom/variantkey, MIT License,
+// Copyright (c) 2017-2018 GENOMICS plc, 2018-2023 Nicola Asuni - Tecnick.com),
+// trimmed to the encoder and prefixed to avoid clashing with the bcftools copy.
+//
+// Layout (MSB to LSB):
+//   [CHROM:5][POS:28][REFALT:31]
+// CHROM is 1-22, X=23, Y=24, MT=25 (with or without "chr"), 0 for any other
+// contig. POS is 0-based. REFALT is a reversible 2-bit encoding when REF and
+// ALT together hold at most 11 A/C/G/T bases; otherwise a 31-bit hash with
+// the least significant bit set. Multi-allelic records hash all ALT alleles
+// joined by ",", so they never collide with one of their split records.
+
+#ifndef VCF_VARIANTKEY_H
+#define VCF_VARIANTKEY_H
+
+#include <stdint.h>
+#include <string.h>
+#include <htslib/vcf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VCF_VK_SHIFT_CHROM 59
+#define VCF_VK_SHIFT_POS   31
+#define VCF_VK_MASK_POS    0x0FFFFFFFu
+#define VCF_VK_REV_ERROR   0xFFFFFFFFu
+
+static inline uint8_t vcf_vk_encode_chrom(const char *chrom, size_t size) {
+    if (size > 3 && (chrom[0] == 'c' || chrom[0] == 'C') &&
+        (chrom[1] == 'h' || chrom[1] == 'H') &&
+        (chrom[2] == 'r' || chrom[2] == 'R')) {
+        chrom += 3;
+        size -= 3;
+    }
+    if (size == 0) return 0;
+    if (chrom[0] >= '0' && chrom[0] <= '9') {
+        unsigned v = 0;
+        for (size_t i = 0; i < size; i++) {
+            if (chrom[i] < '0' || chrom[i] > '9') return 0;
+            v = v * 10 + (unsigned)(chrom[i] - '0');
+            if (v > 25) return 0;
+        }
+        return (uint8_t)v;
+    }
+    if (size == 1 || (size == 2 && (chrom[1] == 'T' || chrom[1] == 't'))) {
+        switch (chrom[0]) {
+            case 'X': case 'x': return size == 1 ? 23 : 0;
+            case 'Y': case 'y': return size == 1 ? 24 : 0;
+            case 'M': case 'm': return 25;
+        }
+    }
+    return 0;
+}
+
+static inline uint32_t vcf_vk_encode_base(char c) {
+    switch (c) {
+        case 'A': case 'a': return 0;
+        case 'C': case 'c': return 1;
+        case 'G': case 'g': return 2;
+        case 'T': case 't': return 3;
+    }
+    return 4;
+}
+
+static inline int vcf_vk_encode_allele(uint32_t *h, uint8_t *bitpos,
+                                       const char *str, size_t size) {
+    while (size--) {
+        uint32_t v = vcf_vk_encode_base(*str++);
+        if (v > 3) return -1;
+        *bitpos -= 2;
+        *h |= (v << *bitpos);
+    }
+    return 0;
+}
+
+static inline uint32_t vcf_vk_encode_refalt_rev(const char *ref, size_t sizeref,
+                                                const char *alt, size_t sizealt) {
+    uint32_t h = 0;
+    h |= ((uint32_t)sizeref << 27);
+    h |= ((uint32_t)sizealt << 23);
+    uint8_t bitpos = 23;
+    if (vcf_vk_encode_allele(&h, &bitpos, ref, sizeref) < 0 ||
+        vcf_vk_encode_allele(&h, &bitpos, alt, sizealt) < 0) {
+        return VCF_VK_REV_ERROR;
+    }
+    return h;
+}
+
+static inline uint32_t vcf_vk_muxhash(uint32_t k, uint32_t h) {
+    k *= 0xcc9e2d51;
+    k = (k >> 17) | (k << 15);
+    k *= 0x1b873593;
+    h ^= k;
+    h = (h >> 19) | (h << 13);
+    return (h * 5) + 0xe6546b64;
+}
+
+static inline uint32_t vcf_vk_packchar(int c) {
+    if (c < 'A') return 27;
+    if (c >= 'a') return (uint32_t)(c - 'a' + 1);
+    return (uint32_t)(c - 'A' + 1);
+}
+
+// Pack up to 6 characters in 32 bits (6 x 5 bit + 2 spare bits)
+static inline uint32_t vcf_vk_pack_chars(const char *str, size_t size) {
+    uint32_t h = 0;
+    for (size_t i = 0; i < size; i++) {
+        h ^= vcf_vk_packchar(str[i]) << (1 + 5 * (5 - i));
+    }
+    return h;
+}
+
+static inline uint32_t vcf_vk_hash32(const char *str, size_t size) {
+    uint32_t h = 0;
+    while (size >= 6) {
+        h = vcf_vk_muxhash(vcf_vk_pack_chars(str, 6), h);
+        str += 6;
+        size -= 6;
+    }
+    if (size > 0) h = vcf_vk_muxhash(vcf_vk_pack_chars(str, size), h);
+    return h;
+}
+
+static inline uint32_t vcf_vk_encode_refalt_hash(const char *ref, size_t sizeref,
+                                                 const char *alt, size_t sizealt) {
+    // 0x3 separates REF and ALT
+    uint32_t h = vcf_vk_muxhash(vcf_vk_hash32(alt, sizealt),
+                                vcf_vk_muxhash(0x3, vcf_vk_hash32(ref, sizeref)));
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return (h >> 1) | 0x1;  // LSB set marks hash mode
+}
+
+static inline uint32_t vcf_vk_encode_refalt(const char *ref, size_t sizeref,
+                                            const char *alt, size_t sizealt) {
+    if (sizeref + sizealt <= 11) {
+        uint32_t h = vcf_vk_encode_refalt_rev(ref, sizeref, alt, sizealt);
+        if (h != VCF_VK_REV_ERROR) return h;
+    }
+    return vcf_vk_encode_refalt_hash(ref, sizeref, alt, sizealt);
+}
+
+/**
+ * VariantKey of an unpacked record (needs BCF_UN_STR).
+ *
+ * Records without ALT use an empty ALT. For multi-allelic records the ALT
+ * alleles are read in place from d.als, where they are NUL-separated; the
+ * hash treats NUL and "," alike, so the key equals that of the
+ * comma-joined ALT string.
+ */
+static inline uint64_t vcf_variantkey(const bcf_hdr_t *hdr, const bcf1_t *rec) {
+    const char *chrom = bcf_hdr_id2name(hdr, rec->rid);
+    const char *ref = rec->n_allele > 0 ? rec->d.allele[0] : "";
+    const char *alt = "";
+    size_t sizealt = 0;
+    if (rec->n_allele > 1) {
+        const char *last = rec->d.allele[rec->n_allele - 1];
+        alt = rec->d.allele[1];
+        sizealt = (size_t)(last + strlen(last) - alt);
+    }
+    uint64_t pos = (uint64_t)rec->pos & VCF_VK_MASK_POS;
+    return ((uint64_t)vcf_vk_encode_chrom(chrom, strlen(chrom)) << VCF_VK_SHIFT_CHROM) |
+           (pos << VCF_VK_SHIFT_POS) |
+           (uint64_t)vcf_vk_encode_refalt(ref, strlen(ref), alt, sizealt);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_VARIANTKEY_H
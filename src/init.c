@@ -21,15 +21,42 @@ extern SEXP vcf_to_arrow_stream(SEXP filename_sexp, SEXP batch_size_sexp,
                                 SEXP include_info_sexp, SEXP include_format_sexp,
                                 SEXP index_sexp, SEXP threads_sexp,
                                 SEXP parse_vep_sexp, SEXP vep_tag_sexp,
-                                SEXP vep_columns_sexp, SEXP vep_transcript_mode_sexp);
+                                SEXP vep_columns_sexp, SEXP vep_transcript_mode_sexp,
+                                SEXP variantkey_sexp, SEXP build_index_sexp,
+                                SEXP regions_sexp, SEXP stats_sexp);
+extern SEXP vcf_to_arrow_stream_parallel(SEXP filename_sexp, SEXP regions_sexp,
+                                         SEXP sizes_sexp, SEXP threads_sexp, SEXP batch_size_sexp,
+                                         SEXP samples_sexp, SEXP include_info_sexp,
+                                         SEXP include_format_sexp, SEXP index_sexp,
+                                         SEXP parse_vep_sexp, SEXP vep_tag_sexp,
+                                         SEXP vep_columns_sexp, SEXP vep_transcript_mode_sexp,
+                                         SEXP variantkey_sexp);
 extern SEXP vcf_arrow_get_schema(SEXP filename_sexp);
 extern SEXP vcf_arrow_read_next_batch(SEXP stream_xptr);
 extern SEXP vcf_arrow_collect_batches(SEXP stream_xptr, SEXP max_batches_sexp);
+extern SEXP RC_vcf_arrow_stream_stats(SEXP stream_xptr);
+extern SEXP RC_vcf_arrow_parallel_claims(SEXP stream_xptr);
+extern SEXP arrow_stream_to_vcf(SEXP stream_xptr, SEXP filename_sexp, SEXP header_sexp,
+                                SEXP mode_sexp, SEXP threads_sexp, SEXP index_sexp,
+                                SEXP tidy_sexp, SEXP check_order_sexp);
+extern SEXP arrow_stream_tidy_in_order(SEXP stream_xptr, SEXP header_sexp);
 
 /* Declare external functions from vcf_index_utils.c */
+extern SEXP RC_vcf_handle_open(SEXP filename_sexp, SEXP index_sexp);
+extern SEXP RC_vcf_handle_close(SEXP handle_sexp);
 extern SEXP RC_vcf_has_index(SEXP filename_sexp, SEXP index_sexp);
 extern SEXP RC_vcf_get_contigs(SEXP filename_sexp);
 extern SEXP RC_vcf_get_contig_lengths(SEXP filename_sexp);
+extern SEXP RC_vcf_region_plan(SEXP filename_sexp, SEXP index_sexp, SEXP threads_sexp);
+extern SEXP RC_vcf_count_per_contig(SEXP filename_sexp, SEXP index_sexp);
+extern SEXP RC_vcf_count_records(SEXP filename_sexp, SEXP regions_sexp, SEXP index_sexp);
+extern SEXP RC_vcf_index(SEXP filename_sexp, SEXP index_sexp, SEXP min_shift_sexp,
+                         SEXP threads_sexp);
+extern SEXP RC_vcf_memory_usage(SEXP reset_sexp);
+extern SEXP RC_vcf_row_bytes(SEXP file_sexp, SEXP index_sexp, SEXP tidy_sexp);
+
+/* Declare external functions from parquet_footer.c */
+extern SEXP RC_parquet_concat_files(SEXP inputs_sexp, SEXP output_sexp);
 
 /* Declare external functions from vep_parser_r.c */
 extern SEXP RC_vep_detect_tag(SEXP filename_sexp);
@@ -38,6 +65,18 @@ extern SEXP RC_vep_get_schema(SEXP filename_sexp, SEXP tag_sexp);
 extern SEXP RC_vep_infer_type(SEXP field_name_sexp);
 extern SEXP RC_vep_parse_record(SEXP csq_sexp, SEXP schema_sexp, SEXP filename_sexp);
 
+/* Declare external functions from vcf_simulate_r.c */
+extern SEXP RC_vcf_simulate(SEXP path_sexp, SEXP n_records_sexp, SEXP n_samples_sexp,
+                            SEXP ploidy_sexp, SEXP missing_rate_sexp,
+                            SEXP multiallelic_rate_sexp, SEXP format_sexp, SEXP n_info_sexp,
+                            SEXP csq_rate_sexp, SEXP n_csq_sexp, SEXP contigs_sexp,
+                            SEXP seed_sexp, SEXP threads_sexp, SEXP index_sexp);
+
+/* Declare external functions from vcf_score_r.c */
+extern SEXP RC_vcf_score(SEXP file_sexp, SEXP index_sexp, SEXP chrom_sexp, SEXP pos_sexp,
+                         SEXP id_sexp, SEXP allele_sexp, SEXP weights_sexp, SEXP tag_sexp,
+                         SEXP samples_sexp, SEXP threads_sexp);
+
 /* Registration table for .Call routines */
 static const R_CallMethodDef CallEntries[] = {
     {"RC_htslib_version", (DL_FUNC)&RC_htslib_version, 0},
@@ -47,20 +86,39 @@ static const R_CallMethodDef CallEntries[] = {
     {"RC_htslib_has_feature", (DL_FUNC)&RC_htslib_has_feature, 1},
     {"RC_htslib_capabilities", (DL_FUNC)&RC_htslib_capabilities, 0},
     /* VCF Arrow stream functions */
-    {"vcf_to_arrow_stream", (DL_FUNC)&vcf_to_arrow_stream, 12},
+    {"vcf_to_arrow_stream", (DL_FUNC)&vcf_to_arrow_stream, 16},
+    {"vcf_to_arrow_stream_parallel", (DL_FUNC)&vcf_to_arrow_stream_parallel, 14},
+    {"RC_vcf_arrow_parallel_claims", (DL_FUNC)&RC_vcf_arrow_parallel_claims, 1},
     {"vcf_arrow_get_schema", (DL_FUNC)&vcf_arrow_get_schema, 1},
     {"vcf_arrow_read_next_batch", (DL_FUNC)&vcf_arrow_read_next_batch, 1},
     {"vcf_arrow_collect_batches", (DL_FUNC)&vcf_arrow_collect_batches, 2},
+    {"RC_vcf_arrow_stream_stats", (DL_FUNC)&RC_vcf_arrow_stream_stats, 1},
+    {"arrow_stream_to_vcf", (DL_FUNC)&arrow_stream_to_vcf, 8},
+    {"arrow_stream_tidy_in_order", (DL_FUNC)&arrow_stream_tidy_in_order, 2},
     /* VCF index utilities */
+    {"RC_vcf_handle_open", (DL_FUNC)&RC_vcf_handle_open, 2},
+    {"RC_vcf_handle_close", (DL_FUNC)&RC_vcf_handle_close, 1},
     {"RC_vcf_has_index", (DL_FUNC)&RC_vcf_has_index, 2},
     {"RC_vcf_get_contigs", (DL_FUNC)&RC_vcf_get_contigs, 1},
     {"RC_vcf_get_contig_lengths", (DL_FUNC)&RC_vcf_get_contig_lengths, 1},
+    {"RC_vcf_region_plan", (DL_FUNC)&RC_vcf_region_plan, 3},
+    {"RC_vcf_count_per_contig", (DL_FUNC)&RC_vcf_count_per_contig, 2},
+    {"RC_vcf_count_records", (DL_FUNC)&RC_vcf_count_records, 3},
+    {"RC_vcf_index", (DL_FUNC)&RC_vcf_index, 4},
+    {"RC_vcf_memory_usage", (DL_FUNC)&RC_vcf_memory_usage, 1},
+    {"RC_vcf_row_bytes", (DL_FUNC)&RC_vcf_row_bytes, 3},
+    /* Parquet footer utilities */
+    {"RC_parquet_concat_files", (DL_FUNC)&RC_parquet_concat_files, 2},
     /* VEP annotation parser */
     {"RC_vep_detect_tag", (DL_FUNC)&RC_vep_detect_tag, 1},
     {"RC_vep_has_annotation", (DL_FUNC)&RC_vep_has_annotation, 1},
     {"RC_vep_get_schema", (DL_FUNC)&RC_vep_get_schema, 2},
     {"RC_vep_infer_type", (DL_FUNC)&RC_vep_infer_type, 1},
     {"RC_vep_parse_record", (DL_FUNC)&RC_vep_parse_record, 3},
+    /* Synthetic data */
+    {"RC_vcf_simulate", (DL_FUNC)&RC_vcf_simulate, 14},
+    /* Polygenic scores */
+    {"RC_vcf_score", (DL_FUNC)&RC_vcf_score, 10},
     {NULL, NULL, 0}};
 
 /* Package initialization */
@@ -0,0 +1,949 @@
+// Parquet Footer Utilities
+// Reads and rewrites Parquet FileMetaData (Thrift compact protocol) without
+// touching column data, so files can be concatenated at row group level.
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#define R_NO_REMAP
+#include <R.h>
+#include <Rinternals.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/types.h>
+#include "htslib/khash.h"
+
+// =============================================================================
+// Constants
+// =============================================================================
+
+#define PQ_MAGIC "PAR1"
+#define PQ_MAX_DEPTH 64
+#define PQ_COPY_BUFFER (1 << 20)
+
+#define RETURN_IF_ERROR(expr) do { int __ret = (expr); if (__ret != 0) return __ret; } while(0)
+
+// Thrift compact protocol type ids
+#define CT_STOP          0
+#define CT_BOOLEAN_TRUE  1
+#define CT_BOOLEAN_FALSE 2
+#define CT_BYTE          3
+#define CT_I16           4
+#define CT_I32           5
+#define CT_I64           6
+#define CT_DOUBLE        7
+#define CT_BINARY        8
+#define CT_LIST          9
+#define CT_SET           10
+#define CT_MAP           11
+#define CT_STRUCT        12
+
+// Field ids from parquet.thrift
+#define FMD_SCHEMA        2
+#define FMD_NUM_ROWS      3
+#define FMD_ROW_GROUPS    4
+#define FMD_KV_METADATA   5
+#define KV_KEY            1
+#define KV_VALUE          2
+#define RG_COLUMNS        1
+#define RG_NUM_ROWS       3
+#define RG_FILE_OFFSET    5
+#define RG_ORDINAL        7
+#define CC_FILE_OFFSET    2
+#define CC_META_DATA      3
+#define CC_OFFSET_INDEX_OFFSET 4
+#define CC_OFFSET_INDEX_LENGTH 5
+#define CC_COLUMN_INDEX_OFFSET 6
+#define CMD_DATA_PAGE_OFFSET  9
+#define CMD_INDEX_PAGE_OFFSET 10
+#define CMD_DICT_PAGE_OFFSET  11
+#define CMD_BLOOM_OFFSET  14
+#define OI_PAGE_LOCATIONS 1
+#define PL_OFFSET         1
+
+// =============================================================================
+// Thrift Value Tree
+// =============================================================================
+
+/**
+ * Generic Thrift compact value. Structs keep their fields in file order,
+ * lists keep their elements and maps keep key/value pairs interleaved.
+ * Binary values point into the footer buffer unless bin_owned is set.
+ */
+typedef struct pq_node {
+    int16_t id;
+    uint8_t type;
+    uint8_t elem_type;      // list/set element type, map key type
+    uint8_t val_type;       // map value type
+    int64_t i;
+    double d;
+    const uint8_t* bin;
+    uint32_t bin_len;
+    int bin_owned;
+    int n;
+    struct pq_node* children;
+} pq_node;
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    int depth;
+} pq_reader;
+
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+} pq_buffer;
+
+typedef struct {
+    uint8_t* raw;
+    uint32_t raw_len;
+    int64_t footer_start;
+    pq_node root;
+} pq_footer_t;
+
+static void pq_node_free(pq_node* node) {
+    if (!node) return;
+    for (int k = 0; k < node->n; k++) pq_node_free(&node->children[k]);
+    free(node->children);
+    if (node->bin_owned) free((void*)node->bin);
+    node->children = NULL;
+    node->n = 0;
+    node->bin = NULL;
+    node->bin_owned = 0;
+}
+
+// =============================================================================
+// Compact Protocol Decoding
+// =============================================================================
+
+static int pq_read_varint(pq_reader* r, uint64_t* out) {
+    uint64_t result = 0;
+    int shift = 0;
+    while (r->p < r->end && shift < 64) {
+        uint8_t byte = *r->p++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *out = result;
+            return 0;
+        }
+        shift += 7;
+    }
+    return EINVAL;
+}
+
+static int pq_read_zigzag(pq_reader* r, int64_t* out) {
+    uint64_t n;
+    if (pq_read_varint(r, &n) != 0) return EINVAL;
+    *out = (int64_t)(n >> 1) ^ -(int64_t)(n & 1);
+    return 0;
+}
+
+static int pq_read_value(pq_reader* r, uint8_t type, int in_list, pq_node* node);
+
+static int pq_read_struct(pq_reader* r, pq_node* node) {
+    int cap = 0;
+    int16_t last_id = 0;
+
+    node->type = CT_STRUCT;
+    if (++r->depth > PQ_MAX_DEPTH) return EINVAL;
+
+    for (;;) {
+        if (r->p >= r->end) return EINVAL;
+        uint8_t header = *r->p++;
+        uint8_t type = header & 0x0f;
+        if (type == CT_STOP) break;
+
+        int16_t id;
+        uint8_t delta = header >> 4;
+        if (delta) {
+            id = (int16_t)(last_id + delta);
+        } else {
+            int64_t v;
+            if (pq_read_zigzag(r, &v) != 0) return EINVAL;
+            id = (int16_t)v;
+        }
+        last_id = id;
+
+        if (node->n == cap) {
+            cap = cap ? cap * 2 : 8;
+            pq_node* grown = (pq_node*)realloc(node->children, cap * sizeof(pq_node));
+            if (!grown) return ENOMEM;
+            node->children = grown;
+        }
+        pq_node* field = &node->children[node->n];
+        memset(field, 0, sizeof(*field));
+        node->n++;
+        field->id = id;
+        int ret = pq_read_value(r, type, 0, field);
+        if (ret != 0) return ret;
+    }
+
+    r->depth--;
+    return 0;
+}
+
+static int pq_read_value(pq_reader* r, uint8_t type, int in_list, pq_node* node) {
+    node->type = type;
+    switch (type) {
+        case CT_BOOLEAN_TRUE:
+        case CT_BOOLEAN_FALSE:
+            if (in_list) {
+                // List elements carry the boolean as a byte
+                if (r->p >= r->end) return EINVAL;
+                node->i = *r->p++;
+            } else {
+                node->i = (type == CT_BOOLEAN_TRUE);
+            }
+            return 0;
+        case CT_BYTE:
+            if (r->p >= r->end) return EINVAL;
+            node->i = (int8_t)*r->p++;
+            return 0;
+        case CT_I16:
+        case CT_I32:
+        case CT_I64:
+            return pq_read_zigzag(r, &node->i);
+        case CT_DOUBLE:
+            if (r->end - r->p < 8) return EINVAL;
+            memcpy(&node->d, r->p, 8);
+            r->p += 8;
+            return 0;
+        case CT_BINARY: {
+            uint64_t len;
+            if (pq_read_varint(r, &len) != 0) return EINVAL;
+            if (len > (uint64_t)(r->end - r->p)) return EINVAL;
+            node->bin = r->p;
+            node->bin_len = (uint32_t)len;
+            r->p += len;
+            return 0;
+        }
+        case CT_LIST:
+        case CT_SET: {
+            if (r->p >= r->end) return EINVAL;
+            uint8_t header = *r->p++;
+            uint64_t size = header >> 4;
+            node->elem_type = header & 0x0f;
+            if (size == 15 && pq_read_varint(r, &size) != 0) return EINVAL;
+            if (size > (uint64_t)(r->end - r->p)) return EINVAL;
+            if (++r->depth > PQ_MAX_DEPTH) return EINVAL;
+            if (size > 0) {
+                node->children = (pq_node*)calloc(size, sizeof(pq_node));
+                if (!node->children) return ENOMEM;
+            }
+            for (uint64_t k = 0; k < size; k++) {
+                node->n++;
+                int ret = (node->elem_type == CT_STRUCT)
+                    ? pq_read_struct(r, &node->children[k])
+                    : pq_read_value(r, node->elem_type, 1, &node->children[k]);
+                if (ret != 0) return ret;
+            }
+            r->depth--;
+            return 0;
+        }
+        case CT_MAP: {
+            uint64_t size;
+            if (pq_read_varint(r, &size) != 0) return EINVAL;
+            if (size == 0) return 0;
+            if (r->p >= r->end || size > (uint64_t)(r->end - r->p)) return EINVAL;
+            uint8_t kv = *r->p++;
+            node->elem_type = kv >> 4;
+            node->val_type = kv & 0x0f;
+            if (++r->depth > PQ_MAX_DEPTH) return EINVAL;
+            node->children = (pq_node*)calloc(2 * size, sizeof(pq_node));
+            if (!node->children) return ENOMEM;
+            for (uint64_t k = 0; k < 2 * size; k++) {
+                uint8_t t = (k % 2 == 0) ? node->elem_type : node->val_type;
+                node->n++;
+                int ret = (t == CT_STRUCT)
+                    ? pq_read_struct(r, &node->children[k])
+                    : pq_read_value(r, t, 1, &node->children[k]);
+                if (ret != 0) return ret;
+            }
+            r->depth--;
+            return 0;
+        }
+        case CT_STRUCT:
+            return pq_read_struct(r, node);
+        default:
+            return EINVAL;
+    }
+}
+
+// =============================================================================
+// Compact Protocol Encoding
+// =============================================================================
+
+static int pq_buf_reserve(pq_buffer* b, size_t extra) {
+    if (b->len + extra <= b->cap) return 0;
+    size_t cap = b->cap ? b->cap : 1024;
+    while (cap < b->len + extra) cap *= 2;
+    uint8_t* grown = (uint8_t*)realloc(b->data, cap);
+    if (!grown) return ENOMEM;
+    b->data = grown;
+    b->cap = cap;
+    return 0;
+}
+
+static int pq_write_bytes(pq_buffer* b, const void* src, size_t len) {
+    if (pq_buf_reserve(b, len) != 0) return ENOMEM;
+    if (len) memcpy(b->data + b->len, src, len);
+    b->len += len;
+    return 0;
+}
+
+static int pq_write_byte(pq_buffer* b, uint8_t byte) {
+    return pq_write_bytes(b, &byte, 1);
+}
+
+static int pq_write_varint(pq_buffer* b, uint64_t v) {
+    uint8_t tmp[10];
+    int n = 0;
+    do {
+        uint8_t byte = v & 0x7f;
+        v >>= 7;
+        if (v) byte |= 0x80;
+        tmp[n++] = byte;
+    } while (v);
+    return pq_write_bytes(b, tmp, n);
+}
+
+static int pq_write_zigzag(pq_buffer* b, int64_t v) {
+    return pq_write_varint(b, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+static int pq_write_value(pq_buffer* b, const pq_node* node, int in_list);
+
+static int pq_write_struct(pq_buffer* b, const pq_node* node) {
+    int16_t last_id = 0;
+    for (int k = 0; k < node->n; k++) {
+        const pq_node* field = &node->children[k];
+        uint8_t type = field->type;
+        if (type == CT_BOOLEAN_TRUE || type == CT_BOOLEAN_FALSE) {
+            type = field->i ? CT_BOOLEAN_TRUE : CT_BOOLEAN_FALSE;
+        }
+        int delta = field->id - last_id;
+        if (delta > 0 && delta <= 15) {
+            RETURN_IF_ERROR(pq_write_byte(b, (uint8_t)((delta << 4) | type)));
+        } else {
+            RETURN_IF_ERROR(pq_write_byte(b, type));
+            RETURN_IF_ERROR(pq_write_zigzag(b, field->id));
+        }
+        last_id = field->id;
+        RETURN_IF_ERROR(pq_write_value(b, field, 0));
+    }
+    return pq_write_byte(b, CT_STOP);
+}
+
+static int pq_write_value(pq_buffer* b, const pq_node* node, int in_list) {
+    switch (node->type) {
+        case CT_BOOLEAN_TRUE:
+        case CT_BOOLEAN_FALSE:
+            return in_list ? pq_write_byte(b, (uint8_t)node->i) : 0;
+        case CT_BYTE:
+            return pq_write_byte(b, (uint8_t)node->i);
+        case CT_I16:
+        case CT_I32:
+        case CT_I64:
+            return pq_write_zigzag(b, node->i);
+        case CT_DOUBLE:
+            return pq_write_bytes(b, &node->d, 8);
+        case CT_BINARY:
+            RETURN_IF_ERROR(pq_write_varint(b, node->bin_len));
+            return pq_write_bytes(b, node->bin, node->bin_len);
+        case CT_LIST:
+        case CT_SET:
+            if (node->n < 15) {
+                RETURN_IF_ERROR(pq_write_byte(b, (uint8_t)((node->n << 4) | node->elem_type)));
+            } else {
+                RETURN_IF_ERROR(pq_write_byte(b, (uint8_t)(0xf0 | node->elem_type)));
+                RETURN_IF_ERROR(pq_write_varint(b, (uint64_t)node->n));
+            }
+            for (int k = 0; k < node->n; k++) {
+                RETURN_IF_ERROR(pq_write_value(b, &node->children[k], 1));
+            }
+            return 0;
+        case CT_MAP:
+            RETURN_IF_ERROR(pq_write_varint(b, (uint64_t)(node->n / 2)));
+            if (node->n == 0) return 0;
+            RETURN_IF_ERROR(pq_write_byte(b, (uint8_t)((node->elem_type << 4) | node->val_type)));
+            for (int k = 0; k < node->n; k++) {
+                RETURN_IF_ERROR(pq_write_value(b, &node->children[k], 1));
+            }
+            return 0;
+        case CT_STRUCT:
+            return pq_write_struct(b, node);
+        default:
+            return EINVAL;
+    }
+}
+
+// =============================================================================
+// Tree Accessors
+// =============================================================================
+
+static pq_node* pq_field(const pq_node* node, int16_t id) {
+    if (!node || node->type != CT_STRUCT) return NULL;
+    for (int k = 0; k < node->n; k++) {
+        if (node->children[k].id == id) return &node->children[k];
+    }
+    return NULL;
+}
+
+// =============================================================================
+// Footer I/O
+// =============================================================================
+
+static void pq_footer_free(pq_footer_t* footer) {
+    pq_node_free(&footer->root);
+    free(footer->raw);
+    footer->raw = NULL;
+}
+
+/**
+ * Load and decode the FileMetaData footer of a Parquet file
+ *
+ * @param path Parquet file path
+ * @param footer Output footer (free with pq_footer_free)
+ * @param error_msg Buffer of 256 bytes for error details
+ * @return 0 on success, errno-style code on failure
+ */
+static int pq_footer_read(const char* path, pq_footer_t* footer, char* error_msg) {
+    memset(footer, 0, sizeof(*footer));
+
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        snprintf(error_msg, 256, "Failed to open Parquet file: %s", path);
+        return ENOENT;
+    }
+
+    uint8_t tail[8];
+    char head[4];
+    if (fread(head, 1, 4, fp) != 4 || memcmp(head, PQ_MAGIC, 4) != 0 ||
+        fseeko(fp, -8, SEEK_END) != 0 || fread(tail, 1, 8, fp) != 8 ||
+        memcmp(tail + 4, PQ_MAGIC, 4) != 0) {
+        fclose(fp);
+        snprintf(error_msg, 256, "Not a Parquet file: %s", path);
+        return EINVAL;
+    }
+
+    int64_t file_size = (int64_t)ftello(fp);
+    uint32_t len = (uint32_t)tail[0] | ((uint32_t)tail[1] << 8) |
+                   ((uint32_t)tail[2] << 16) | ((uint32_t)tail[3] << 24);
+    if ((int64_t)len + 12 > file_size) {
+        fclose(fp);
+        snprintf(error_msg, 256, "Corrupt Parquet footer length in %s", path);
+        return EINVAL;
+    }
+
+    footer->footer_start = file_size - 8 - len;
+    footer->raw_len = len;
+    footer->raw = (uint8_t*)malloc(len ? len : 1);
+    if (!footer->raw) {
+        fclose(fp);
+        snprintf(error_msg, 256, "Out of memory reading footer of %s", path);
+        return ENOMEM;
+    }
+    if (fseeko(fp, (off_t)footer->footer_start, SEEK_SET) != 0 ||
+        fread(footer->raw, 1, len, fp) != len) {
+        fclose(fp);
+        pq_footer_free(footer);
+        snprintf(error_msg, 256, "Failed to read Parquet footer of %s", path);
+        return EIO;
+    }
+    fclose(fp);
+
+    pq_reader r = {footer->raw, footer->raw + len, 0};
+    int ret = pq_read_struct(&r, &footer->root);
+    if (ret != 0) {
+        pq_footer_free(footer);
+        snprintf(error_msg, 256, "Failed to decode Parquet footer of %s", path);
+        return ret;
+    }
+    return 0;
+}
+
+/**
+ * Encode FileMetaData followed by the footer length and trailing magic
+ */
+static int pq_footer_encode(const pq_node* root, pq_buffer* out) {
+    size_t start = out->len;
+    RETURN_IF_ERROR(pq_write_struct(out, root));
+    uint32_t len = (uint32_t)(out->len - start);
+    uint8_t tail[8] = {
+        (uint8_t)(len & 0xff), (uint8_t)((len >> 8) & 0xff),
+        (uint8_t)((len >> 16) & 0xff), (uint8_t)((len >> 24) & 0xff),
+        'P', 'A', 'R', '1'
+    };
+    return pq_write_bytes(out, tail, 8);
+}
+
+// =============================================================================
+// Row Group Concatenation
+// =============================================================================
+
+KHASH_SET_INIT_STR(pq_strset)
+
+static int pq_bin_equal(const pq_node* a, const pq_node* b) {
+    if (!a || !b) return a == b;
+    return a->bin_len == b->bin_len && memcmp(a->bin, b->bin, a->bin_len) == 0;
+}
+
+static int pq_bin_is(const pq_node* node, const char* s) {
+    size_t len = strlen(s);
+    return node && node->type == CT_BINARY && node->bin_len == len &&
+           memcmp(node->bin, s, len) == 0;
+}
+
+/**
+ * Compare the schema element lists of two footers by their encoding
+ */
+static int pq_schema_equal(const pq_node* a, const pq_node* b) {
+    const pq_node* sa = pq_field(a, FMD_SCHEMA);
+    const pq_node* sb = pq_field(b, FMD_SCHEMA);
+    if (!sa || !sb) return 0;
+    pq_buffer ba = {NULL, 0, 0}, bb = {NULL, 0, 0};
+    int equal = pq_write_value(&ba, sa, 0) == 0 && pq_write_value(&bb, sb, 0) == 0 &&
+                ba.len == bb.len && memcmp(ba.data, bb.data, ba.len) == 0;
+    free(ba.data);
+    free(bb.data);
+    return equal;
+}
+
+static void pq_shift(pq_node* node, int16_t id, int64_t delta) {
+    pq_node* field = pq_field(node, id);
+    // Offset 0 is the leading magic, writers use it for "unset"
+    if (field && field->i > 0) field->i += delta;
+}
+
+/**
+ * Merge two VCF headers stored as key-value metadata
+ *
+ * Keeps every line of `a`, inserts the ## meta-lines of `b` that `a` lacks
+ * before the #CHROM line of `a`.
+ */
+static char* pq_merge_vcf_header(const pq_node* a, const pq_node* b, uint32_t* out_len) {
+    char* sa = (char*)malloc(a->bin_len + 1);
+    char* sb = (char*)malloc(b->bin_len + 1);
+    char* out = (char*)malloc(a->bin_len + b->bin_len + 2);
+    khash_t(pq_strset)* seen = kh_init(pq_strset);
+    if (!sa || !sb || !out || !seen) {
+        free(sa); free(sb); free(out);
+        if (seen) kh_destroy(pq_strset, seen);
+        return NULL;
+    }
+    memcpy(sa, a->bin, a->bin_len); sa[a->bin_len] = '\0';
+    memcpy(sb, b->bin, b->bin_len); sb[b->bin_len] = '\0';
+
+    size_t len = 0;
+    const char* chrom_line = NULL;
+    int absent;
+    for (char* line = strtok(sa, "\n"); line; line = strtok(NULL, "\n")) {
+        if (strncmp(line, "##", 2) != 0) {
+            if (!chrom_line) chrom_line = line;
+            continue;
+        }
+        kh_put(pq_strset, seen, line, &absent);
+        size_t l = strlen(line);
+        memcpy(out + len, line, l);
+        out[len + l] = '\n';
+        len += l + 1;
+    }
+    for (char* line = strtok(sb, "\n"); line; line = strtok(NULL, "\n")) {
+        if (strncmp(line, "##", 2) != 0) continue;
+        kh_put(pq_strset, seen, line, &absent);
+        if (!absent) continue;
+        size_t l = strlen(line);
+        memcpy(out + len, line, l);
+        out[len + l] = '\n';
+        len += l + 1;
+    }
+    if (chrom_line) {
+        size_t l = strlen(chrom_line);
+        memcpy(out + len, chrom_line, l);
+        len += l;
+    } else if (len > 0) {
+        len--;  // drop trailing newline
+    }
+
+    kh_destroy(pq_strset, seen);
+    free(sa);
+    free(sb);
+    *out_len = (uint32_t)len;
+    return out;
+}
+
+/**
+ * Build the merged key_value_metadata list from every footer: first value
+ * wins per key, except vcf_header values which are merged line-wise.
+ */
+static int pq_merge_kv(pq_footer_t* footers, int n, pq_node* merged) {
+    memset(merged, 0, sizeof(*merged));
+    merged->id = FMD_KV_METADATA;
+    merged->type = CT_LIST;
+    merged->elem_type = CT_STRUCT;
+
+    int cap = 0;
+    for (int f = 0; f < n; f++) {
+        pq_node* kv = pq_field(&footers[f].root, FMD_KV_METADATA);
+        for (int k = 0; kv && k < kv->n; k++) {
+            pq_node* entry = &kv->children[k];
+            pq_node* key = pq_field(entry, KV_KEY);
+            pq_node* value = pq_field(entry, KV_VALUE);
+            if (!key) continue;
+
+            pq_node* existing = NULL;
+            for (int m = 0; m < merged->n; m++) {
+                if (pq_bin_equal(pq_field(&merged->children[m], KV_KEY), key)) {
+                    existing = &merged->children[m];
+                    break;
+                }
+            }
+            if (existing) {
+                pq_node* old = pq_field(existing, KV_VALUE);
+                if (old && value && pq_bin_is(key, "vcf_header") && !pq_bin_equal(old, value)) {
+                    uint32_t len;
+                    char* header = pq_merge_vcf_header(old, value, &len);
+                    if (!header) return ENOMEM;
+                    if (old->bin_owned) free((void*)old->bin);
+                    old->bin = (const uint8_t*)header;
+                    old->bin_len = len;
+                    old->bin_owned = 1;
+                }
+                continue;
+            }
+
+            if (merged->n == cap) {
+                cap = cap ? cap * 2 : 8;
+                pq_node* grown = (pq_node*)realloc(merged->children, cap * sizeof(pq_node));
+                if (!grown) return ENOMEM;
+                merged->children = grown;
+            }
+            // Shallow copy of the KeyValue struct with its own field array
+            pq_node* copy = &merged->children[merged->n++];
+            *copy = *entry;
+            copy->children = (pq_node*)malloc(entry->n * sizeof(pq_node));
+            if (!copy->children) return ENOMEM;
+            memcpy(copy->children, entry->children, entry->n * sizeof(pq_node));
+        }
+    }
+    return 0;
+}
+
+static void pq_merged_kv_free(pq_node* merged) {
+    for (int m = 0; m < merged->n; m++) {
+        pq_node* value = pq_field(&merged->children[m], KV_VALUE);
+        if (value && value->bin_owned) free((void*)value->bin);
+        free(merged->children[m].children);
+    }
+    free(merged->children);
+    merged->children = NULL;
+    merged->n = 0;
+}
+
+static int pq_copy_range(FILE* in, FILE* out, int64_t start, int64_t len, uint8_t* buf) {
+    if (fseeko(in, (off_t)start, SEEK_SET) != 0) return EIO;
+    while (len > 0) {
+        size_t chunk = len > PQ_COPY_BUFFER ? PQ_COPY_BUFFER : (size_t)len;
+        if (fread(buf, 1, chunk, in) != chunk) return EIO;
+        if (fwrite(buf, 1, chunk, out) != chunk) return EIO;
+        len -= chunk;
+    }
+    return 0;
+}
+
+/**
+ * Re-encode a column chunk's OffsetIndex with page offsets shifted by `delta`
+ * and append it to the output. Page locations are absolute file offsets, so
+ * the original bytes cannot be reused as-is.
+ */
+static int pq_relocate_offset_index(FILE* in, FILE* out, int64_t* pos,
+                                    pq_node* chunk, int64_t delta) {
+    pq_node* off = pq_field(chunk, CC_OFFSET_INDEX_OFFSET);
+    pq_node* len = pq_field(chunk, CC_OFFSET_INDEX_LENGTH);
+    if (!off || !len || off->i <= 0 || len->i <= 0) return 0;
+
+    uint8_t* raw = (uint8_t*)malloc((size_t)len->i);
+    if (!raw) return ENOMEM;
+    if (fseeko(in, (off_t)off->i, SEEK_SET) != 0 ||
+        fread(raw, 1, (size_t)len->i, in) != (size_t)len->i) {
+        free(raw);
+        return EIO;
+    }
+
+    pq_node index;
+    memset(&index, 0, sizeof(index));
+    pq_reader r = {raw, raw + len->i, 0};
+    int ret = pq_read_struct(&r, &index);
+    if (ret == 0) {
+        pq_node* pages = pq_field(&index, OI_PAGE_LOCATIONS);
+        for (int p = 0; pages && p < pages->n; p++) {
+            pq_shift(&pages->children[p], PL_OFFSET, delta);
+        }
+        pq_buffer enc = {NULL, 0, 0};
+        ret = pq_write_struct(&enc, &index);
+        if (ret == 0 && fwrite(enc.data, 1, enc.len, out) != enc.len) ret = EIO;
+        if (ret == 0) {
+            off->i = *pos;
+            len->i = (int64_t)enc.len;
+            *pos += (int64_t)enc.len;
+        }
+        free(enc.data);
+    }
+    pq_node_free(&index);
+    free(raw);
+    return ret;
+}
+
+/**
+ * Concatenate Parquet files with identical schemas at row group level
+ *
+ * Column chunk bytes (pages, dictionaries, bloom filters, column indexes)
+ * are copied verbatim; only footer offsets are shifted and the footer is
+ * rebuilt with the union of row groups and merged key-value metadata.
+ *
+ * @return 0 on success, EDOM if schemas differ, other errno-style codes on
+ *   I/O failure
+ */
+static int pq_concat_files(const char** inputs, int n, const char* output,
+                           int64_t* out_rows, int* out_row_groups, char* error_msg) {
+    pq_footer_t* footers = (pq_footer_t*)calloc(n, sizeof(pq_footer_t));
+    int64_t* deltas = (int64_t*)calloc(n, sizeof(int64_t));
+    uint8_t* buf = (uint8_t*)malloc(PQ_COPY_BUFFER);
+    FILE* out = NULL;
+    pq_node merged_kv;
+    memset(&merged_kv, 0, sizeof(merged_kv));
+    int n_read = 0;
+    int ret = 0;
+
+    if (!footers || !deltas || !buf) {
+        snprintf(error_msg, 256, "Out of memory concatenating Parquet files");
+        ret = ENOMEM;
+        goto cleanup;
+    }
+
+    for (; n_read < n; n_read++) {
+        ret = pq_footer_read(inputs[n_read], &footers[n_read], error_msg);
+        if (ret != 0) goto cleanup;
+        if (n_read > 0 && !pq_schema_equal(&footers[0].root, &footers[n_read].root)) {
+            snprintf(error_msg, 256, "Schema of %s differs from %s", inputs[n_read], inputs[0]);
+            n_read++;
+            ret = EDOM;
+            goto cleanup;
+        }
+    }
+
+    out = fopen(output, "wb");
+    if (!out) {
+        snprintf(error_msg, 256, "Failed to open %s for writing", output);
+        ret = ENOENT;
+        goto cleanup;
+    }
+    if (fwrite(PQ_MAGIC, 1, 4, out) != 4) {
+        ret = EIO;
+        goto io_error;
+    }
+
+    // Data section: copy every file's bytes between magic and footer
+    int64_t pos = 4;
+    int total_rg = 0;
+    int64_t total_rows = 0;
+    for (int f = 0; f < n; f++) {
+        FILE* in = fopen(inputs[f], "rb");
+        if (!in) {
+            ret = EIO;
+            goto io_error;
+        }
+        int64_t len = footers[f].footer_start - 4;
+        ret = pq_copy_range(in, out, 4, len, buf);
+        fclose(in);
+        if (ret != 0) goto io_error;
+        deltas[f] = pos - 4;
+        pos += len;
+
+        pq_node* rgs = pq_field(&footers[f].root, FMD_ROW_GROUPS);
+        for (int g = 0; rgs && g < rgs->n; g++) {
+            pq_node* rg = &rgs->children[g];
+            pq_node* nrows = pq_field(rg, RG_NUM_ROWS);
+            if (nrows) total_rows += nrows->i;
+            pq_shift(rg, RG_FILE_OFFSET, deltas[f]);
+            pq_node* cols = pq_field(rg, RG_COLUMNS);
+            for (int c = 0; cols && c < cols->n; c++) {
+                pq_node* chunk = &cols->children[c];
+                pq_node* meta = pq_field(chunk, CC_META_DATA);
+                pq_shift(chunk, CC_FILE_OFFSET, deltas[f]);
+                pq_shift(chunk, CC_COLUMN_INDEX_OFFSET, deltas[f]);
+                pq_shift(meta, CMD_DATA_PAGE_OFFSET, deltas[f]);
+                pq_shift(meta, CMD_INDEX_PAGE_OFFSET, deltas[f]);
+                pq_shift(meta, CMD_DICT_PAGE_OFFSET, deltas[f]);
+                pq_shift(meta, CMD_BLOOM_OFFSET, deltas[f]);
+            }
+        }
+        total_rg += rgs ? rgs->n : 0;
+    }
+
+    // Offset indexes hold absolute page offsets and are rewritten after data
+    for (int f = 0; f < n; f++) {
+        pq_node* rgs = pq_field(&footers[f].root, FMD_ROW_GROUPS);
+        FILE* in = NULL;
+        for (int g = 0; rgs && g < rgs->n; g++) {
+            pq_node* cols = pq_field(&rgs->children[g], RG_COLUMNS);
+            for (int c = 0; cols && c < cols->n; c++) {
+                pq_node* chunk = &cols->children[c];
+                if (!pq_field(chunk, CC_OFFSET_INDEX_OFFSET)) continue;
+                if (!in && !(in = fopen(inputs[f], "rb"))) {
+                    ret = EIO;
+                    goto io_error;
+                }
+                ret = pq_relocate_offset_index(in, out, &pos, chunk, deltas[f]);
+                if (ret != 0) {
+                    fclose(in);
+                    goto io_error;
+                }
+            }
+        }
+        if (in) fclose(in);
+    }
+
+    // Footer: first file's metadata with all row groups and merged KV
+    pq_node* all_rg = (pq_node*)malloc((total_rg ? total_rg : 1) * sizeof(pq_node));
+    if (!all_rg) {
+        ret = ENOMEM;
+        goto io_error;
+    }
+    int g_out = 0;
+    for (int f = 0; f < n; f++) {
+        pq_node* rgs = pq_field(&footers[f].root, FMD_ROW_GROUPS);
+        for (int g = 0; rgs && g < rgs->n; g++) {
+            all_rg[g_out] = rgs->children[g];
+            pq_node* ordinal = pq_field(&all_rg[g_out], RG_ORDINAL);
+            if (ordinal) ordinal->i = g_out;
+            g_out++;
+        }
+        if (rgs) {
+            free(rgs->children);
+            rgs->children = NULL;
+            rgs->n = 0;
+        }
+    }
+    pq_node* root_rgs = pq_field(&footers[0].root, FMD_ROW_GROUPS);
+    if (root_rgs) {
+        root_rgs->children = all_rg;
+        root_rgs->n = total_rg;
+    } else {
+        free(all_rg);
+    }
+    pq_node* num_rows = pq_field(&footers[0].root, FMD_NUM_ROWS);
+    if (num_rows) num_rows->i = total_rows;
+
+    ret = pq_merge_kv(footers, n, &merged_kv);
+    if (ret != 0) goto io_error;
+    pq_node* root = &footers[0].root;
+    pq_node* root_kv = pq_field(root, FMD_KV_METADATA);
+    pq_node saved_kv;
+    pq_node* saved_fields = NULL;
+    if (root_kv) {
+        saved_kv = *root_kv;
+        root_kv->children = merged_kv.children;
+        root_kv->n = merged_kv.n;
+    } else if (merged_kv.n > 0) {
+        // The first file has no key-value metadata: insert the merged list
+        // among the root fields, in field id order
+        pq_node* fields = (pq_node*)malloc((root->n + 1) * sizeof(pq_node));
+        if (!fields) {
+            ret = ENOMEM;
+            goto io_error;
+        }
+        int at = 0;
+        while (at < root->n && root->children[at].id < FMD_KV_METADATA) at++;
+        memcpy(fields, root->children, at * sizeof(pq_node));
+        fields[at] = merged_kv;
+        memcpy(fields + at + 1, root->children + at, (root->n - at) * sizeof(pq_node));
+        saved_fields = root->children;
+        root->children = fields;
+        root->n++;
+    }
+
+    pq_buffer enc = {NULL, 0, 0};
+    ret = pq_footer_encode(root, &enc);
+    if (root_kv) {
+        *root_kv = saved_kv;
+    } else if (saved_fields) {
+        free(root->children);
+        root->children = saved_fields;
+        root->n--;
+    }
+    if (ret == 0 && fwrite(enc.data, 1, enc.len, out) != enc.len) ret = EIO;
+    free(enc.data);
+    if (ret != 0) goto io_error;
+
+    if (fclose(out) != 0) {
+        out = NULL;
+        ret = EIO;
+        goto io_error;
+    }
+    out = NULL;
+    *out_rows = total_rows;
+    *out_row_groups = total_rg;
+    goto cleanup;
+
+io_error:
+    snprintf(error_msg, 256, "Failed to write concatenated Parquet file %s", output);
+    if (out) fclose(out);
+    out = NULL;
+    remove(output);
+
+cleanup:
+    pq_merged_kv_free(&merged_kv);
+    for (int f = 0; f < n_read; f++) pq_footer_free(&footers[f]);
+    free(footers);
+    free(deltas);
+    free(buf);
+    return ret;
+}
+
+/**
+ * Concatenate Parquet files without re-encoding column data
+ *
+ * @param inputs_sexp Character vector of input Parquet files (same schema)
+ * @param output_sexp Output Parquet path
+ * @return List with merged (logical), num_rows (double) and num_row_groups
+ *   (integer). merged is FALSE when the input schemas differ, in which case
+ *   no output is written.
+ */
+SEXP RC_parquet_concat_files(SEXP inputs_sexp, SEXP output_sexp) {
+    if (TYPEOF(inputs_sexp) != STRSXP || Rf_length(inputs_sexp) < 1) {
+        Rf_error("inputs must be a non-empty character vector");
+    }
+    if (TYPEOF(output_sexp) != STRSXP || Rf_length(output_sexp) != 1) {
+        Rf_error("output must be a single character string");
+    }
+
+    int n = Rf_length(inputs_sexp);
+    const char** inputs = (const char**)R_alloc(n, sizeof(char*));
+    for (int i = 0; i < n; i++) inputs[i] = CHAR(STRING_ELT(inputs_sexp, i));
+
+    char error_msg[256];
+    int64_t rows = 0;
+    int row_groups = 0;
+    int ret = pq_concat_files(inputs, n, CHAR(STRING_ELT(output_sexp, 0)),
+                              &rows, &row_groups, error_msg);
+    if (ret != 0 && ret != EDOM) {
+        Rf_error("%s", error_msg);
+    }
+
+    SEXP result = PROTECT(Rf_allocVector(VECSXP, 3));
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, 3));
+    SET_VECTOR_ELT(result, 0, Rf_ScalarLogical(ret == 0));
+    SET_VECTOR_ELT(result, 1, Rf_ScalarReal((double)rows));
+    SET_VECTOR_ELT(result, 2, Rf_ScalarInteger(row_groups));
+    SET_STRING_ELT(names, 0, Rf_mkChar("merged"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("num_rows"));
+    SET_STRING_ELT(names, 2, Rf_mkChar("num_row_groups"));
+    Rf_setAttrib(result, R_NamesSymbol, names);
+    UNPROTECT(2);
+    return result;
+}
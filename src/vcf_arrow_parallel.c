@@ -0,0 +1,735 @@
+// Parallel VCF/BCF to Arrow Stream Implementation
+// Runs several vcf_arrow_stream workers over index regions of one file inside
+// a single process. The header and index are loaded once; each worker has its
+// own file handle and header copy. Workers claim the largest regions first
+// and park finished batches in a reorder buffer per region, from which the
+// consumer takes them in region order.
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_arrow_parallel.h"
+#include "vcf_region_plan.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+// webR/Emscripten builds have no pthreads; regions are then read sequentially
+#ifndef __EMSCRIPTEN__
+#define VCF_PARALLEL_USE_THREADS 1
+#include <pthread.h>
+#endif
+
+// =============================================================================
+// Constants and Types
+// =============================================================================
+
+#define VCF_PARALLEL_QUEUE_PER_WORKER 2
+#define VCF_PARALLEL_MAX_REPORTED 8
+
+typedef struct vcf_parallel_private_t vcf_parallel_private_t;
+
+typedef struct {
+    vcf_parallel_private_t* owner;
+    struct ArrowArrayStream stream;   // Worker stream (borrows the index)
+} vcf_parallel_worker_t;
+
+// Finished batches of one region not yet taken, oldest first
+typedef struct {
+    struct ArrowArray* batches;
+    int head;
+    int len;
+    int cap;
+} vcf_parallel_buffer_t;
+
+struct vcf_parallel_private_t {
+    // Shared state, read-only once the workers are running
+    vcf_arrow_options_t opts;
+    char* samples;                    // Owned copies of the option strings
+    char* vep_tag;
+    char* vep_columns;
+    htsFile* fp;
+    bcf_hdr_t* hdr;                   // Header used for the schema
+    hts_idx_t* idx;
+    tbx_t* tbx;
+    vcf_handle_t* handle;             // Reference on opts.handle, which owns idx/tbx
+    char** regions;
+    int n_regions;
+    vcf_parallel_worker_t* workers;
+    int n_workers;
+
+    // Work dispatch and ordered output
+    int* dispatch;                    // Regions in claim order, largest first
+    int next_dispatch;                // Next entry of dispatch to claim
+    int* claims;                      // Regions in the order they were claimed
+    int n_claimed;
+    uint8_t* region_claimed;
+    int next_region;                  // Sequential mode: next region to read
+    int current_region;               // Sequential mode: region being read
+    int emit_region;                  // Region whose batches are returned next
+    uint8_t* region_done;             // Regions whose last batch is buffered
+    vcf_parallel_buffer_t* buffers;   // Reorder buffer of each region
+    int n_buffered;                   // Batches in all reorder buffers
+    int max_buffered;                 // Budget for regions ahead of emit_region
+    int n_running;                    // Workers that have not exited yet
+    int stop;                         // Stop dispatching (failure or release)
+    int n_failed;
+    kstring_t failures;               // "region (reason); ..." for the first failures
+
+#ifdef VCF_PARALLEL_USE_THREADS
+    pthread_t* threads;
+    int n_started;
+    pthread_mutex_t lock;
+    pthread_cond_t can_put;
+    pthread_cond_t can_get;
+    int sync_init;
+#endif
+
+    char error_msg[1024];
+};
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static char* vcf_parallel_strdup(const char* s) {
+    return s ? strdup(s) : NULL;
+}
+
+/**
+ * Record a failed region. Must be called with the lock held.
+ */
+static void vcf_parallel_record_failure(vcf_parallel_private_t* priv,
+                                        const char* region,
+                                        const char* reason) {
+    priv->n_failed++;
+    priv->stop = 1;
+    if (priv->n_failed <= VCF_PARALLEL_MAX_REPORTED) {
+        ksprintf(&priv->failures, "%s%s (%s)",
+                 priv->n_failed > 1 ? "; " : "",
+                 region,
+                 reason && reason[0] ? reason : "unknown error");
+    }
+}
+
+static void vcf_parallel_format_error(vcf_parallel_private_t* priv) {
+    snprintf(priv->error_msg, sizeof(priv->error_msg),
+             "%d of %d regions failed: %s%s",
+             priv->n_failed, priv->n_regions,
+             priv->failures.s ? priv->failures.s : "",
+             priv->n_failed > VCF_PARALLEL_MAX_REPORTED ? "; ..." : "");
+}
+
+/**
+ * Load the CSI/TBI index the same way vcf_arrow_stream_init() does for
+ * region queries: VCF tries TBI then CSI, BCF uses CSI only.
+ */
+static int vcf_parallel_load_index(vcf_parallel_private_t* priv,
+                                   const char* filename,
+                                   const char* index) {
+    int flags = HTS_IDX_SAVE_REMOTE | HTS_IDX_SILENT_FAIL;
+
+    if (priv->opts.handle) {
+        if (!vcf_handle_index(priv->opts.handle)) return ENOENT;
+        // The handle stays open while we hold a reference
+        priv->handle = priv->opts.handle;
+        vcf_handle_ref(priv->handle);
+        priv->idx = priv->handle->idx;
+        priv->tbx = priv->handle->tbx;
+        // Workers borrow idx/tbx from us, not from the handle
+        priv->opts.handle = NULL;
+        return 0;
+    }
+
+    if (priv->fp->format.format == vcf) {
+        priv->tbx = tbx_index_load3(filename, index, flags);
+        if (priv->tbx) {
+            priv->idx = priv->tbx->idx;
+            return 0;
+        }
+    }
+    priv->idx = bcf_index_load3(filename, index, flags);
+    return priv->idx ? 0 : ENOENT;
+}
+
+typedef struct {
+    int rid;                          // Header contig id, -1 if undeclared
+    vcf_region_unit_t* unit;
+} vcf_parallel_sort_key_t;
+
+// Header order of contigs (undeclared ones last, by name), then window start
+static int vcf_parallel_unit_cmp(const void* a, const void* b) {
+    const vcf_parallel_sort_key_t* ka = (const vcf_parallel_sort_key_t*)a;
+    const vcf_parallel_sort_key_t* kb = (const vcf_parallel_sort_key_t*)b;
+    if (ka->rid != kb->rid) {
+        if (ka->rid < 0) return 1;
+        if (kb->rid < 0) return -1;
+        return ka->rid < kb->rid ? -1 : 1;
+    }
+    if (ka->rid < 0) {
+        int c = strcmp(ka->unit->contig, kb->unit->contig);
+        if (c != 0) return c;
+    }
+    return ka->unit->beg < kb->unit->beg ? -1 : (ka->unit->beg > kb->unit->beg);
+}
+
+/**
+ * Plan regions from the index: contigs without records are skipped and
+ * large contigs are split. Regions are returned in genomic order; their
+ * estimated sizes go to *sizes for the dispatch order.
+ */
+static int vcf_parallel_plan_regions(vcf_parallel_private_t* priv, int n_threads,
+                                     double** sizes) {
+    vcf_region_plan_t plan;
+    int ret = vcf_region_plan_build(priv->idx, priv->tbx, priv->hdr, n_threads, &plan);
+    if (ret != 0) return ret;
+
+    vcf_parallel_sort_key_t* keys = (vcf_parallel_sort_key_t*)malloc(
+        (plan.n_units > 0 ? plan.n_units : 1) * sizeof(vcf_parallel_sort_key_t));
+    priv->regions = (char**)calloc(plan.n_units > 0 ? plan.n_units : 1, sizeof(char*));
+    *sizes = (double*)malloc((plan.n_units > 0 ? plan.n_units : 1) * sizeof(double));
+    if (!keys || !priv->regions || !*sizes) {
+        free(keys);
+        vcf_region_plan_destroy(&plan);
+        return ENOMEM;
+    }
+    for (int i = 0; i < plan.n_units; i++) {
+        keys[i].rid = bcf_hdr_name2id(priv->hdr, plan.units[i].contig);
+        keys[i].unit = &plan.units[i];
+    }
+    qsort(keys, plan.n_units, sizeof(vcf_parallel_sort_key_t), vcf_parallel_unit_cmp);
+
+    // Take ownership of the region strings
+    for (int i = 0; i < plan.n_units; i++) {
+        priv->regions[i] = keys[i].unit->region;
+        keys[i].unit->region = NULL;
+        (*sizes)[i] = (double)keys[i].unit->bytes;
+        priv->n_regions++;
+    }
+    free(keys);
+    vcf_region_plan_destroy(&plan);
+    return 0;
+}
+
+typedef struct {
+    double size;
+    int region;
+} vcf_parallel_dispatch_key_t;
+
+// Largest first (LPT), ties in region order
+static int vcf_parallel_dispatch_cmp(const void* a, const void* b) {
+    const vcf_parallel_dispatch_key_t* ka = (const vcf_parallel_dispatch_key_t*)a;
+    const vcf_parallel_dispatch_key_t* kb = (const vcf_parallel_dispatch_key_t*)b;
+    if (ka->size != kb->size) return ka->size > kb->size ? -1 : 1;
+    return ka->region < kb->region ? -1 : (ka->region > kb->region);
+}
+
+/**
+ * Order in which the regions are claimed: largest first, so the longest
+ * regions do not start last, or the order of the regions without sizes.
+ */
+static int vcf_parallel_set_dispatch(vcf_parallel_private_t* priv, const double* sizes) {
+    int n = priv->n_regions > 0 ? priv->n_regions : 1;
+    vcf_parallel_dispatch_key_t* keys =
+        (vcf_parallel_dispatch_key_t*)malloc(n * sizeof(vcf_parallel_dispatch_key_t));
+    priv->dispatch = (int*)malloc(n * sizeof(int));
+    priv->claims = (int*)malloc(n * sizeof(int));
+    priv->region_claimed = (uint8_t*)calloc(n, 1);
+    if (!keys || !priv->dispatch || !priv->claims || !priv->region_claimed) {
+        free(keys);
+        return ENOMEM;
+    }
+    for (int i = 0; i < priv->n_regions; i++) {
+        keys[i].size = sizes ? sizes[i] : 0;
+        keys[i].region = i;
+    }
+    qsort(keys, priv->n_regions, sizeof(vcf_parallel_dispatch_key_t), vcf_parallel_dispatch_cmp);
+    for (int i = 0; i < priv->n_regions; i++) priv->dispatch[i] = keys[i].region;
+    free(keys);
+    return 0;
+}
+
+// =============================================================================
+// Worker Threads
+// =============================================================================
+
+#ifdef VCF_PARALLEL_USE_THREADS
+
+/**
+ * Claim the next region, or -1 when all are claimed. Must be called with the
+ * lock held.
+ *
+ * Regions go largest first, except when the reorder buffers are over budget
+ * and nobody reads the region the consumer waits for: that one is claimed
+ * next, so the buffered regions can drain.
+ */
+static int vcf_parallel_claim(vcf_parallel_private_t* priv) {
+    if (priv->n_claimed >= priv->n_regions) return -1;
+
+    int r;
+    if (priv->n_buffered >= priv->max_buffered &&
+        !priv->region_claimed[priv->emit_region]) {
+        r = priv->emit_region;
+    } else {
+        do {
+            r = priv->dispatch[priv->next_dispatch++];
+        } while (priv->region_claimed[r]);
+    }
+    priv->region_claimed[r] = 1;
+    priv->claims[priv->n_claimed++] = r;
+    return r;
+}
+
+/**
+ * Move a batch of region r into its reorder buffer. Returns 0 on success,
+ * -1 once stopped and ENOMEM on allocation failure (the batch then stays
+ * with the caller).
+ *
+ * The region being emitted keeps at most VCF_PARALLEL_QUEUE_PER_WORKER
+ * batches, which the consumer drains. Regions ahead of it wait while the
+ * buffers hold max_buffered batches, unless nobody reads the emitted region
+ * yet; then they run on until a worker is free to claim it.
+ */
+static int vcf_parallel_put(vcf_parallel_private_t* priv, int r,
+                            struct ArrowArray* batch) {
+    vcf_parallel_buffer_t* buf = &priv->buffers[r];
+
+    pthread_mutex_lock(&priv->lock);
+    for (;;) {
+        if (priv->stop) {
+            pthread_mutex_unlock(&priv->lock);
+            return -1;
+        }
+        if (r == priv->emit_region) {
+            if (buf->len < VCF_PARALLEL_QUEUE_PER_WORKER) break;
+        } else if (priv->n_buffered < priv->max_buffered ||
+                   !priv->region_claimed[priv->emit_region]) {
+            break;
+        }
+        pthread_cond_wait(&priv->can_put, &priv->lock);
+    }
+
+    if (buf->len == buf->cap) {
+        int cap = buf->cap > 0 ? buf->cap * 2 : VCF_PARALLEL_QUEUE_PER_WORKER;
+        struct ArrowArray* batches = (struct ArrowArray*)malloc(cap * sizeof(struct ArrowArray));
+        if (!batches) {
+            pthread_mutex_unlock(&priv->lock);
+            return ENOMEM;
+        }
+        for (int i = 0; i < buf->len; i++) {
+            batches[i] = buf->batches[(buf->head + i) % buf->cap];
+        }
+        free(buf->batches);
+        buf->batches = batches;
+        buf->head = 0;
+        buf->cap = cap;
+    }
+    buf->batches[(buf->head + buf->len) % buf->cap] = *batch;
+    buf->len++;
+    priv->n_buffered++;
+    pthread_cond_broadcast(&priv->can_get);
+    pthread_mutex_unlock(&priv->lock);
+
+    batch->release = NULL;
+    return 0;
+}
+
+static void* vcf_parallel_worker_main(void* arg) {
+    vcf_parallel_worker_t* worker = (vcf_parallel_worker_t*)arg;
+    vcf_parallel_private_t* priv = worker->owner;
+    struct ArrowArrayStream* ws = &worker->stream;
+
+    for (;;) {
+        pthread_mutex_lock(&priv->lock);
+        int r = priv->stop ? -1 : vcf_parallel_claim(priv);
+        pthread_mutex_unlock(&priv->lock);
+        if (r < 0) break;
+
+        int ret = vcf_arrow_stream_set_region(ws, priv->regions[r]);
+        int oom = 0;
+        while (ret == 0) {
+            struct ArrowArray batch;
+            ret = ws->get_next(ws, &batch);
+            if (ret != 0 || batch.release == NULL) break;
+            int put = vcf_parallel_put(priv, r, &batch);
+            if (put != 0) {
+                batch.release(&batch);
+                oom = put == ENOMEM;
+                break;
+            }
+        }
+
+        pthread_mutex_lock(&priv->lock);
+        if (ret != 0 || oom) {
+            vcf_parallel_record_failure(priv, priv->regions[r],
+                                        oom ? "out of memory" : ws->get_last_error(ws));
+            pthread_cond_broadcast(&priv->can_put);
+        } else {
+            priv->region_done[r] = 1;
+        }
+        pthread_cond_broadcast(&priv->can_get);
+        pthread_mutex_unlock(&priv->lock);
+    }
+
+    pthread_mutex_lock(&priv->lock);
+    priv->n_running--;
+    pthread_cond_broadcast(&priv->can_get);
+    pthread_mutex_unlock(&priv->lock);
+    return NULL;
+}
+
+#endif // VCF_PARALLEL_USE_THREADS
+
+// =============================================================================
+// Stream Callbacks
+// =============================================================================
+
+static int vcf_parallel_get_schema(struct ArrowArrayStream* stream, struct ArrowSchema* out) {
+    vcf_parallel_private_t* priv = (vcf_parallel_private_t*)stream->private_data;
+
+    int ret = vcf_arrow_schema_from_header(priv->hdr, out, &priv->opts);
+    if (ret != 0) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg), "Failed to create schema");
+    }
+    return ret;
+}
+
+/**
+ * Sequential fallback: worker 0 reads the regions one after another on the
+ * calling thread.
+ */
+static int vcf_parallel_get_next_sequential(vcf_parallel_private_t* priv,
+                                            struct ArrowArray* out) {
+    struct ArrowArrayStream* ws = &priv->workers[0].stream;
+
+    if (priv->n_failed > 0) return EIO;
+
+    for (;;) {
+        if (priv->current_region >= 0) {
+            int ret = ws->get_next(ws, out);
+            if (ret != 0) {
+                vcf_parallel_record_failure(priv, priv->regions[priv->current_region],
+                                            ws->get_last_error(ws));
+                vcf_parallel_format_error(priv);
+                return EIO;
+            }
+            if (out->release != NULL) return 0;
+        }
+        if (priv->next_region >= priv->n_regions) break;
+
+        priv->current_region = priv->next_region++;
+        priv->claims[priv->n_claimed++] = priv->current_region;
+        if (vcf_arrow_stream_set_region(ws, priv->regions[priv->current_region]) != 0) {
+            vcf_parallel_record_failure(priv, priv->regions[priv->current_region],
+                                        ws->get_last_error(ws));
+            vcf_parallel_format_error(priv);
+            return EIO;
+        }
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->release = NULL;
+    return 0;
+}
+
+static int vcf_parallel_get_next(struct ArrowArrayStream* stream, struct ArrowArray* out) {
+    vcf_parallel_private_t* priv = (vcf_parallel_private_t*)stream->private_data;
+
+#ifdef VCF_PARALLEL_USE_THREADS
+    if (priv->n_started > 0) {
+        pthread_mutex_lock(&priv->lock);
+        for (;;) {
+            // On failure, wait for the running regions so all failures are reported
+            if (priv->n_failed > 0) {
+                if (priv->n_running > 0) {
+                    pthread_cond_wait(&priv->can_get, &priv->lock);
+                    continue;
+                }
+                vcf_parallel_format_error(priv);
+                pthread_mutex_unlock(&priv->lock);
+                return EIO;
+            }
+            if (priv->emit_region >= priv->n_regions) break;
+
+            // Batches are returned region by region, in the order of the regions
+            vcf_parallel_buffer_t* buf = &priv->buffers[priv->emit_region];
+            if (buf->len > 0) {
+                *out = buf->batches[buf->head];
+                buf->head = (buf->head + 1) % buf->cap;
+                buf->len--;
+                priv->n_buffered--;
+                pthread_cond_broadcast(&priv->can_put);
+                pthread_mutex_unlock(&priv->lock);
+                return 0;
+            }
+            if (priv->region_done[priv->emit_region]) {
+                priv->emit_region++;
+                pthread_cond_broadcast(&priv->can_put);
+                continue;
+            }
+            if (priv->n_running == 0) break;
+            pthread_cond_wait(&priv->can_get, &priv->lock);
+        }
+        pthread_mutex_unlock(&priv->lock);
+
+        memset(out, 0, sizeof(*out));
+        out->release = NULL;
+        return 0;
+    }
+#endif
+
+    return vcf_parallel_get_next_sequential(priv, out);
+}
+
+static const char* vcf_parallel_get_last_error(struct ArrowArrayStream* stream) {
+    vcf_parallel_private_t* priv = (vcf_parallel_private_t*)stream->private_data;
+    return priv->error_msg[0] ? priv->error_msg : NULL;
+}
+
+static void vcf_parallel_release(struct ArrowArrayStream* stream) {
+    vcf_parallel_private_t* priv = (vcf_parallel_private_t*)stream->private_data;
+
+    if (priv) {
+#ifdef VCF_PARALLEL_USE_THREADS
+        if (priv->n_started > 0) {
+            pthread_mutex_lock(&priv->lock);
+            priv->stop = 1;
+            pthread_cond_broadcast(&priv->can_put);
+            pthread_mutex_unlock(&priv->lock);
+            for (int i = 0; i < priv->n_started; i++) {
+                pthread_join(priv->threads[i], NULL);
+            }
+        }
+        free(priv->threads);
+        if (priv->sync_init) {
+            pthread_mutex_destroy(&priv->lock);
+            pthread_cond_destroy(&priv->can_put);
+            pthread_cond_destroy(&priv->can_get);
+        }
+#endif
+
+        if (priv->workers) {
+            for (int i = 0; i < priv->n_workers; i++) {
+                struct ArrowArrayStream* ws = &priv->workers[i].stream;
+                if (ws->release) ws->release(ws);
+            }
+            free(priv->workers);
+        }
+        if (priv->buffers) {
+            // Batches that were never consumed
+            for (int r = 0; r < priv->n_regions; r++) {
+                vcf_parallel_buffer_t* buf = &priv->buffers[r];
+                for (int j = 0; j < buf->len; j++) {
+                    struct ArrowArray* batch = &buf->batches[(buf->head + j) % buf->cap];
+                    if (batch->release) batch->release(batch);
+                }
+                free(buf->batches);
+            }
+            free(priv->buffers);
+        }
+        free(priv->region_done);
+        free(priv->region_claimed);
+        free(priv->dispatch);
+        free(priv->claims);
+
+        if (priv->regions) {
+            for (int i = 0; i < priv->n_regions; i++) free(priv->regions[i]);
+            free(priv->regions);
+        }
+
+        // Workers only borrowed the index
+        if (priv->handle) {
+            vcf_handle_close(priv->handle);
+        } else if (priv->tbx) {
+            tbx_destroy(priv->tbx);
+        } else if (priv->idx) {
+            hts_idx_destroy(priv->idx);
+        }
+        if (priv->hdr) bcf_hdr_destroy(priv->hdr);
+        if (priv->fp) hts_close(priv->fp);
+
+        free(priv->failures.s);
+        free(priv->samples);
+        free(priv->vep_tag);
+        free(priv->vep_columns);
+        free(priv);
+    }
+    stream->private_data = NULL;
+    stream->release = NULL;
+}
+
+// =============================================================================
+// Public API Implementation
+// =============================================================================
+
+int vcf_arrow_parallel_stream_claims(struct ArrowArrayStream* stream, int* out, int n) {
+    if (!stream || !stream->release || stream->get_next != &vcf_parallel_get_next) return -1;
+    vcf_parallel_private_t* priv = (vcf_parallel_private_t*)stream->private_data;
+    if (!priv || !priv->claims) return 0;
+
+#ifdef VCF_PARALLEL_USE_THREADS
+    if (priv->sync_init) pthread_mutex_lock(&priv->lock);
+#endif
+    int n_claimed = priv->n_claimed;
+    if (n_claimed > 0 && n > 0) {
+        memcpy(out, priv->claims, (n_claimed < n ? n_claimed : n) * sizeof(int));
+    }
+#ifdef VCF_PARALLEL_USE_THREADS
+    if (priv->sync_init) pthread_mutex_unlock(&priv->lock);
+#endif
+    return n_claimed;
+}
+
+int vcf_arrow_parallel_stream_init(struct ArrowArrayStream* stream,
+                                   const char* filename,
+                                   const char** regions,
+                                   const double* sizes,
+                                   int n_regions,
+                                   int n_threads,
+                                   const vcf_arrow_options_t* opts) {
+    vcf_parallel_private_t* priv = (vcf_parallel_private_t*)calloc(1, sizeof(vcf_parallel_private_t));
+    if (!priv) {
+        return ENOMEM;
+    }
+
+    // Initialize stream function pointers EARLY so get_last_error works on failure
+    stream->get_schema = &vcf_parallel_get_schema;
+    stream->get_next = &vcf_parallel_get_next;
+    stream->get_last_error = &vcf_parallel_get_last_error;
+    stream->release = &vcf_parallel_release;
+    stream->private_data = priv;
+
+    priv->current_region = -1;
+
+    // Copy options; the strings may not outlive this call
+    if (opts) {
+        priv->opts = *opts;
+    } else {
+        vcf_arrow_options_init(&priv->opts);
+    }
+    priv->samples = vcf_parallel_strdup(priv->opts.samples);
+    priv->vep_tag = vcf_parallel_strdup(priv->opts.vep_tag);
+    priv->vep_columns = vcf_parallel_strdup(priv->opts.vep_columns);
+    if ((priv->opts.samples && !priv->samples) ||
+        (priv->opts.vep_tag && !priv->vep_tag) ||
+        (priv->opts.vep_columns && !priv->vep_columns)) {
+        return ENOMEM;
+    }
+    priv->opts.samples = priv->samples;
+    priv->opts.vep_tag = priv->vep_tag;
+    priv->opts.vep_columns = priv->vep_columns;
+    priv->opts.region = NULL;
+    priv->opts.regions = NULL;
+    priv->opts.n_regions = 0;
+    priv->opts.index = NULL;
+    // Parallelism comes from the workers, not from BGZF decompression threads
+    priv->opts.threads = 0;
+
+    // Header and index, loaded once for all workers
+    priv->fp = hts_open(filename, "r");
+    if (!priv->fp) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg),
+                 "Failed to open file: %s", filename);
+        return ENOENT;
+    }
+    priv->hdr = bcf_hdr_read(priv->fp);
+    if (!priv->hdr) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg),
+                 "Failed to read VCF header");
+        return EIO;
+    }
+    if (vcf_parallel_load_index(priv, filename, opts ? opts->index : NULL) != 0) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg),
+                 "No index available for parallel conversion (file: %s)", filename);
+        return ENOENT;
+    }
+
+    if (regions) {
+        priv->regions = (char**)calloc(n_regions > 0 ? n_regions : 1, sizeof(char*));
+        if (!priv->regions) return ENOMEM;
+        for (int i = 0; i < n_regions; i++) {
+            priv->regions[i] = strdup(regions[i]);
+            if (!priv->regions[i]) return ENOMEM;
+            priv->n_regions++;
+        }
+    } else {
+        double* planned_sizes = NULL;
+        int ret = vcf_parallel_plan_regions(priv, n_threads, &planned_sizes);
+        if (ret == 0) ret = vcf_parallel_set_dispatch(priv, planned_sizes);
+        free(planned_sizes);
+        if (ret != 0) {
+            snprintf(priv->error_msg, sizeof(priv->error_msg),
+                     "Failed to plan regions from the index");
+            return ENOMEM;
+        }
+    }
+    if (regions && vcf_parallel_set_dispatch(priv, sizes) != 0) return ENOMEM;
+
+    // Workers: no more than one per region
+    priv->n_workers = n_threads < 1 ? 1 : n_threads;
+    if (priv->n_regions > 0 && priv->n_workers > priv->n_regions) {
+        priv->n_workers = priv->n_regions;
+    }
+#ifndef VCF_PARALLEL_USE_THREADS
+    priv->n_workers = 1;
+#endif
+
+    priv->workers = (vcf_parallel_worker_t*)calloc(priv->n_workers, sizeof(vcf_parallel_worker_t));
+    if (!priv->workers) return ENOMEM;
+    for (int i = 0; i < priv->n_workers; i++) {
+        vcf_parallel_worker_t* worker = &priv->workers[i];
+        worker->owner = priv;
+        // Workers copy the full header and apply the sample filter themselves
+        int ret = vcf_arrow_stream_init_shared(&worker->stream, filename, priv->hdr,
+                                               priv->idx, priv->tbx, &priv->opts);
+        if (ret != 0) {
+            const char* err = worker->stream.get_last_error(&worker->stream);
+            snprintf(priv->error_msg, sizeof(priv->error_msg),
+                     "Failed to start worker %d: %s", i, err ? err : "unknown error");
+            return ret;
+        }
+    }
+
+    // The schema header sees the same sample subset as the workers
+    if (priv->opts.samples) {
+        if (bcf_hdr_set_samples(priv->hdr, priv->opts.samples, 0) < 0) {
+            snprintf(priv->error_msg, sizeof(priv->error_msg),
+                     "Failed to set samples filter");
+            return EINVAL;
+        }
+    }
+
+#ifdef VCF_PARALLEL_USE_THREADS
+    if (priv->n_workers > 1) {
+        priv->region_done = (uint8_t*)calloc(priv->n_regions > 0 ? priv->n_regions : 1, 1);
+        priv->buffers = (vcf_parallel_buffer_t*)calloc(priv->n_regions > 0 ? priv->n_regions : 1,
+                                                       sizeof(vcf_parallel_buffer_t));
+        priv->threads = (pthread_t*)calloc(priv->n_workers, sizeof(pthread_t));
+        if (!priv->region_done || !priv->buffers || !priv->threads) return ENOMEM;
+        priv->max_buffered = VCF_PARALLEL_QUEUE_PER_WORKER * priv->n_workers;
+
+        pthread_mutex_init(&priv->lock, NULL);
+        pthread_cond_init(&priv->can_put, NULL);
+        pthread_cond_init(&priv->can_get, NULL);
+        priv->sync_init = 1;
+
+        for (int i = 0; i < priv->n_workers; i++) {
+            pthread_mutex_lock(&priv->lock);
+            priv->n_running++;
+            pthread_mutex_unlock(&priv->lock);
+            if (pthread_create(&priv->threads[i], NULL, vcf_parallel_worker_main,
+                               &priv->workers[i]) != 0) {
+                pthread_mutex_lock(&priv->lock);
+                priv->n_running--;
+                pthread_mutex_unlock(&priv->lock);
+                // Release joins the workers that did start
+                snprintf(priv->error_msg, sizeof(priv->error_msg),
+                         "Failed to start worker thread %d", i);
+                return EAGAIN;
+            }
+            priv->n_started++;
+        }
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Parallel VCF/BCF to Arrow Stream
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#ifndef VCF_ARROW_PARALLEL_H
+#define VCF_ARROW_PARALLEL_H
+
+#include "vcf_arrow_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create an Arrow stream that reads index regions on a thread pool
+ *
+ * Loads the header and index of @p filename once and starts @p n_threads
+ * workers, each a vcf_arrow_stream with its own file handle that borrows the
+ * shared index. Regions are start-owned (see vcf_arrow_stream_set_region()),
+ * so adjacent windows of one contig can be read by different workers.
+ * Workers claim the regions largest first (by @p sizes), so the longest
+ * ones do not start last, and park their batches in a reorder buffer per
+ * region; get_next() returns the batches in the order of @p regions. Regions
+ * ahead of the one being returned share a budget of two batches per worker,
+ * so a worker that runs ahead waits for the earlier regions to be consumed.
+ * Every batch holds records of a single region.
+ *
+ * A region that fails to read stops the dispatch of further regions; once
+ * the running ones have finished, get_next() returns EIO and get_last_error()
+ * names each failed region with its reason.
+ *
+ * Without thread support (WebAssembly builds) or with @p n_threads <= 1, the
+ * regions are read sequentially on the calling thread.
+ *
+ * @param stream Output stream (must be pre-allocated)
+ * @param filename Path to an indexed VCF/BCF file
+ * @param regions Regions to read, in output order, or NULL to plan them
+ *                from the index with vcf_region_plan_build() (empty contigs
+ *                skipped, large ones split, sorted by header contig order
+ *                and start, claimed by their estimated size)
+ * @param sizes Relative size of each of @p regions for the claim order, or
+ *              NULL to claim them in order
+ * @param n_regions Number of entries in @p regions
+ * @param n_threads Number of worker threads
+ * @param opts Options (region and threads are ignored)
+ * @return 0 on success, non-zero on error (see get_last_error)
+ */
+int vcf_arrow_parallel_stream_init(struct ArrowArrayStream* stream,
+                                   const char* filename,
+                                   const char** regions,
+                                   const double* sizes,
+                                   int n_regions,
+                                   int n_threads,
+                                   const vcf_arrow_options_t* opts);
+
+/**
+ * @brief Regions in the order the workers have claimed them so far
+ *
+ * @param stream Stream created by vcf_arrow_parallel_stream_init()
+ * @param out Receives the 0-based indices of the first @p n claimed regions
+ * @param n Capacity of @p out
+ * @return Number of regions claimed so far, or -1 if @p stream is not a
+ *         parallel stream
+ */
+int vcf_arrow_parallel_stream_claims(struct ArrowArrayStream* stream, int* out, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_ARROW_PARALLEL_H
@@ -7,11 +7,93 @@
 #include <Rinternals.h>
 
 #include "vcf_arrow_stream.h"
+#include "vcf_arrow_parallel.h"
+#include "vcf_arrow_writer.h"
+#include "vcf_handle.h"
 
 // Include nanoarrow R header for external pointer handling
 // This header is available when LinkingTo: nanoarrow
 #include <nanoarrow/r.h>
 
+// Defined in vcf_index_utils.c
+extern vcf_handle_t* vcf_handle_from_sexp(SEXP handle_sexp);
+
+// =============================================================================
+// Option Parsing
+// =============================================================================
+
+/**
+ * Fill stream options shared by the sequential and parallel streams.
+ * String options point into the R objects and are only valid during the call.
+ */
+static void parse_stream_options(vcf_arrow_options_t* opts,
+                                 SEXP batch_size_sexp, SEXP samples_sexp,
+                                 SEXP include_info_sexp, SEXP include_format_sexp,
+                                 SEXP index_sexp, SEXP parse_vep_sexp,
+                                 SEXP vep_tag_sexp, SEXP vep_columns_sexp,
+                                 SEXP vep_transcript_mode_sexp, SEXP variantkey_sexp) {
+    if (!Rf_isNull(batch_size_sexp)) {
+        opts->batch_size = Rf_asInteger(batch_size_sexp);
+        if (opts->batch_size <= 0) {
+            Rf_error("batch_size must be positive");
+        }
+    }
+    
+    if (!Rf_isNull(index_sexp) && TYPEOF(index_sexp) == STRSXP) {
+        opts->index = CHAR(STRING_ELT(index_sexp, 0));
+    }
+    
+    if (!Rf_isNull(samples_sexp) && TYPEOF(samples_sexp) == STRSXP) {
+        opts->samples = CHAR(STRING_ELT(samples_sexp, 0));
+    }
+    
+    if (!Rf_isNull(include_info_sexp)) {
+        opts->include_info = Rf_asLogical(include_info_sexp);
+    }
+    
+    if (!Rf_isNull(include_format_sexp)) {
+        opts->include_format = Rf_asLogical(include_format_sexp);
+    }
+    
+    // VEP parsing options
+    if (!Rf_isNull(parse_vep_sexp)) {
+        opts->parse_vep = Rf_asLogical(parse_vep_sexp);
+    }
+    
+    if (!Rf_isNull(vep_tag_sexp) && TYPEOF(vep_tag_sexp) == STRSXP) {
+        opts->vep_tag = CHAR(STRING_ELT(vep_tag_sexp, 0));
+    }
+    
+    if (!Rf_isNull(vep_columns_sexp) && TYPEOF(vep_columns_sexp) == STRSXP) {
+        opts->vep_columns = CHAR(STRING_ELT(vep_columns_sexp, 0));
+    }
+    
+    if (!Rf_isNull(vep_transcript_mode_sexp)) {
+        opts->vep_transcript_mode = Rf_asInteger(vep_transcript_mode_sexp);
+    }
+    
+    if (!Rf_isNull(variantkey_sexp)) {
+        opts->variantkey = Rf_asLogical(variantkey_sexp) == TRUE;
+    }
+}
+
+/**
+ * Resolve the input of a stream: a file name, or a vcf_handle whose file
+ * name and index path are used and whose loaded index the stream borrows.
+ * Returns the file name; *handle is NULL for plain file names.
+ */
+static const char* parse_stream_source(SEXP filename_sexp, vcf_handle_t** handle) {
+    *handle = NULL;
+    if (TYPEOF(filename_sexp) == EXTPTRSXP) {
+        *handle = vcf_handle_from_sexp(filename_sexp);
+        return (*handle)->filename;
+    }
+    if (TYPEOF(filename_sexp) != STRSXP || Rf_length(filename_sexp) != 1) {
+        Rf_error("filename must be a single character string");
+    }
+    return CHAR(STRING_ELT(filename_sexp, 0));
+}
+
 // =============================================================================
 // R-callable Functions
 // =============================================================================
@@ -19,7 +101,7 @@
 /**
  * Create a VCF to Arrow stream
  * 
- * @param filename_sexp Path to VCF/BCF file
+ * @param filename_sexp Path to VCF/BCF file, or a vcf_handle
  * @param batch_size_sexp Batch size
  * @param region_sexp Region string (or R_NilValue)
  * @param samples_sexp Sample filter string (or R_NilValue)
@@ -31,6 +113,11 @@
  * @param vep_tag_sexp VEP tag (CSQ, BCSQ, ANN) or R_NilValue for auto-detect
  * @param vep_columns_sexp Comma-separated VEP columns or R_NilValue for all
  * @param vep_transcript_mode_sexp 0=all, 1=first
+ * @param variantkey_sexp Append a VARIANTKEY column
+ * @param build_index_sexp Index the input while reading it (no region)
+ * @param regions_sexp Character vector of regions read as one batch with a
+ *        REGION_ID column (or R_NilValue)
+ * @param stats_sexp Collect counters and timers (see RC_vcf_arrow_stream_stats)
  * @return nanoarrow_array_stream external pointer
  */
 SEXP vcf_to_arrow_stream(SEXP filename_sexp, SEXP batch_size_sexp,
@@ -38,64 +125,54 @@ SEXP vcf_to_arrow_stream(SEXP filename_sexp, SEXP batch_size_sexp,
                          SEXP include_info_sexp, SEXP include_format_sexp,
                          SEXP index_sexp, SEXP threads_sexp,
                          SEXP parse_vep_sexp, SEXP vep_tag_sexp,
-                         SEXP vep_columns_sexp, SEXP vep_transcript_mode_sexp) {
+                         SEXP vep_columns_sexp, SEXP vep_transcript_mode_sexp,
+                         SEXP variantkey_sexp, SEXP build_index_sexp,
+                         SEXP regions_sexp, SEXP stats_sexp) {
     // Validate inputs
-    if (TYPEOF(filename_sexp) != STRSXP || Rf_length(filename_sexp) != 1) {
-        Rf_error("filename must be a single character string");
-    }
-    
-    const char* filename = CHAR(STRING_ELT(filename_sexp, 0));
+    vcf_handle_t* handle = NULL;
+    const char* filename = parse_stream_source(filename_sexp, &handle);
     
     // Set up options
     vcf_arrow_options_t opts;
     vcf_arrow_options_init(&opts);
-    
-    if (!Rf_isNull(batch_size_sexp)) {
-        opts.batch_size = Rf_asInteger(batch_size_sexp);
-        if (opts.batch_size <= 0) {
-            Rf_error("batch_size must be positive");
-        }
-    }
+    parse_stream_options(&opts, batch_size_sexp, samples_sexp,
+                         include_info_sexp, include_format_sexp, index_sexp,
+                         parse_vep_sexp, vep_tag_sexp, vep_columns_sexp,
+                         vep_transcript_mode_sexp, variantkey_sexp);
     
     if (!Rf_isNull(region_sexp) && TYPEOF(region_sexp) == STRSXP) {
         opts.region = CHAR(STRING_ELT(region_sexp, 0));
     }
     
-    if (!Rf_isNull(index_sexp) && TYPEOF(index_sexp) == STRSXP) {
-        opts.index = CHAR(STRING_ELT(index_sexp, 0));
-    }
-    
-    if (!Rf_isNull(samples_sexp) && TYPEOF(samples_sexp) == STRSXP) {
-        opts.samples = CHAR(STRING_ELT(samples_sexp, 0));
+    if (!Rf_isNull(regions_sexp)) {
+        if (TYPEOF(regions_sexp) != STRSXP || Rf_length(regions_sexp) == 0) {
+            Rf_error("regions must be a non-empty character vector");
+        }
+        opts.n_regions = Rf_length(regions_sexp);
+        const char** regions = (const char**)R_alloc(opts.n_regions, sizeof(char*));
+        for (int i = 0; i < opts.n_regions; i++) {
+            regions[i] = STRING_ELT(regions_sexp, i) == NA_STRING
+                ? NULL : CHAR(STRING_ELT(regions_sexp, i));
+        }
+        opts.regions = regions;
     }
     
-    if (!Rf_isNull(include_info_sexp)) {
-        opts.include_info = Rf_asLogical(include_info_sexp);
-    }
-    
-    if (!Rf_isNull(include_format_sexp)) {
-        opts.include_format = Rf_asLogical(include_format_sexp);
+    if (handle) {
+        opts.index = handle->index;
+        // Only region queries need the index
+        if (opts.region || opts.n_regions > 0) opts.handle = handle;
     }
     
     if (!Rf_isNull(threads_sexp)) {
         opts.threads = Rf_asInteger(threads_sexp);
     }
     
-    // VEP parsing options
-    if (!Rf_isNull(parse_vep_sexp)) {
-        opts.parse_vep = Rf_asLogical(parse_vep_sexp);
+    if (!Rf_isNull(build_index_sexp)) {
+        opts.build_index = Rf_asLogical(build_index_sexp) == TRUE;
     }
     
-    if (!Rf_isNull(vep_tag_sexp) && TYPEOF(vep_tag_sexp) == STRSXP) {
-        opts.vep_tag = CHAR(STRING_ELT(vep_tag_sexp, 0));
-    }
-    
-    if (!Rf_isNull(vep_columns_sexp) && TYPEOF(vep_columns_sexp) == STRSXP) {
-        opts.vep_columns = CHAR(STRING_ELT(vep_columns_sexp, 0));
-    }
-    
-    if (!Rf_isNull(vep_transcript_mode_sexp)) {
-        opts.vep_transcript_mode = Rf_asInteger(vep_transcript_mode_sexp);
+    if (!Rf_isNull(stats_sexp)) {
+        opts.collect_stats = Rf_asLogical(stats_sexp) == TRUE;
     }
     
     // Create the stream external pointer using nanoarrow's helper
@@ -120,6 +197,89 @@ SEXP vcf_to_arrow_stream(SEXP filename_sexp, SEXP batch_size_sexp,
     return stream_xptr;
 }
 
+/**
+ * Create a VCF to Arrow stream read by a pool of worker threads
+ * 
+ * @param filename_sexp Path to an indexed VCF/BCF file, or a vcf_handle
+ * @param regions_sexp Regions to read (or R_NilValue for all indexed contigs)
+ * @param sizes_sexp Relative sizes of the regions, claimed largest first
+ *        (or R_NilValue to claim them in order)
+ * @param threads_sexp Number of worker threads
+ * @param batch_size_sexp Batch size
+ * @param samples_sexp Sample filter string (or R_NilValue)
+ * @param include_info_sexp Include INFO fields
+ * @param include_format_sexp Include FORMAT fields
+ * @param index_sexp Index file path (or R_NilValue)
+ * @param parse_vep_sexp Enable VEP parsing
+ * @param vep_tag_sexp VEP tag (CSQ, BCSQ, ANN) or R_NilValue for auto-detect
+ * @param vep_columns_sexp Comma-separated VEP columns or R_NilValue for all
+ * @param vep_transcript_mode_sexp 0=all, 1=first
+ * @param variantkey_sexp Append a VARIANTKEY column
+ * @return nanoarrow_array_stream external pointer
+ */
+SEXP vcf_to_arrow_stream_parallel(SEXP filename_sexp, SEXP regions_sexp,
+                                  SEXP sizes_sexp, SEXP threads_sexp, SEXP batch_size_sexp,
+                                  SEXP samples_sexp, SEXP include_info_sexp,
+                                  SEXP include_format_sexp, SEXP index_sexp,
+                                  SEXP parse_vep_sexp, SEXP vep_tag_sexp,
+                                  SEXP vep_columns_sexp, SEXP vep_transcript_mode_sexp,
+                                  SEXP variantkey_sexp) {
+    vcf_handle_t* handle = NULL;
+    const char* filename = parse_stream_source(filename_sexp, &handle);
+    if (!Rf_isNull(regions_sexp) && TYPEOF(regions_sexp) != STRSXP) {
+        Rf_error("regions must be a character vector or NULL");
+    }
+    if (!Rf_isNull(sizes_sexp) &&
+        (TYPEOF(sizes_sexp) != REALSXP || Rf_length(sizes_sexp) != Rf_length(regions_sexp))) {
+        Rf_error("sizes must be a numeric vector with one value per region");
+    }
+    
+    int n_threads = Rf_isNull(threads_sexp) ? 1 : Rf_asInteger(threads_sexp);
+    if (n_threads == NA_INTEGER || n_threads < 1) {
+        Rf_error("threads must be a positive integer");
+    }
+    
+    vcf_arrow_options_t opts;
+    vcf_arrow_options_init(&opts);
+    parse_stream_options(&opts, batch_size_sexp, samples_sexp,
+                         include_info_sexp, include_format_sexp, index_sexp,
+                         parse_vep_sexp, vep_tag_sexp, vep_columns_sexp,
+                         vep_transcript_mode_sexp, variantkey_sexp);
+    if (handle) {
+        opts.index = handle->index;
+        opts.handle = handle;
+    }
+    
+    const char** regions = NULL;
+    int n_regions = 0;
+    if (!Rf_isNull(regions_sexp)) {
+        n_regions = Rf_length(regions_sexp);
+        regions = (const char**)R_alloc(n_regions > 0 ? n_regions : 1, sizeof(char*));
+        for (int i = 0; i < n_regions; i++) {
+            regions[i] = CHAR(STRING_ELT(regions_sexp, i));
+        }
+    }
+    
+    SEXP stream_xptr = PROTECT(nanoarrow_array_stream_owning_xptr());
+    struct ArrowArrayStream* stream = nanoarrow_output_array_stream_from_xptr(stream_xptr);
+    
+    const double* sizes = Rf_isNull(sizes_sexp) ? NULL : REAL(sizes_sexp);
+    int ret = vcf_arrow_parallel_stream_init(stream, filename, regions, sizes, n_regions,
+                                             n_threads, &opts);
+    if (ret != 0) {
+        char error_msg[1024];
+        const char* last_err = stream->get_last_error(stream);
+        snprintf(error_msg, sizeof(error_msg), "%s",
+                 last_err && last_err[0] ? last_err : "unknown error");
+        stream->release(stream);
+        UNPROTECT(1);
+        Rf_error("Failed to initialize parallel VCF stream: %s", error_msg);
+    }
+    
+    UNPROTECT(1);
+    return stream_xptr;
+}
+
 /**
  * Get schema from a VCF file
  * 
@@ -166,6 +326,63 @@ SEXP vcf_arrow_get_schema(SEXP filename_sexp) {
     return schema_xptr;
 }
 
+/**
+ * Regions claimed so far by the workers of a parallel stream
+ *
+ * @param stream_xptr nanoarrow_array_stream external pointer
+ * @return Integer vector of 1-based region indices, in claim order
+ */
+SEXP RC_vcf_arrow_parallel_claims(SEXP stream_xptr) {
+    struct ArrowArrayStream* stream = nanoarrow_array_stream_from_xptr(stream_xptr);
+    int n = vcf_arrow_parallel_stream_claims(stream, NULL, 0);
+    if (n < 0) Rf_error("stream is not a parallel stream");
+    
+    // Workers may claim more in between; only the first n are copied
+    int* claims = (int*)R_alloc(n > 0 ? n : 1, sizeof(int));
+    if (vcf_arrow_parallel_stream_claims(stream, claims, n) < n) n = 0;
+    SEXP result = PROTECT(Rf_allocVector(INTSXP, n));
+    for (int i = 0; i < n; i++) INTEGER(result)[i] = claims[i] + 1;
+    UNPROTECT(1);
+    return result;
+}
+
+/**
+ * Counters and timers of a stream opened with stats
+ *
+ * @param stream_xptr nanoarrow_array_stream external pointer
+ * @return Named list of counts and seconds (see vcf_arrow_stats_t)
+ */
+SEXP RC_vcf_arrow_stream_stats(SEXP stream_xptr) {
+    struct ArrowArrayStream* stream = nanoarrow_array_stream_from_xptr(stream_xptr);
+    vcf_arrow_stats_t st;
+    if (vcf_arrow_stream_get_stats(stream, &st) != 0) {
+        Rf_error("stream does not collect stats; open it with vcf_open_arrow(stats = TRUE)");
+    }
+    
+    const char* names[] = {
+        "batches", "records", "rows", "bgzf_bytes", "allocs",
+        "read_sec", "unpack_sec", "core_sec", "info_sec", "format_sec",
+        "vep_sec", "assembly_sec", "total_sec"
+    };
+    double values[] = {
+        (double)st.batches, (double)st.records, (double)st.rows,
+        (double)st.bgzf_bytes, (double)st.allocs,
+        st.read_sec, st.unpack_sec, st.core_sec, st.info_sec, st.format_sec,
+        st.vep_sec, st.assembly_sec, st.total_sec
+    };
+    int n = (int)(sizeof(values) / sizeof(values[0]));
+    
+    SEXP result = PROTECT(Rf_allocVector(VECSXP, n));
+    SEXP result_names = PROTECT(Rf_allocVector(STRSXP, n));
+    for (int i = 0; i < n; i++) {
+        SET_VECTOR_ELT(result, i, Rf_ScalarReal(values[i]));
+        SET_STRING_ELT(result_names, i, Rf_mkChar(names[i]));
+    }
+    Rf_setAttrib(result, R_NamesSymbol, result_names);
+    UNPROTECT(2);
+    return result;
+}
+
 /**
  * Read a single batch from VCF as Arrow array
  * 
@@ -261,3 +478,86 @@ SEXP vcf_arrow_collect_batches(SEXP stream_xptr, SEXP max_batches_sexp) {
     UNPROTECT(n_batches + 1);  // all array_xptrs + batches
     return batches;
 }
+
+/**
+ * Write an Arrow stream of VCF columns to a VCF/BCF file
+ *
+ * @param stream_xptr nanoarrow_array_stream external pointer (consumed)
+ * @param filename_sexp Output path
+ * @param header_sexp Full VCF header text
+ * @param mode_sexp "v" (VCF), "z" (BGZF VCF) or "b" (BCF)
+ * @param threads_sexp htslib compression threads
+ * @param index_sexp Build a CSI index while writing
+ * @param tidy_sexp Rows are one variant-sample each (SAMPLE_ID, FORMAT_<tag>)
+ * @param check_order_sexp Tidy only: stop if rows are not variant-major
+ * @return Number of records written, NA if check_order found unsorted rows
+ */
+SEXP arrow_stream_to_vcf(SEXP stream_xptr, SEXP filename_sexp, SEXP header_sexp,
+                         SEXP mode_sexp, SEXP threads_sexp, SEXP index_sexp,
+                         SEXP tidy_sexp, SEXP check_order_sexp) {
+    if (TYPEOF(filename_sexp) != STRSXP || Rf_length(filename_sexp) != 1) {
+        Rf_error("filename must be a single character string");
+    }
+    if (TYPEOF(header_sexp) != STRSXP || Rf_length(header_sexp) != 1) {
+        Rf_error("header must be a single character string");
+    }
+    if (TYPEOF(mode_sexp) != STRSXP || Rf_length(mode_sexp) != 1) {
+        Rf_error("mode must be a single character string");
+    }
+    
+    struct ArrowArrayStream* stream = nanoarrow_array_stream_from_xptr(stream_xptr);
+    
+    vcf_arrow_writer_options_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.mode = CHAR(STRING_ELT(mode_sexp, 0))[0];
+    opts.threads = Rf_isNull(threads_sexp) ? 0 : Rf_asInteger(threads_sexp);
+    if (opts.threads == NA_INTEGER) opts.threads = 0;
+    opts.write_index = Rf_asLogical(index_sexp) == TRUE;
+    opts.tidy = Rf_asLogical(tidy_sexp) == TRUE;
+    opts.check_order = Rf_asLogical(check_order_sexp) == TRUE;
+    
+    char error_msg[1024];
+    int64_t n_written = 0;
+    int ret = vcf_arrow_write_stream(stream,
+                                     CHAR(STRING_ELT(header_sexp, 0)),
+                                     CHAR(STRING_ELT(filename_sexp, 0)),
+                                     &opts, &n_written,
+                                     error_msg, sizeof(error_msg));
+    // Unsorted tidy input: NA tells the caller to sort and write again
+    if (ret == VCF_ARROW_WRITER_UNORDERED) {
+        return Rf_ScalarReal(NA_REAL);
+    }
+    if (ret != 0) {
+        Rf_error("%s", error_msg);
+    }
+    
+    return Rf_ScalarReal((double)n_written);
+}
+
+/**
+ * Check that tidy Arrow rows are variant-major, without writing anything
+ *
+ * Stops at the first row out of order.
+ *
+ * @param stream_xptr nanoarrow_array_stream external pointer (consumed)
+ * @param header_sexp Full VCF header text
+ * @return TRUE when the rows can be pivoted in a single pass
+ */
+SEXP arrow_stream_tidy_in_order(SEXP stream_xptr, SEXP header_sexp) {
+    if (TYPEOF(header_sexp) != STRSXP || Rf_length(header_sexp) != 1) {
+        Rf_error("header must be a single character string");
+    }
+    struct ArrowArrayStream* stream = nanoarrow_array_stream_from_xptr(stream_xptr);
+
+    vcf_arrow_writer_options_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.tidy = 1;
+    opts.check_order = 1;
+
+    char error_msg[1024];
+    int ret = vcf_arrow_write_stream(stream, CHAR(STRING_ELT(header_sexp, 0)), NULL,
+                                     &opts, NULL, error_msg, sizeof(error_msg));
+    if (ret == VCF_ARROW_WRITER_UNORDERED) return Rf_ScalarLogical(FALSE);
+    if (ret != 0) Rf_error("%s", error_msg);
+    return Rf_ScalarLogical(TRUE);
+}
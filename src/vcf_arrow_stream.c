@@ -4,9 +4,15 @@
 
 #include "vcf_arrow_stream.h"
 #include "vep_parser.h"
+#include "vcf_variantkey.h"
+#include "vcf_index_build.h"
+#include "vcf_region_batch.h"
+#include "htslib/bgzf.h"
+#include "htslib/hfile.h"
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 #include <R.h>  // For Rf_warning()
 
 // =============================================================================
@@ -38,11 +44,19 @@
 // Memory Management Helpers
 // =============================================================================
 
+// Allocations made through the helpers on this thread while a stream that
+// collects stats is filling a batch; get_next() adds its share to the
+// stream's stats
+static __thread int vcf_arrow_count_allocs;
+static __thread uint64_t vcf_arrow_n_allocs;
+
 static void* vcf_arrow_malloc(size_t size) {
+    if (vcf_arrow_count_allocs) vcf_arrow_n_allocs++;
     return malloc(size);
 }
 
 static void* vcf_arrow_realloc(void* ptr, size_t size) {
+    if (vcf_arrow_count_allocs) vcf_arrow_n_allocs++;
     return realloc(ptr, size);
 }
 
@@ -474,6 +488,8 @@ static int vcf_arrow_schema_from_header_internal(const bcf_hdr_t* hdr,
     int64_t n_children = n_core + n_vep;  // Core fields + VEP columns
     if (n_info > 0) n_children++;  // INFO struct
     if (include_samples) n_children++;  // samples struct
+    if (opts && opts->variantkey) n_children++;  // VARIANTKEY
+    if (opts && opts->n_regions > 0) n_children++;  // REGION_ID (last)
     
     RETURN_IF_ERROR(init_schema_struct(schema, "", n_children));
     
@@ -672,6 +688,18 @@ static int vcf_arrow_schema_from_header_internal(const bcf_hdr_t* hdr,
         idx++;
     }
     
+    // VARIANTKEY - uint64 (appended last so existing child indices are unchanged)
+    if (opts && opts->variantkey) {
+        RETURN_IF_ERROR(init_schema_field(schema->children[idx++],
+                                          ARROW_FORMAT_UINT64, "VARIANTKEY", 0));
+    }
+    
+    // REGION_ID - int32, 1-based position in opts.regions
+    if (opts && opts->n_regions > 0) {
+        RETURN_IF_ERROR(init_schema_field(schema->children[idx++],
+                                          ARROW_FORMAT_INT32, "REGION_ID", 0));
+    }
+    
     return 0;
 }
 
@@ -747,9 +775,62 @@ static int vcf_stream_get_schema(struct ArrowArrayStream* stream, struct ArrowSc
                                                   priv->n_vep_columns);
 }
 
+// =============================================================================
+// Stream Stats
+// =============================================================================
+
+static double vcf_stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Input position: compressed offset for BGZF, raw offset otherwise
+static int64_t vcf_stats_offset(htsFile* fp) {
+    if (fp->is_bgzf) return (int64_t)(bgzf_tell(fp->fp.bgzf) >> 16);
+    if (fp->format.compression == no_compression) return (int64_t)htell(fp->fp.hfile);
+    return (int64_t)htell(fp->fp.bgzf->fp);
+}
+
+// Charge the time since *t to a stats field and restart the clock
+#define VCF_STATS_LAP(priv, field, t) do { \
+    if ((priv)->opts.collect_stats) { \
+        double now_ = vcf_stats_now(); \
+        (priv)->stats.field += now_ - (t); \
+        (t) = now_; \
+    } \
+} while (0)
+
+static int vcf_stream_fill_batch(vcf_arrow_private_t* priv, struct ArrowArray* out);
+
 static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArray* out) {
     vcf_arrow_private_t* priv = (vcf_arrow_private_t*)stream->private_data;
-    
+    if (!priv->opts.collect_stats) return vcf_stream_fill_batch(priv, out);
+    
+    int count_allocs = vcf_arrow_count_allocs;
+    uint64_t allocs = vcf_arrow_n_allocs;
+    double t0 = vcf_stats_now();
+    vcf_arrow_count_allocs = 1;
+    int ret = vcf_stream_fill_batch(priv, out);
+    vcf_arrow_count_allocs = count_allocs;
+    priv->stats.total_sec += vcf_stats_now() - t0;
+    priv->stats.allocs += (int64_t)(vcf_arrow_n_allocs - allocs);
+    if (ret == 0 && out->release) {
+        priv->stats.batches++;
+        priv->stats.rows += out->length;
+    }
+    return ret;
+}
+
+int vcf_arrow_stream_get_stats(struct ArrowArrayStream* stream, vcf_arrow_stats_t* out) {
+    if (!stream || !stream->release || stream->get_next != &vcf_stream_get_next) return -1;
+    vcf_arrow_private_t* priv = (vcf_arrow_private_t*)stream->private_data;
+    if (!priv || !priv->opts.collect_stats) return -1;
+    *out = priv->stats;
+    return 0;
+}
+
+static int vcf_stream_fill_batch(vcf_arrow_private_t* priv, struct ArrowArray* out) {
     if (priv->finished) {
         // Signal end of stream
         memset(out, 0, sizeof(*out));
@@ -764,6 +845,10 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
     // Allocate temporary storage for this batch
     char** chrom_data = (char**)vcf_arrow_malloc(batch_size * sizeof(char*));
     int64_t* pos_data = (int64_t*)vcf_arrow_malloc(batch_size * sizeof(int64_t));
+    uint64_t* vk_data = priv->opts.variantkey ?
+        (uint64_t*)vcf_arrow_malloc(batch_size * sizeof(uint64_t)) : NULL;
+    int32_t* region_id_data = priv->region_batch ?
+        (int32_t*)vcf_arrow_malloc(batch_size * sizeof(int32_t)) : NULL;
     char** id_data = (char**)vcf_arrow_malloc(batch_size * sizeof(char*));
     char** ref_data = (char**)vcf_arrow_malloc(batch_size * sizeof(char*));
     double* qual_data = (double*)vcf_arrow_malloc(batch_size * sizeof(double));
@@ -971,11 +1056,14 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
         }
     }
     
-    if (!chrom_data || !pos_data || !id_data || !ref_data || !qual_data || !qual_validity ||
+    if (!chrom_data || !pos_data || (priv->opts.variantkey && !vk_data) ||
+        (priv->region_batch && !region_id_data) || !id_data || !ref_data || !qual_data || !qual_validity ||
         !alt_list_offsets || !alt_data || !alt_counts ||
         !filter_list_offsets || !filter_data || !filter_counts) {
         vcf_arrow_free(chrom_data);
         vcf_arrow_free(pos_data);
+        vcf_arrow_free(vk_data);
+        vcf_arrow_free(region_id_data);
         vcf_arrow_free(id_data);
         vcf_arrow_free(ref_data);
         vcf_arrow_free(qual_data);
@@ -1177,8 +1265,14 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
     
     // Read records
     int ret;
+    double t = priv->opts.collect_stats ? vcf_stats_now() : 0;
     while (n_read < batch_size) {
-        if (priv->itr) {
+        int64_t offset = priv->opts.collect_stats ? vcf_stats_offset(priv->fp) : 0;
+        if (priv->region_hit < priv->region_n_hits) {
+            // The current record again, for the next region it overlaps
+            ret = 0;
+            offset = -1;
+        } else if (priv->itr) {
             if (priv->tbx) {
                 // VCF with tabix: read text line then parse
                 ret = tbx_itr_next(priv->fp, priv->tbx, priv->itr, &priv->kstr);
@@ -1192,12 +1286,24 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
             }
         } else {
             ret = bcf_read(priv->fp, priv->hdr, priv->rec);
+            if (ret >= 0 && priv->index_builder) {
+                vcf_index_builder_push(priv->index_builder, priv->rec);
+            }
         }
         
         if (ret < 0) {
             if (ret == -1) {
                 // End of file
                 priv->finished = 1;
+                if (priv->index_builder) {
+                    // The index was asked for: an unsorted input or an
+                    // unwritable directory fails the stream so R reports it
+                    int saved = vcf_index_builder_save(priv->index_builder, priv->error_msg,
+                                                       sizeof(priv->error_msg));
+                    vcf_index_builder_destroy(priv->index_builder);
+                    priv->index_builder = NULL;
+                    if (saved < 0) goto cleanup_error;
+                }
                 break;
             }
             // Error
@@ -1205,8 +1311,34 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
             goto cleanup_error;
         }
         
+        if (priv->opts.collect_stats && offset >= 0) {
+            int64_t end = vcf_stats_offset(priv->fp);
+            // Iterators seek between chunks; only forward progress is input
+            if (end > offset) priv->stats.bgzf_bytes += end - offset;
+            priv->stats.records++;
+        }
+        VCF_STATS_LAP(priv, read_sec, t);
+        
+        // Owned by the preceding window (see vcf_arrow_stream_set_region)
+        if (priv->rec->pos < priv->region_beg) {
+            continue;
+        }
+        
+        // One row per overlapping region; merged chunks can also return
+        // records that fall between the regions
+        if (priv->region_batch) {
+            if (priv->region_hit >= priv->region_n_hits) {
+                priv->region_n_hits = vcf_region_batch_match(priv->region_batch, priv->rec);
+                priv->region_hit = 0;
+                if (priv->region_n_hits == 0) continue;
+            }
+            region_id_data[n_read] = vcf_region_batch_hit(priv->region_batch,
+                                                          priv->region_hit++);
+        }
+        
         // Unpack the record
         bcf_unpack(priv->rec, BCF_UN_ALL);
+        VCF_STATS_LAP(priv, unpack_sec, t);
         
         // CHROM
         chrom_data[n_read] = vcf_arrow_strdup(bcf_hdr_id2name(priv->hdr, priv->rec->rid));
@@ -1214,6 +1346,11 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
         // POS (convert to 1-based)
         pos_data[n_read] = priv->rec->pos + 1;
         
+        // VARIANTKEY
+        if (vk_data) {
+            vk_data[n_read] = vcf_variantkey(priv->hdr, priv->rec);
+        }
+        
         // ID
         id_data[n_read] = vcf_arrow_strdup(priv->rec->d.id);
         
@@ -1256,6 +1393,7 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
             filter_data[n_read] = NULL;
         }
         filter_list_offsets[n_read + 1] = filter_list_offsets[n_read] + n_flt;
+        VCF_STATS_LAP(priv, core_sec, t);
         
         // Extract INFO fields for this record
         if (priv->opts.include_info && n_info_fields > 0) {
@@ -1446,6 +1584,8 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
             }
         }
         
+        VCF_STATS_LAP(priv, info_sec, t);
+        
         // Extract FORMAT data for all samples
         if (priv->opts.include_format && n_samples > 0) {
             for (int f = 0; f < n_fmt_fields; f++) {
@@ -1713,6 +1853,8 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
             }
         }
         
+        VCF_STATS_LAP(priv, format_sec, t);
+        
         // =====================================================================
         // Extract VEP annotation data for this record
         // =====================================================================
@@ -1913,6 +2055,7 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
                 vep_record_destroy(vep_rec);
             }
         }
+        VCF_STATS_LAP(priv, vep_sec, t);
         
         n_read++;
     }
@@ -1925,6 +2068,8 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
         
         vcf_arrow_free(chrom_data);
         vcf_arrow_free(pos_data);
+        vcf_arrow_free(vk_data);
+        vcf_arrow_free(region_id_data);
         vcf_arrow_free(id_data);
         vcf_arrow_free(ref_data);
         vcf_arrow_free(qual_data);
@@ -2002,9 +2147,11 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
     int64_t n_children = n_core + n_vep;  // Core fields + VEP columns
     if (n_info_fields > 0) n_children++;  // INFO struct
     if (include_samples) n_children++;  // samples struct
+    if (vk_data) n_children++;  // VARIANTKEY
+    if (region_id_data) n_children++;  // REGION_ID (last)
     
     // Build the output array
-    // CHROM(0), POS(1), ID(2), REF(3), ALT(4), QUAL(5), FILTER(6), [INFO(7)], [samples(8)]
+    // CHROM(0), POS(1), ID(2), REF(3), ALT(4), QUAL(5), FILTER(6), [INFO(7)], [samples(8)], [VARIANTKEY], [REGION_ID]
     
     out->length = n_read;
     out->null_count = 0;
@@ -3059,7 +3206,36 @@ static int vcf_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArra
     vcf_arrow_free(fmt_list_sizes);
     vcf_arrow_free(fmt_list_capacity);
     
+    // =========================================================================
+    // Trailing children: VARIANTKEY (uint64), REGION_ID (int32)
+    // =========================================================================
+    if (vk_data) {
+        struct ArrowArray* arr = out->children[n_children - 1 - (region_id_data ? 1 : 0)];
+        arr->length = n_read;
+        arr->null_count = 0;
+        arr->offset = 0;
+        arr->n_buffers = 2;
+        arr->n_children = 0;
+        
+        arr->buffers = (const void**)vcf_arrow_malloc(2 * sizeof(void*));
+        arr->buffers[0] = NULL;  // validity
+        arr->buffers[1] = vk_data;  // transfer ownership
+    }
+    if (region_id_data) {
+        struct ArrowArray* arr = out->children[n_children - 1];
+        arr->length = n_read;
+        arr->null_count = 0;
+        arr->offset = 0;
+        arr->n_buffers = 2;
+        arr->n_children = 0;
+        
+        arr->buffers = (const void**)vcf_arrow_malloc(2 * sizeof(void*));
+        arr->buffers[0] = NULL;  // validity
+        arr->buffers[1] = region_id_data;  // transfer ownership
+    }
+    
     out->dictionary = NULL;
+    VCF_STATS_LAP(priv, assembly_sec, t);
     
     return 0;
 
@@ -3079,6 +3255,8 @@ cleanup_error:
     }
     vcf_arrow_free(chrom_data);
     vcf_arrow_free(pos_data);
+    vcf_arrow_free(vk_data);
+    vcf_arrow_free(region_id_data);
     vcf_arrow_free(id_data);
     vcf_arrow_free(ref_data);
     vcf_arrow_free(qual_data);
@@ -3142,6 +3320,15 @@ cleanup_error:
     return EIO;
 }
 
+// Iterator over opts.region, or over the union of the region batch
+static hts_itr_t* vcf_stream_query(vcf_arrow_private_t* priv) {
+    if (priv->region_batch) {
+        return vcf_region_batch_itr(priv->region_batch, priv->idx, priv->tbx, priv->hdr);
+    }
+    return priv->tbx ? tbx_itr_querys(priv->tbx, priv->opts.region)
+                     : bcf_itr_querys(priv->idx, priv->hdr, priv->opts.region);
+}
+
 static const char* vcf_stream_get_last_error(struct ArrowArrayStream* stream) {
     vcf_arrow_private_t* priv = (vcf_arrow_private_t*)stream->private_data;
     return priv->error_msg[0] ? priv->error_msg : NULL;
@@ -3153,8 +3340,14 @@ static void vcf_stream_release(struct ArrowArrayStream* stream) {
         
         if (priv->rec) bcf_destroy(priv->rec);
         if (priv->itr) hts_itr_destroy(priv->itr);
+        // Released before EOF: the index would be incomplete, so none is written
+        vcf_index_builder_destroy(priv->index_builder);
+        vcf_region_batch_destroy(priv->region_batch);
         // Free index: tbx_destroy handles its own idx, otherwise free idx directly
-        if (priv->tbx) {
+        if (priv->borrowed_index) {
+            // Owned by the stream that loaded it, or by the handle
+            vcf_handle_close(priv->handle);
+        } else if (priv->tbx) {
             tbx_destroy(priv->tbx);
         } else if (priv->idx) {
             hts_idx_destroy(priv->idx);
@@ -3186,6 +3379,27 @@ static void vcf_stream_release(struct ArrowArrayStream* stream) {
 // Public API Implementation
 // =============================================================================
 
+// Parse the VEP/BCSQ/ANN schema and column selection, if enabled
+static void vcf_stream_setup_vep(vcf_arrow_private_t* priv) {
+    if (!priv->opts.parse_vep) return;
+    
+    priv->vep_schema = vep_schema_parse(priv->hdr, priv->opts.vep_tag);
+    if (priv->vep_schema) {
+        // Parse column selection if provided
+        if (priv->opts.vep_columns && *priv->opts.vep_columns) {
+            priv->vep_field_indices = parse_vep_column_selection(priv->vep_schema, priv->opts.vep_columns);
+            if (priv->vep_field_indices) {
+                // Count selected columns
+                for (int i = 0; priv->vep_field_indices[i] >= 0; i++) {
+                    priv->n_vep_columns++;
+                }
+            }
+        } else {
+            priv->n_vep_columns = priv->vep_schema->n_fields;
+        }
+    }
+}
+
 void vcf_arrow_options_init(vcf_arrow_options_t* opts) {
     memset(opts, 0, sizeof(*opts));
     opts->batch_size = VCF_ARROW_DEFAULT_BATCH_SIZE;
@@ -3199,6 +3413,12 @@ void vcf_arrow_options_init(vcf_arrow_options_t* opts) {
     opts->vep_tag = NULL;
     opts->vep_columns = NULL;
     opts->vep_transcript_mode = VEP_TRANSCRIPT_FIRST;
+    opts->variantkey = 0;
+    opts->build_index = 0;
+    opts->handle = NULL;
+    opts->regions = NULL;
+    opts->n_regions = 0;
+    opts->collect_stats = 0;
 }
 
 int vcf_arrow_stream_init(struct ArrowArrayStream* stream,
@@ -3261,40 +3481,76 @@ int vcf_arrow_stream_init(struct ArrowArrayStream* stream,
         }
     }
     
+    if (priv->opts.region && priv->opts.n_regions > 0) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg),
+                 "region and regions are mutually exclusive");
+        return EINVAL;
+    }
+    
+    // Region batch: parsed now, the caller's strings are not kept
+    if (priv->opts.n_regions > 0) {
+        priv->region_batch = vcf_region_batch_init(priv->hdr, priv->opts.regions,
+                                                   priv->opts.n_regions, priv->error_msg,
+                                                   sizeof(priv->error_msg));
+        if (!priv->region_batch) return EINVAL;
+    }
+    priv->opts.regions = NULL;
+    
     // Set up region filtering if requested
-    if (priv->opts.region) {
+    if (priv->opts.region || priv->region_batch) {
         // Load the index
         // HTS_IDX_SAVE_REMOTE enables remote index caching for S3/HTTP URLs
-        if (priv->fp->format.format == vcf) {
+        if (priv->opts.handle && vcf_handle_index(priv->opts.handle)) {
+            // Borrowed from the handle, which stays open while we hold it
+            priv->handle = priv->opts.handle;
+            vcf_handle_ref(priv->handle);
+            priv->idx = priv->handle->idx;
+            priv->tbx = priv->handle->tbx;
+            priv->borrowed_index = 1;
+            priv->itr = vcf_stream_query(priv);
+        } else if (priv->fp->format.format == vcf) {
             // VCF files can have either TBI (.tbi) or CSI (.csi) index
             // Try TBI first (more common), then fall back to CSI
             priv->tbx = tbx_index_load3(filename, priv->opts.index, HTS_IDX_SAVE_REMOTE | HTS_IDX_SILENT_FAIL);
             if (priv->tbx) {
                 priv->idx = priv->tbx->idx;
-                // Use tbx_itr_querys for VCF files with TBI (reads text lines)
-                priv->itr = tbx_itr_querys(priv->tbx, priv->opts.region);
+                // Tabix iterators read text lines
+                priv->itr = vcf_stream_query(priv);
             } else {
                 // TBI not found, try CSI index
                 priv->idx = bcf_index_load3(filename, priv->opts.index, HTS_IDX_SAVE_REMOTE | HTS_IDX_SILENT_FAIL);
                 if (priv->idx) {
-                    // Use bcf_itr_querys for VCF files with CSI index
-                    priv->itr = bcf_itr_querys(priv->idx, priv->hdr, priv->opts.region);
+                    priv->itr = vcf_stream_query(priv);
                 }
             }
         } else {
             // BCF files use CSI index only
             priv->idx = bcf_index_load3(filename, priv->opts.index, HTS_IDX_SAVE_REMOTE | HTS_IDX_SILENT_FAIL);
             if (priv->idx) {
-                // Use bcf_itr_querys for BCF files (reads binary records)
-                priv->itr = bcf_itr_querys(priv->idx, priv->hdr, priv->opts.region);
+                // BCF iterators read binary records
+                priv->itr = vcf_stream_query(priv);
             }
         }
         
         if (!priv->itr) {
-            snprintf(priv->error_msg, sizeof(priv->error_msg), 
-                     priv->idx ? "Failed to query region: %s" : "No index available for region query (file: %s)",
-                     priv->idx ? priv->opts.region : filename);
-            if (priv->tbx) {
+            if (!priv->idx) {
+                snprintf(priv->error_msg, sizeof(priv->error_msg),
+                         "No index available for region query (file: %s)", filename);
+            } else if (priv->region_batch) {
+                snprintf(priv->error_msg, sizeof(priv->error_msg),
+                         "Failed to query %d regions", priv->opts.n_regions);
+            } else {
+                snprintf(priv->error_msg, sizeof(priv->error_msg),
+                         "Failed to query region: %s", priv->opts.region);
+            }
+            if (priv->region_batch) {
+                // Leave the cleanup to release(), so the message stays readable
+                return priv->idx ? EINVAL : ENOENT;
+            }
+            int ret = priv->idx ? EINVAL : ENOENT;
+            if (priv->borrowed_index) {
+                vcf_handle_close(priv->handle);
+            } else if (priv->tbx) {
                 tbx_destroy(priv->tbx);
                 priv->tbx = NULL;
             } else if (priv->idx) {
@@ -3304,7 +3560,7 @@ int vcf_arrow_stream_init(struct ArrowArrayStream* stream,
             bcf_hdr_destroy(priv->hdr);
             hts_close(priv->fp);
             vcf_arrow_free(priv);
-            return priv->idx ? EINVAL : ENOENT;
+            return ret;
         }
     }
     
@@ -3314,32 +3570,131 @@ int vcf_arrow_stream_init(struct ArrowArrayStream* stream,
         snprintf(priv->error_msg, sizeof(priv->error_msg), 
                  "Failed to allocate BCF record");
         if (priv->itr) hts_itr_destroy(priv->itr);
-        if (priv->idx) hts_idx_destroy(priv->idx);
+        if (priv->borrowed_index) vcf_handle_close(priv->handle);
+        else if (priv->idx) hts_idx_destroy(priv->idx);
         bcf_hdr_destroy(priv->hdr);
         hts_close(priv->fp);
         vcf_arrow_free(priv);
         return ENOMEM;
     }
     
-    // Parse VEP schema if enabled
-    if (priv->opts.parse_vep) {
-        priv->vep_schema = vep_schema_parse(priv->hdr, priv->opts.vep_tag);
-        if (priv->vep_schema) {
-            // Parse column selection if provided
-            if (priv->opts.vep_columns && *priv->opts.vep_columns) {
-                priv->vep_field_indices = parse_vep_column_selection(priv->vep_schema, priv->opts.vep_columns);
-                if (priv->vep_field_indices) {
-                    // Count selected columns
-                    for (int i = 0; priv->vep_field_indices[i] >= 0; i++) {
-                        priv->n_vep_columns++;
-                    }
-                }
-            } else {
-                priv->n_vep_columns = priv->vep_schema->n_fields;
-            }
+    // Index on the fly; region reads never see the whole file
+    if (priv->opts.build_index && !priv->itr) {
+        priv->index_builder = vcf_index_builder_init(priv->fp, priv->hdr, filename,
+                                                     priv->opts.index, priv->error_msg,
+                                                     sizeof(priv->error_msg));
+        if (!priv->index_builder) {
+            // Left to vcf_stream_release() so the error message stays readable
+            return EINVAL;
         }
     }
     
+    vcf_stream_setup_vep(priv);
+    
+    return 0;
+}
+
+int vcf_arrow_stream_init_shared(struct ArrowArrayStream* stream,
+                                 const char* filename,
+                                 const bcf_hdr_t* hdr,
+                                 hts_idx_t* idx,
+                                 tbx_t* tbx,
+                                 const vcf_arrow_options_t* opts) {
+    vcf_arrow_private_t* priv = (vcf_arrow_private_t*)vcf_arrow_malloc(sizeof(vcf_arrow_private_t));
+    if (!priv) {
+        return ENOMEM;
+    }
+    memset(priv, 0, sizeof(*priv));
+    
+    stream->get_schema = &vcf_stream_get_schema;
+    stream->get_next = &vcf_stream_get_next;
+    stream->get_last_error = &vcf_stream_get_last_error;
+    stream->release = &vcf_stream_release;
+    stream->private_data = priv;
+    
+    if (opts) {
+        priv->opts = *opts;
+    } else {
+        vcf_arrow_options_init(&priv->opts);
+    }
+    priv->opts.region = NULL;
+    priv->opts.regions = NULL;
+    priv->opts.n_regions = 0;
+    
+    // Nothing to read until a region is set
+    priv->finished = 1;
+    priv->idx = idx;
+    priv->tbx = tbx;
+    priv->borrowed_index = 1;
+    
+    priv->fp = hts_open(filename, "r");
+    if (!priv->fp) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg),
+                 "Failed to open file: %s", filename);
+        return ENOENT;
+    }
+    if (priv->opts.threads > 0) {
+        hts_set_threads(priv->fp, priv->opts.threads);
+    }
+    
+    // vcf_parse1() may add undeclared contigs/tags to the header, so every
+    // stream parses against its own copy
+    priv->hdr = bcf_hdr_dup(hdr);
+    if (!priv->hdr) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg),
+                 "Failed to duplicate VCF header");
+        return ENOMEM;
+    }
+    if (priv->opts.samples) {
+        if (bcf_hdr_set_samples(priv->hdr, priv->opts.samples, 0) < 0) {
+            snprintf(priv->error_msg, sizeof(priv->error_msg),
+                     "Failed to set samples filter");
+            return EINVAL;
+        }
+    }
+    
+    priv->rec = bcf_init();
+    if (!priv->rec) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg),
+                 "Failed to allocate BCF record");
+        return ENOMEM;
+    }
+    
+    vcf_stream_setup_vep(priv);
+    
+    return 0;
+}
+
+int vcf_arrow_stream_set_region(struct ArrowArrayStream* stream,
+                                const char* region) {
+    vcf_arrow_private_t* priv = (vcf_arrow_private_t*)stream->private_data;
+    
+    if (!priv->idx) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg),
+                 "No index available for region query");
+        return ENOENT;
+    }
+    
+    if (priv->itr) {
+        hts_itr_destroy(priv->itr);
+        priv->itr = NULL;
+    }
+    priv->kstr.l = 0;
+    
+    if (priv->tbx) {
+        priv->itr = tbx_itr_querys(priv->tbx, region);
+    } else {
+        priv->itr = bcf_itr_querys(priv->idx, priv->hdr, region);
+    }
+    if (!priv->itr) {
+        snprintf(priv->error_msg, sizeof(priv->error_msg),
+                 "Failed to query region: %s", region);
+        priv->finished = 1;
+        return EINVAL;
+    }
+    
+    priv->region_beg = priv->itr->beg;
+    priv->finished = 0;
     return 0;
 }
 
@@ -10,8 +10,13 @@
 #include "htslib/synced_bcf_reader.h"
 #include "htslib/tbx.h"
 #include "htslib/kstring.h"
+#include "vcf_handle.h"
 // Forward declaration for VEP schema (defined in vep_parser.h)
 typedef struct vep_schema_t vep_schema_t;
+// Forward declaration for the on-the-fly indexer (defined in vcf_index_build.h)
+typedef struct vcf_index_builder_t vcf_index_builder_t;
+// Forward declaration for region batches (defined in vcf_region_batch.h)
+typedef struct vcf_region_batch_t vcf_region_batch_t;
 
 // Arrow C Data Interface structures
 // (These are also defined in nanoarrow/r.h but we define them here for standalone use)
@@ -94,6 +99,8 @@ typedef struct {
     int include_info;             // Include INFO fields (default: 1)
     int include_format;           // Include FORMAT/sample fields (default: 1)
     const char* region;           // Region filter (e.g., "chr1:1000-2000")
+    const char* const* regions;   // Region batch read through one iterator, with
+    int n_regions;                // a REGION_ID column (exclusive with region)
     const char* samples;          // Sample filter (comma-separated or file)
     const char* index;            // Index file path (NULL for auto-detection)
                                   // VCF: tries .tbi first, then .csi
@@ -105,8 +112,41 @@ typedef struct {
     const char* vep_tag;          // Annotation tag (NULL = auto-detect CSQ/BCSQ/ANN)
     const char* vep_columns;      // Comma-separated columns to extract (NULL = all)
     int vep_transcript_mode;      // VEP_TRANSCRIPT_ALL or VEP_TRANSCRIPT_FIRST
+    
+    // Computed columns
+    int variantkey;               // Append a VARIANTKEY uint64 column (default: 0)
+    
+    // Index the input while reading it (whole-file reads of BGZF input only);
+    // written at EOF to opts.index, or next to the file when NULL
+    int build_index;
+    
+    // Open handle whose index is borrowed for region queries instead of
+    // loading it again (NULL = load from the file). The stream holds a
+    // reference until it is released.
+    vcf_handle_t* handle;
+    
+    // Collect vcf_arrow_stats_t counters and timers (default: 0)
+    int collect_stats;
 } vcf_arrow_options_t;
 
+// Hot-path counters and timers, collected when opts.collect_stats is set.
+// Times are wall-clock seconds summed over get_next() calls.
+typedef struct {
+    int64_t batches;              // Non-empty batches returned
+    int64_t records;              // Records read from the file
+    int64_t rows;                 // Rows returned (records repeated per region batch hit)
+    int64_t bgzf_bytes;           // Compressed input consumed (raw bytes for plain text)
+    int64_t allocs;               // Allocations made by the stream for its buffers
+    double read_sec;              // bcf_read / bcf_itr_next / tbx_itr_next + vcf_parse1
+    double unpack_sec;            // bcf_unpack
+    double core_sec;              // CHROM, POS, ID, REF, ALT, QUAL, FILTER
+    double info_sec;              // INFO decode
+    double format_sec;            // FORMAT decode
+    double vep_sec;               // VEP/BCSQ/ANN parse
+    double assembly_sec;          // Arrow array assembly
+    double total_sec;             // Everything inside get_next()
+} vcf_arrow_stats_t;
+
 // Private data for the VCF stream
 typedef struct {
     htsFile* fp;                  // VCF/BCF file handle
@@ -115,10 +155,18 @@ typedef struct {
     hts_idx_t* idx;               // Index (for region queries)
     tbx_t* tbx;                   // Tabix index (for VCF files)
     hts_itr_t* itr;               // Iterator (for region queries)
+    int borrowed_index;           // idx/tbx are owned by another stream
+    vcf_handle_t* handle;         // Reference held on opts.handle (owns idx/tbx)
+    hts_pos_t region_beg;         // Skip records starting before this (set_region)
+    vcf_region_batch_t* region_batch; // opts.regions, matched per record
+    int region_hit;               // Next match of the current record to emit
+    int region_n_hits;            // Matches of the current record
     kstring_t kstr;               // String buffer for tbx_itr_next (VCF text parsing)
+    vcf_index_builder_t* index_builder; // Index built during the read (build_index)
     vcf_arrow_options_t opts;     // Options
     char error_msg[256];          // Last error message
     int finished;                 // Stream finished flag
+    vcf_arrow_stats_t stats;      // Filled when opts.collect_stats is set
     
     // Schema cache
     struct ArrowSchema* cached_schema;
@@ -220,6 +268,16 @@ int vcf_arrow_stream_init(struct ArrowArrayStream* stream,
                           const char* filename,
                           const vcf_arrow_options_t* opts);
 
+/**
+ * @brief Read the counters of a stream opened with opts.collect_stats
+ *
+ * @param stream Stream created by vcf_arrow_stream_init() and not yet released
+ * @param out Output counters
+ * @return 0 on success, -1 if @p stream is not a VCF stream, has been
+ *         released, or does not collect stats
+ */
+int vcf_arrow_stream_get_stats(struct ArrowArrayStream* stream, vcf_arrow_stats_t* out);
+
 /**
  * @brief Get the VCF schema as an Arrow schema
  * 
@@ -257,6 +315,47 @@ int vcf_arrow_read_batch(htsFile* fp,
                          struct ArrowArray* array,
                          const vcf_arrow_options_t* opts);
 
+/**
+ * @brief Create a VCF/BCF stream that borrows an already loaded index
+ *
+ * Opens its own file handle and works on a private copy of @p hdr, but
+ * shares @p idx / @p tbx with the caller, which must keep them alive until
+ * the stream is released. The stream yields nothing until a region is set
+ * with vcf_arrow_stream_set_region(). Used by the parallel converter so that
+ * worker streams never re-read the header or the index.
+ *
+ * @param stream Output stream (must be pre-allocated)
+ * @param filename Path to VCF/BCF file
+ * @param hdr Header read from @p filename (duplicated, not retained)
+ * @param idx Loaded CSI/TBI index
+ * @param tbx Tabix wrapper around @p idx, or NULL for CSI
+ * @param opts Options (region is ignored)
+ * @return 0 on success, non-zero on error. The stream must be released
+ *         in either case.
+ */
+int vcf_arrow_stream_init_shared(struct ArrowArrayStream* stream,
+                                 const char* filename,
+                                 const bcf_hdr_t* hdr,
+                                 hts_idx_t* idx,
+                                 tbx_t* tbx,
+                                 const vcf_arrow_options_t* opts);
+
+/**
+ * @brief Point an indexed stream at a new region
+ *
+ * Replaces the stream's iterator and clears its end-of-stream flag so that
+ * the following get_next() calls return the records of @p region. Records
+ * that start before the region (but overlap it) are skipped, so adjacent
+ * windows such as "chr1:1-1000000" and "chr1:1000001" never return the same
+ * record twice.
+ *
+ * @param stream Stream with a loaded or borrowed index
+ * @param region Region string (e.g., "chr1" or "chr1:1-1000000")
+ * @return 0 on success, non-zero on error (see get_last_error)
+ */
+int vcf_arrow_stream_set_region(struct ArrowArrayStream* stream,
+                                const char* region);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1266 @@
+// Arrow Stream to VCF/BCF Writer
+// Fills bcf1_t records from Arrow batches and writes them with htslib,
+// optionally building a CSI index on the fly.
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_arrow_writer.h"
+#include "htslib/khash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+KHASH_MAP_INIT_STR(vcf_col, int)
+
+// Minimum bin shift of the CSI index written alongside compressed output
+#define VCF_WRITER_CSI_MIN_SHIFT 14
+
+// =============================================================================
+// Arrow Column Access
+// =============================================================================
+
+typedef enum {
+    ARROW_KIND_UNSUPPORTED = 0,
+    ARROW_KIND_NULL,
+    ARROW_KIND_BOOL,
+    ARROW_KIND_INT,
+    ARROW_KIND_UINT,
+    ARROW_KIND_FLOAT,
+    ARROW_KIND_DOUBLE,
+    ARROW_KIND_STRING,
+    ARROW_KIND_LARGE_STRING,
+    ARROW_KIND_LIST,
+    ARROW_KIND_LARGE_LIST
+} arrow_kind_t;
+
+typedef struct {
+    arrow_kind_t kind;
+    int width;                        // Bytes per value for INT/UINT
+    const struct ArrowArray* array;   // Bound per batch
+} arrow_leaf_t;
+
+typedef struct {
+    const char* name;                 // Points into the stream schema
+    arrow_leaf_t leaf;                // The column itself
+    arrow_leaf_t values;              // List values when is_list
+    int is_list;
+} arrow_col_t;
+
+static arrow_kind_t arrow_format_kind(const char* format, int* width) {
+    *width = 0;
+    if (!format) return ARROW_KIND_UNSUPPORTED;
+    if (strcmp(format, "n") == 0) return ARROW_KIND_NULL;
+    if (strcmp(format, "b") == 0) return ARROW_KIND_BOOL;
+    if (strcmp(format, "c") == 0) { *width = 1; return ARROW_KIND_INT; }
+    if (strcmp(format, "s") == 0) { *width = 2; return ARROW_KIND_INT; }
+    if (strcmp(format, "i") == 0) { *width = 4; return ARROW_KIND_INT; }
+    if (strcmp(format, "l") == 0) { *width = 8; return ARROW_KIND_INT; }
+    if (strcmp(format, "C") == 0) { *width = 1; return ARROW_KIND_UINT; }
+    if (strcmp(format, "S") == 0) { *width = 2; return ARROW_KIND_UINT; }
+    if (strcmp(format, "I") == 0) { *width = 4; return ARROW_KIND_UINT; }
+    if (strcmp(format, "L") == 0) { *width = 8; return ARROW_KIND_UINT; }
+    if (strcmp(format, "f") == 0) return ARROW_KIND_FLOAT;
+    if (strcmp(format, "g") == 0) return ARROW_KIND_DOUBLE;
+    if (strcmp(format, "u") == 0) return ARROW_KIND_STRING;
+    if (strcmp(format, "U") == 0) return ARROW_KIND_LARGE_STRING;
+    if (strcmp(format, "+l") == 0) return ARROW_KIND_LIST;
+    if (strcmp(format, "+L") == 0) return ARROW_KIND_LARGE_LIST;
+    return ARROW_KIND_UNSUPPORTED;
+}
+
+static inline int arrow_kind_is_numeric(arrow_kind_t kind) {
+    return kind == ARROW_KIND_BOOL || kind == ARROW_KIND_INT || kind == ARROW_KIND_UINT ||
+           kind == ARROW_KIND_FLOAT || kind == ARROW_KIND_DOUBLE;
+}
+
+static inline int arrow_kind_is_string(arrow_kind_t kind) {
+    return kind == ARROW_KIND_STRING || kind == ARROW_KIND_LARGE_STRING;
+}
+
+static inline int arrow_is_null(const arrow_leaf_t* leaf, int64_t i) {
+    const struct ArrowArray* a = leaf->array;
+    if (leaf->kind == ARROW_KIND_NULL) return 1;
+    if (a->null_count == 0 || a->n_buffers < 1 || !a->buffers[0]) return 0;
+    const uint8_t* validity = (const uint8_t*)a->buffers[0];
+    int64_t j = a->offset + i;
+    return !((validity[j >> 3] >> (j & 7)) & 1);
+}
+
+static int64_t arrow_get_int(const arrow_leaf_t* leaf, int64_t i) {
+    const struct ArrowArray* a = leaf->array;
+    int64_t j = a->offset + i;
+    const void* data = a->buffers[1];
+    switch (leaf->kind) {
+        case ARROW_KIND_BOOL:
+            return (((const uint8_t*)data)[j >> 3] >> (j & 7)) & 1;
+        case ARROW_KIND_INT:
+            switch (leaf->width) {
+                case 1: return ((const int8_t*)data)[j];
+                case 2: return ((const int16_t*)data)[j];
+                case 4: return ((const int32_t*)data)[j];
+                default: return ((const int64_t*)data)[j];
+            }
+        case ARROW_KIND_UINT:
+            switch (leaf->width) {
+                case 1: return ((const uint8_t*)data)[j];
+                case 2: return ((const uint16_t*)data)[j];
+                case 4: return ((const uint32_t*)data)[j];
+                default: return (int64_t)((const uint64_t*)data)[j];
+            }
+        case ARROW_KIND_FLOAT:
+            return (int64_t)((const float*)data)[j];
+        case ARROW_KIND_DOUBLE:
+            return (int64_t)((const double*)data)[j];
+        default:
+            return 0;
+    }
+}
+
+static double arrow_get_double(const arrow_leaf_t* leaf, int64_t i) {
+    const struct ArrowArray* a = leaf->array;
+    int64_t j = a->offset + i;
+    if (leaf->kind == ARROW_KIND_FLOAT) return ((const float*)a->buffers[1])[j];
+    if (leaf->kind == ARROW_KIND_DOUBLE) return ((const double*)a->buffers[1])[j];
+    return (double)arrow_get_int(leaf, i);
+}
+
+static const char* arrow_get_string(const arrow_leaf_t* leaf, int64_t i, int64_t* len) {
+    const struct ArrowArray* a = leaf->array;
+    int64_t j = a->offset + i;
+    const char* data = (const char*)a->buffers[2];
+    int64_t start, end;
+    if (leaf->kind == ARROW_KIND_LARGE_STRING) {
+        start = ((const int64_t*)a->buffers[1])[j];
+        end = ((const int64_t*)a->buffers[1])[j + 1];
+    } else {
+        start = ((const int32_t*)a->buffers[1])[j];
+        end = ((const int32_t*)a->buffers[1])[j + 1];
+    }
+    *len = end - start;
+    return data ? data + start : "";
+}
+
+static void arrow_list_bounds(const arrow_col_t* col, int64_t i, int64_t* start, int64_t* end) {
+    const struct ArrowArray* a = col->leaf.array;
+    int64_t j = a->offset + i;
+    if (col->leaf.kind == ARROW_KIND_LARGE_LIST) {
+        *start = ((const int64_t*)a->buffers[1])[j];
+        *end = ((const int64_t*)a->buffers[1])[j + 1];
+    } else {
+        *start = ((const int32_t*)a->buffers[1])[j];
+        *end = ((const int32_t*)a->buffers[1])[j + 1];
+    }
+}
+
+// =============================================================================
+// Writer State
+// =============================================================================
+
+typedef struct {
+    const char* key;          // Tag name (points into the header)
+    int type;                 // BCF_HT_*
+    arrow_col_t* col;
+} info_binding_t;
+
+typedef struct {
+    const char* key;          // Tag name (points into the header)
+    int type;                 // BCF_HT_*
+    int is_gt;
+    arrow_col_t** cols;       // One per header sample, NULL if absent (tidy: one column)
+} format_binding_t;
+
+/**
+ * FORMAT values of the open record in the tidy layout, copied per sample
+ * because a record's rows can span batches.
+ */
+typedef struct {
+    int64_t* off;             // Per sample start in vals or text
+    int* len;                 // Values (bytes for strings), -1 if no row
+    int32_t* ivals;
+    float* fvals;
+    size_t n_vals;
+    size_t m_vals;
+    kstring_t text;           // String and GT cells, NUL-terminated
+} tidy_stage_t;
+
+typedef struct {
+    bcf_hdr_t* hdr;
+    int n_samples;
+
+    int n_cols;
+    arrow_col_t* cols;
+    arrow_col_t* core[7];     // CHROM, POS, ID, REF, ALT, QUAL, FILTER
+
+    int n_info;
+    info_binding_t* info;
+    int n_format;
+    format_binding_t* format;
+
+    // Scratch buffers reused across records
+    kstring_t str;
+    kstring_t chrom;
+    int32_t* ibuf;
+    size_t ibuf_m;
+    float* fbuf;
+    size_t fbuf_m;
+    int* filters;
+    size_t filters_m;
+    size_t* soffsets;
+    const char** svalues;
+
+    // Tidy layout
+    int tidy;
+    int check_order;
+    arrow_col_t* sample_col;
+    tidy_stage_t* stage;      // One per FORMAT binding
+    uint8_t* seen;            // Samples staged for the open record
+    int group_open;
+    kstring_t group_key;      // CHROM, POS and alleles of the open record
+    kstring_t key;            // The same for the current row
+    kstring_t pos_keys;       // Records already written at last_pos
+    uint8_t* contig_done;     // Contigs left behind, by rid
+    int last_rid;
+    hts_pos_t last_pos;
+} vcf_writer_t;
+
+enum { CORE_CHROM = 0, CORE_POS, CORE_ID, CORE_REF, CORE_ALT, CORE_QUAL, CORE_FILTER };
+static const char* core_names[7] = {"CHROM", "POS", "ID", "REF", "ALT", "QUAL", "FILTER"};
+
+static void writer_free(vcf_writer_t* w) {
+    if (w->stage) {
+        for (int i = 0; i < w->n_format; i++) {
+            free(w->stage[i].off);
+            free(w->stage[i].len);
+            free(w->stage[i].ivals);
+            free(w->stage[i].fvals);
+            free(w->stage[i].text.s);
+        }
+        free(w->stage);
+    }
+    if (w->format) {
+        for (int i = 0; i < w->n_format; i++) free(w->format[i].cols);
+        free(w->format);
+    }
+    free(w->info);
+    free(w->cols);
+    free(w->str.s);
+    free(w->chrom.s);
+    free(w->ibuf);
+    free(w->fbuf);
+    free(w->filters);
+    free(w->soffsets);
+    free(w->svalues);
+    free(w->seen);
+    free(w->group_key.s);
+    free(w->key.s);
+    free(w->pos_keys.s);
+    free(w->contig_done);
+    if (w->hdr) bcf_hdr_destroy(w->hdr);
+    memset(w, 0, sizeof(*w));
+}
+
+static int ensure_ibuf(vcf_writer_t* w, size_t n) {
+    if (n <= w->ibuf_m) return 0;
+    int32_t* p = (int32_t*)realloc(w->ibuf, n * sizeof(int32_t));
+    if (!p) return ENOMEM;
+    w->ibuf = p;
+    w->ibuf_m = n;
+    return 0;
+}
+
+static int ensure_fbuf(vcf_writer_t* w, size_t n) {
+    if (n <= w->fbuf_m) return 0;
+    float* p = (float*)realloc(w->fbuf, n * sizeof(float));
+    if (!p) return ENOMEM;
+    w->fbuf = p;
+    w->fbuf_m = n;
+    return 0;
+}
+
+static int tidy_init(vcf_writer_t* w) {
+    int n_samples = w->n_samples > 0 ? w->n_samples : 1;
+    w->stage = (tidy_stage_t*)calloc(w->n_format > 0 ? w->n_format : 1, sizeof(tidy_stage_t));
+    w->seen = (uint8_t*)calloc(n_samples, 1);
+    w->contig_done = (uint8_t*)calloc(w->hdr->n[BCF_DT_CTG] > 0 ? w->hdr->n[BCF_DT_CTG] : 1, 1);
+    if (!w->stage || !w->seen || !w->contig_done) return ENOMEM;
+    for (int t = 0; t < w->n_format; t++) {
+        w->stage[t].off = (int64_t*)malloc(n_samples * sizeof(int64_t));
+        w->stage[t].len = (int*)malloc(n_samples * sizeof(int));
+        if (!w->stage[t].off || !w->stage[t].len) return ENOMEM;
+        for (int s = 0; s < n_samples; s++) w->stage[t].len[s] = -1;
+    }
+    w->last_rid = -1;
+    return 0;
+}
+
+/**
+ * Whether a column can carry values of header type @p type.
+ */
+static int column_matches_type(const arrow_col_t* col, int type) {
+    arrow_kind_t kind = col->is_list ? col->values.kind : col->leaf.kind;
+    if (kind == ARROW_KIND_NULL) return 1;
+    switch (type) {
+        case BCF_HT_FLAG: return !col->is_list && arrow_kind_is_numeric(kind);
+        case BCF_HT_INT:
+        case BCF_HT_REAL: return arrow_kind_is_numeric(kind);
+        case BCF_HT_STR: return arrow_kind_is_string(kind);
+        default: return 0;
+    }
+}
+
+// =============================================================================
+// Schema Binding
+// =============================================================================
+
+static int writer_bind_schema(vcf_writer_t* w, const struct ArrowSchema* schema,
+                              char* error_msg, size_t error_len) {
+    if (!schema->format || strcmp(schema->format, "+s") != 0) {
+        snprintf(error_msg, error_len, "Arrow stream must have a struct schema");
+        return EINVAL;
+    }
+
+    w->n_cols = (int)schema->n_children;
+    w->cols = (arrow_col_t*)calloc(w->n_cols > 0 ? w->n_cols : 1, sizeof(arrow_col_t));
+    if (!w->cols) return ENOMEM;
+
+    khash_t(vcf_col)* by_name = kh_init(vcf_col);
+    if (!by_name) return ENOMEM;
+
+    int ret = 0;
+    for (int c = 0; c < w->n_cols; c++) {
+        const struct ArrowSchema* child = schema->children[c];
+        arrow_col_t* col = &w->cols[c];
+        col->name = child->name ? child->name : "";
+        col->leaf.kind = arrow_format_kind(child->format, &col->leaf.width);
+        if (col->leaf.kind == ARROW_KIND_LIST || col->leaf.kind == ARROW_KIND_LARGE_LIST) {
+            col->is_list = 1;
+            col->values.kind = child->n_children == 1
+                ? arrow_format_kind(child->children[0]->format, &col->values.width)
+                : ARROW_KIND_UNSUPPORTED;
+        }
+
+        int absent;
+        khint_t k = kh_put(vcf_col, by_name, col->name, &absent);
+        if (absent < 0) {
+            ret = ENOMEM;
+            goto done;
+        }
+        if (absent) kh_value(by_name, k) = c;
+    }
+
+    // Core columns
+    for (int i = 0; i < 7; i++) {
+        khint_t k = kh_get(vcf_col, by_name, core_names[i]);
+        w->core[i] = k != kh_end(by_name) ? &w->cols[kh_value(by_name, k)] : NULL;
+    }
+    if (!w->core[CORE_CHROM] || !w->core[CORE_POS] || !w->core[CORE_REF]) {
+        snprintf(error_msg, error_len, "Arrow stream must have CHROM, POS and REF columns");
+        ret = EINVAL;
+        goto done;
+    }
+    if (!arrow_kind_is_string(w->core[CORE_CHROM]->leaf.kind) ||
+        !arrow_kind_is_string(w->core[CORE_REF]->leaf.kind) ||
+        !arrow_kind_is_numeric(w->core[CORE_POS]->leaf.kind) ||
+        (w->core[CORE_ID] && !arrow_kind_is_string(w->core[CORE_ID]->leaf.kind)) ||
+        (w->core[CORE_QUAL] && !arrow_kind_is_numeric(w->core[CORE_QUAL]->leaf.kind)) ||
+        (w->core[CORE_ALT] && !(w->core[CORE_ALT]->is_list &&
+                                arrow_kind_is_string(w->core[CORE_ALT]->values.kind))) ||
+        (w->core[CORE_FILTER] && !(w->core[CORE_FILTER]->is_list &&
+                                   arrow_kind_is_string(w->core[CORE_FILTER]->values.kind)))) {
+        snprintf(error_msg, error_len, "Unexpected Arrow type for a core VCF column");
+        ret = EINVAL;
+        goto done;
+    }
+    if (w->tidy) {
+        khint_t k = kh_get(vcf_col, by_name, "SAMPLE_ID");
+        w->sample_col = k != kh_end(by_name) ? &w->cols[kh_value(by_name, k)] : NULL;
+        if (!w->sample_col || !arrow_kind_is_string(w->sample_col->leaf.kind)) {
+            snprintf(error_msg, error_len, "Tidy Arrow stream must have a SAMPLE_ID string column");
+            ret = EINVAL;
+            goto done;
+        }
+    }
+
+    // INFO and FORMAT tags declared in the header, in header order
+    bcf_hdr_t* hdr = w->hdr;
+    int n_ids = hdr->n[BCF_DT_ID];
+    w->info = (info_binding_t*)calloc(n_ids > 0 ? n_ids : 1, sizeof(info_binding_t));
+    w->format = (format_binding_t*)calloc(n_ids > 0 ? n_ids : 1, sizeof(format_binding_t));
+    if (!w->info || !w->format) {
+        ret = ENOMEM;
+        goto done;
+    }
+
+    kstring_t name = {0, 0, NULL};
+    for (int pass = 0; pass < 2 && ret == 0; pass++) {
+        // GT first so that it leads the FORMAT column as the VCF spec requires
+        for (int id = 0; id < n_ids && ret == 0; id++) {
+            const char* key = hdr->id[BCF_DT_ID][id].key;
+            if (!hdr->id[BCF_DT_ID][id].val || !key) continue;
+
+            if (pass == 0 && hdr->id[BCF_DT_ID][id].val->hrec[BCF_HL_INFO]) {
+                name.l = 0;
+                ksprintf(&name, "INFO_%s", key);
+                khint_t k = kh_get(vcf_col, by_name, name.s);
+                if (k == kh_end(by_name)) continue;
+
+                arrow_col_t* col = &w->cols[kh_value(by_name, k)];
+                int type = bcf_hdr_id2type(hdr, BCF_HL_INFO, id);
+                if (!column_matches_type(col, type)) {
+                    snprintf(error_msg, error_len,
+                             "Column %s does not match the INFO/%s header type", col->name, key);
+                    ret = EINVAL;
+                    break;
+                }
+                info_binding_t* b = &w->info[w->n_info++];
+                b->key = key;
+                b->type = type;
+                b->col = col;
+            }
+
+            if (hdr->id[BCF_DT_ID][id].val->hrec[BCF_HL_FMT] && w->n_samples > 0) {
+                int is_gt = strcmp(key, "GT") == 0;
+                if ((pass == 0) != is_gt) continue;
+
+                int type = bcf_hdr_id2type(hdr, BCF_HL_FMT, id);
+                int n_cols = w->tidy ? 1 : w->n_samples;
+                arrow_col_t** cols = (arrow_col_t**)calloc(n_cols, sizeof(arrow_col_t*));
+                if (!cols) {
+                    ret = ENOMEM;
+                    break;
+                }
+                int n_found = 0;
+                for (int s = 0; s < n_cols; s++) {
+                    name.l = 0;
+                    if (w->tidy) {
+                        ksprintf(&name, "FORMAT_%s", key);
+                    } else {
+                        ksprintf(&name, "FORMAT_%s_%s", key, hdr->samples[s]);
+                    }
+                    khint_t k = kh_get(vcf_col, by_name, name.s);
+                    if (k == kh_end(by_name)) continue;
+
+                    arrow_col_t* col = &w->cols[kh_value(by_name, k)];
+                    if (!column_matches_type(col, type) || type == BCF_HT_FLAG ||
+                        (is_gt && col->is_list)) {
+                        snprintf(error_msg, error_len,
+                                 "Column %s does not match the FORMAT/%s header type",
+                                 col->name, key);
+                        ret = EINVAL;
+                        break;
+                    }
+                    cols[s] = col;
+                    n_found++;
+                }
+                if (ret != 0 || n_found == 0) {
+                    free(cols);
+                    continue;
+                }
+                format_binding_t* b = &w->format[w->n_format++];
+                b->key = key;
+                b->type = type;
+                b->is_gt = is_gt;
+                b->cols = cols;
+            }
+        }
+    }
+    free(name.s);
+
+    if (ret == 0 && w->n_samples > 0) {
+        w->soffsets = (size_t*)malloc(w->n_samples * sizeof(size_t));
+        w->svalues = (const char**)malloc(w->n_samples * sizeof(const char*));
+        if (!w->soffsets || !w->svalues) ret = ENOMEM;
+    }
+    if (ret == 0 && w->tidy) ret = tidy_init(w);
+
+done:
+    kh_destroy(vcf_col, by_name);
+    return ret;
+}
+
+/**
+ * Point every column at its child array of @p batch.
+ */
+static int writer_bind_batch(vcf_writer_t* w, const struct ArrowArray* batch,
+                             char* error_msg, size_t error_len) {
+    if (batch->n_children != w->n_cols) {
+        snprintf(error_msg, error_len, "Batch has %lld columns, schema has %d",
+                 (long long)batch->n_children, w->n_cols);
+        return EINVAL;
+    }
+    for (int c = 0; c < w->n_cols; c++) {
+        arrow_col_t* col = &w->cols[c];
+        col->leaf.array = batch->children[c];
+        col->values.array = col->is_list && batch->children[c]->n_children == 1
+            ? batch->children[c]->children[0]
+            : NULL;
+    }
+    return 0;
+}
+
+// =============================================================================
+// Record Filling
+// =============================================================================
+
+/**
+ * Append value @p i of a string or numeric leaf to @p s ('.' when null).
+ */
+static void append_value(kstring_t* s, const arrow_leaf_t* leaf, int64_t i) {
+    if (arrow_is_null(leaf, i)) {
+        kputc('.', s);
+    } else if (arrow_kind_is_string(leaf->kind)) {
+        int64_t len;
+        const char* str = arrow_get_string(leaf, i, &len);
+        kputsn(str, len, s);
+    } else if (leaf->kind == ARROW_KIND_FLOAT || leaf->kind == ARROW_KIND_DOUBLE) {
+        ksprintf(s, "%g", arrow_get_double(leaf, i));
+    } else {
+        ksprintf(s, "%lld", (long long)arrow_get_int(leaf, i));
+    }
+}
+
+/**
+ * Append a scalar or the comma-joined elements of a list cell to @p s.
+ * Returns the number of values appended (0 for a null or empty cell).
+ */
+static int append_joined(kstring_t* s, const arrow_col_t* col, int64_t i) {
+    if (arrow_is_null(&col->leaf, i)) return 0;
+    if (!col->is_list) {
+        append_value(s, &col->leaf, i);
+        return 1;
+    }
+    int64_t start, end;
+    arrow_list_bounds(col, i, &start, &end);
+    for (int64_t k = start; k < end; k++) {
+        if (k > start) kputc(',', s);
+        append_value(s, &col->values, k);
+    }
+    return (int)(end - start);
+}
+
+/**
+ * Number of values in a cell: 0 when null, 1 for scalars, list length otherwise.
+ */
+static int64_t cell_length(const arrow_col_t* col, int64_t i) {
+    if (arrow_is_null(&col->leaf, i)) return 0;
+    if (!col->is_list) return 1;
+    int64_t start, end;
+    arrow_list_bounds(col, i, &start, &end);
+    return end - start;
+}
+
+/**
+ * Copy up to @p n values of a cell into @p out as int32 or float, padding
+ * with vector_end; a null cell becomes a single missing value.
+ */
+static void fill_numeric(const arrow_col_t* col, int64_t i, int type, void* out, int n) {
+    int32_t* iout = (int32_t*)out;
+    float* fout = (float*)out;
+    int64_t start = 0, end = 0;
+    const arrow_leaf_t* leaf = &col->leaf;
+    if (!arrow_is_null(&col->leaf, i)) {
+        if (col->is_list) {
+            arrow_list_bounds(col, i, &start, &end);
+            leaf = &col->values;
+        } else {
+            start = i;
+            end = i + 1;
+        }
+    }
+
+    int k = 0;
+    for (int64_t j = start; j < end && k < n; j++, k++) {
+        int missing = arrow_is_null(leaf, j);
+        if (type == BCF_HT_INT) {
+            iout[k] = missing ? bcf_int32_missing : (int32_t)arrow_get_int(leaf, j);
+        } else if (missing) {
+            bcf_float_set_missing(fout[k]);
+        } else {
+            fout[k] = (float)arrow_get_double(leaf, j);
+        }
+    }
+    if (k == 0) {
+        if (type == BCF_HT_INT) iout[0] = bcf_int32_missing;
+        else bcf_float_set_missing(fout[0]);
+        k = 1;
+    }
+    for (; k < n; k++) {
+        if (type == BCF_HT_INT) iout[k] = bcf_int32_vector_end;
+        else bcf_float_set_vector_end(fout[k]);
+    }
+}
+
+/**
+ * Encode one GT string ("0/1", "1|0", "./.", ".") into @p out, padded with
+ * vector_end to @p ploidy. Returns the number of alleles in the string.
+ */
+static int encode_gt(const char* s, int64_t len, int32_t* out, int ploidy) {
+    int n = 0;
+    int phased = 0;
+    int64_t p = 0;
+    if (len > 0 && s[0] == '|') {
+        phased = 1;
+        p = 1;
+    }
+    while (p < len) {
+        int64_t q = p;
+        while (q < len && s[q] != '/' && s[q] != '|') q++;
+        if (n < ploidy) {
+            if (q - p == 1 && s[p] == '.') {
+                out[n] = phased ? bcf_gt_phased(-1) : bcf_gt_missing;
+            } else {
+                int allele = 0;
+                for (int64_t k = p; k < q; k++) {
+                    if (s[k] < '0' || s[k] > '9') break;
+                    allele = allele * 10 + (s[k] - '0');
+                }
+                out[n] = phased ? bcf_gt_phased(allele) : bcf_gt_unphased(allele);
+            }
+        }
+        n++;
+        if (q >= len) break;
+        phased = s[q] == '|';
+        p = q + 1;
+    }
+    for (int k = n; k < ploidy; k++) out[k] = bcf_int32_vector_end;
+    if (n == 0 && ploidy > 0) out[0] = bcf_gt_missing;
+    return n;
+}
+
+static int gt_ploidy(const char* s, int64_t len) {
+    int n = 1;
+    for (int64_t k = (len > 0 && s[0] == '|') ? 1 : 0; k < len; k++) {
+        if (s[k] == '/' || s[k] == '|') n++;
+    }
+    return n;
+}
+
+static int fill_info(vcf_writer_t* w, bcf1_t* rec, int64_t i) {
+    for (int t = 0; t < w->n_info; t++) {
+        info_binding_t* b = &w->info[t];
+        arrow_col_t* col = b->col;
+        int64_t n = cell_length(col, i);
+        if (n == 0) continue;
+
+        int ret = 0;
+        if (b->type == BCF_HT_FLAG) {
+            if (arrow_get_int(&col->leaf, i)) {
+                ret = bcf_update_info_flag(w->hdr, rec, b->key, NULL, 1);
+            }
+        } else if (b->type == BCF_HT_STR) {
+            w->str.l = 0;
+            append_joined(&w->str, col, i);
+            ret = bcf_update_info_string(w->hdr, rec, b->key, w->str.s);
+        } else if (b->type == BCF_HT_INT) {
+            if (ensure_ibuf(w, n) != 0) return ENOMEM;
+            fill_numeric(col, i, BCF_HT_INT, w->ibuf, (int)n);
+            ret = bcf_update_info_int32(w->hdr, rec, b->key, w->ibuf, (int)n);
+        } else if (b->type == BCF_HT_REAL) {
+            if (ensure_fbuf(w, n) != 0) return ENOMEM;
+            fill_numeric(col, i, BCF_HT_REAL, w->fbuf, (int)n);
+            ret = bcf_update_info_float(w->hdr, rec, b->key, w->fbuf, (int)n);
+        }
+        if (ret < 0) return EIO;
+    }
+    return 0;
+}
+
+static int fill_format(vcf_writer_t* w, bcf1_t* rec, int64_t i) {
+    int n_samples = w->n_samples;
+
+    for (int t = 0; t < w->n_format; t++) {
+        format_binding_t* b = &w->format[t];
+
+        // Values per sample: widest cell (ploidy for GT). A field whose
+        // cells are all null is still written, as missing values, so that
+        // the FORMAT column keeps its layout.
+        int width = 0;
+        int bound = 0;
+        for (int s = 0; s < n_samples; s++) {
+            arrow_col_t* col = b->cols[s];
+            if (col) bound = 1;
+            if (!col || arrow_is_null(&col->leaf, i)) continue;
+            int n;
+            if (b->is_gt && !col->is_list) {
+                int64_t len;
+                const char* gt = arrow_get_string(&col->leaf, i, &len);
+                n = gt_ploidy(gt, len);
+            } else if (b->type == BCF_HT_STR) {
+                n = 1;
+            } else {
+                n = (int)cell_length(col, i);
+            }
+            if (n > width) width = n;
+        }
+        if (!bound) continue;
+        if (width == 0) width = 1;
+
+        int ret = 0;
+        if (b->type == BCF_HT_STR && !b->is_gt) {
+            w->str.l = 0;
+            for (int s = 0; s < n_samples; s++) {
+                w->soffsets[s] = w->str.l;
+                arrow_col_t* col = b->cols[s];
+                if (!col || append_joined(&w->str, col, i) == 0) {
+                    kputc('.', &w->str);
+                }
+                kputc('\0', &w->str);
+            }
+            for (int s = 0; s < n_samples; s++) {
+                w->svalues[s] = w->str.s + w->soffsets[s];
+            }
+            ret = bcf_update_format_string(w->hdr, rec, b->key, w->svalues, n_samples);
+        } else if (b->is_gt) {
+            if (ensure_ibuf(w, (size_t)width * n_samples) != 0) return ENOMEM;
+            for (int s = 0; s < n_samples; s++) {
+                arrow_col_t* col = b->cols[s];
+                int32_t* out = w->ibuf + (size_t)s * width;
+                if (!col || arrow_is_null(&col->leaf, i)) {
+                    encode_gt("", 0, out, width);
+                } else {
+                    int64_t len;
+                    const char* gt = arrow_get_string(&col->leaf, i, &len);
+                    encode_gt(gt, len, out, width);
+                }
+            }
+            ret = bcf_update_genotypes(w->hdr, rec, w->ibuf, width * n_samples);
+        } else if (b->type == BCF_HT_INT) {
+            if (ensure_ibuf(w, (size_t)width * n_samples) != 0) return ENOMEM;
+            for (int s = 0; s < n_samples; s++) {
+                int32_t* out = w->ibuf + (size_t)s * width;
+                if (b->cols[s]) {
+                    fill_numeric(b->cols[s], i, BCF_HT_INT, out, width);
+                } else {
+                    out[0] = bcf_int32_missing;
+                    for (int k = 1; k < width; k++) out[k] = bcf_int32_vector_end;
+                }
+            }
+            ret = bcf_update_format_int32(w->hdr, rec, b->key, w->ibuf, width * n_samples);
+        } else if (b->type == BCF_HT_REAL) {
+            if (ensure_fbuf(w, (size_t)width * n_samples) != 0) return ENOMEM;
+            for (int s = 0; s < n_samples; s++) {
+                float* out = w->fbuf + (size_t)s * width;
+                if (b->cols[s]) {
+                    fill_numeric(b->cols[s], i, BCF_HT_REAL, out, width);
+                } else {
+                    bcf_float_set_missing(out[0]);
+                    for (int k = 1; k < width; k++) bcf_float_set_vector_end(out[k]);
+                }
+            }
+            ret = bcf_update_format_float(w->hdr, rec, b->key, w->fbuf, width * n_samples);
+        }
+        if (ret < 0) return EIO;
+    }
+    return 0;
+}
+
+/**
+ * Append REF and the ALT alleles of row @p i, comma-separated, to @p s.
+ */
+static void append_alleles(vcf_writer_t* w, int64_t i, kstring_t* s) {
+    arrow_col_t* col = w->core[CORE_REF];
+    if (arrow_is_null(&col->leaf, i)) {
+        kputc('N', s);
+    } else {
+        int64_t len;
+        const char* str = arrow_get_string(&col->leaf, i, &len);
+        kputsn(str, len, s);
+    }
+    col = w->core[CORE_ALT];
+    if (col && !arrow_is_null(&col->leaf, i)) {
+        int64_t start, end;
+        arrow_list_bounds(col, i, &start, &end);
+        for (int64_t k = start; k < end; k++) {
+            kputc(',', s);
+            append_value(s, &col->values, k);
+        }
+    }
+}
+
+/**
+ * Fill @p rec from row @p i: the core columns, INFO and, in the wide layout,
+ * FORMAT. Tidy FORMAT values are staged separately (see tidy_add_row()).
+ */
+static int fill_record(vcf_writer_t* w, bcf1_t* rec, int64_t i,
+                       char* error_msg, size_t error_len) {
+    bcf_clear(rec);
+
+    // CHROM
+    arrow_col_t* col = w->core[CORE_CHROM];
+    int64_t len = 0;
+    const char* str = arrow_is_null(&col->leaf, i) ? "" : arrow_get_string(&col->leaf, i, &len);
+    w->chrom.l = 0;
+    kputsn(str, len, &w->chrom);
+    rec->rid = bcf_hdr_name2id(w->hdr, w->chrom.s);
+    if (rec->rid < 0) {
+        snprintf(error_msg, error_len, "Contig '%s' is not declared in the header", w->chrom.s);
+        return EINVAL;
+    }
+
+    // POS (1-based in the columns)
+    col = w->core[CORE_POS];
+    if (arrow_is_null(&col->leaf, i)) {
+        snprintf(error_msg, error_len, "Missing POS on contig '%s'", w->chrom.s);
+        return EINVAL;
+    }
+    rec->pos = (hts_pos_t)arrow_get_int(&col->leaf, i) - 1;
+
+    // ID
+    col = w->core[CORE_ID];
+    if (col && !arrow_is_null(&col->leaf, i)) {
+        str = arrow_get_string(&col->leaf, i, &len);
+        w->str.l = 0;
+        kputsn(str, len, &w->str);
+        if (bcf_update_id(w->hdr, rec, w->str.s) < 0) return EIO;
+    }
+
+    // REF and ALT as one comma-separated allele string
+    w->str.l = 0;
+    append_alleles(w, i, &w->str);
+    if (bcf_update_alleles_str(w->hdr, rec, w->str.s) < 0) return EIO;
+
+    // QUAL
+    col = w->core[CORE_QUAL];
+    if (col && !arrow_is_null(&col->leaf, i)) {
+        rec->qual = (float)arrow_get_double(&col->leaf, i);
+    } else {
+        bcf_float_set_missing(rec->qual);
+    }
+
+    // FILTER
+    col = w->core[CORE_FILTER];
+    if (col && !arrow_is_null(&col->leaf, i)) {
+        int64_t start, end;
+        arrow_list_bounds(col, i, &start, &end);
+        size_t n = (size_t)(end - start);
+        if (n > w->filters_m) {
+            int* p = (int*)realloc(w->filters, n * sizeof(int));
+            if (!p) return ENOMEM;
+            w->filters = p;
+            w->filters_m = n;
+        }
+        int n_flt = 0;
+        for (int64_t k = start; k < end; k++) {
+            if (arrow_is_null(&col->values, k)) continue;
+            str = arrow_get_string(&col->values, k, &len);
+            w->str.l = 0;
+            kputsn(str, len, &w->str);
+            if (strcmp(w->str.s, ".") == 0) continue;
+            int id = bcf_hdr_id2int(w->hdr, BCF_DT_ID, w->str.s);
+            if (id < 0 || !bcf_hdr_idinfo_exists(w->hdr, BCF_HL_FLT, id)) {
+                snprintf(error_msg, error_len, "Filter '%s' is not declared in the header",
+                         w->str.s);
+                return EINVAL;
+            }
+            w->filters[n_flt++] = id;
+        }
+        if (n_flt > 0 && bcf_update_filter(w->hdr, rec, w->filters, n_flt) < 0) return EIO;
+    }
+
+    int ret = fill_info(w, rec, i);
+    if (ret == 0 && !w->tidy) ret = fill_format(w, rec, i);
+    if (ret != 0) {
+        snprintf(error_msg, error_len, "Failed to encode record at %s:%lld",
+                 w->chrom.s, (long long)rec->pos + 1);
+    }
+    return ret;
+}
+
+// =============================================================================
+// Tidy Layout
+// =============================================================================
+
+/**
+ * Copy the FORMAT cells of row @p i into the stage of sample @p s.
+ */
+static int tidy_stage_row(vcf_writer_t* w, int s, int64_t i) {
+    for (int t = 0; t < w->n_format; t++) {
+        format_binding_t* b = &w->format[t];
+        tidy_stage_t* st = &w->stage[t];
+        arrow_col_t* col = b->cols[0];
+
+        if (b->type == BCF_HT_STR) {
+            st->off[s] = (int64_t)st->text.l;
+            int n = append_joined(&st->text, col, i);
+            st->len[s] = n > 0 ? (int)((int64_t)st->text.l - st->off[s]) : 0;
+            if (kputc('\0', &st->text) < 0) return ENOMEM;
+            continue;
+        }
+
+        int64_t n = cell_length(col, i);
+        if (st->n_vals + n > st->m_vals) {
+            size_t m = st->m_vals ? st->m_vals : 64;
+            while (m < st->n_vals + n) m *= 2;
+            if (b->type == BCF_HT_INT) {
+                int32_t* p = (int32_t*)realloc(st->ivals, m * sizeof(int32_t));
+                if (!p) return ENOMEM;
+                st->ivals = p;
+            } else {
+                float* p = (float*)realloc(st->fvals, m * sizeof(float));
+                if (!p) return ENOMEM;
+                st->fvals = p;
+            }
+            st->m_vals = m;
+        }
+        st->off[s] = (int64_t)st->n_vals;
+        st->len[s] = (int)n;
+        if (n > 0) {
+            void* out = b->type == BCF_HT_INT ? (void*)(st->ivals + st->n_vals)
+                                              : (void*)(st->fvals + st->n_vals);
+            fill_numeric(col, i, b->type, out, (int)n);
+            st->n_vals += n;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Encode the staged FORMAT values into @p rec, padding as fill_format() does.
+ */
+static int tidy_fill_format(vcf_writer_t* w, bcf1_t* rec) {
+    int n_samples = w->n_samples;
+
+    for (int t = 0; t < w->n_format; t++) {
+        format_binding_t* b = &w->format[t];
+        tidy_stage_t* st = &w->stage[t];
+
+        int width = 1;
+        for (int s = 0; s < n_samples; s++) {
+            if (st->len[s] <= 0) continue;
+            int n = b->is_gt ? gt_ploidy(st->text.s + st->off[s], st->len[s])
+                             : (b->type == BCF_HT_STR ? 1 : st->len[s]);
+            if (n > width) width = n;
+        }
+
+        int ret = 0;
+        if (b->is_gt) {
+            if (ensure_ibuf(w, (size_t)width * n_samples) != 0) return ENOMEM;
+            for (int s = 0; s < n_samples; s++) {
+                int32_t* out = w->ibuf + (size_t)s * width;
+                if (st->len[s] > 0) {
+                    encode_gt(st->text.s + st->off[s], st->len[s], out, width);
+                } else {
+                    encode_gt("", 0, out, width);
+                }
+            }
+            ret = bcf_update_genotypes(w->hdr, rec, w->ibuf, width * n_samples);
+        } else if (b->type == BCF_HT_STR) {
+            for (int s = 0; s < n_samples; s++) {
+                w->svalues[s] = st->len[s] > 0 ? st->text.s + st->off[s] : ".";
+            }
+            ret = bcf_update_format_string(w->hdr, rec, b->key, w->svalues, n_samples);
+        } else if (b->type == BCF_HT_INT) {
+            if (ensure_ibuf(w, (size_t)width * n_samples) != 0) return ENOMEM;
+            for (int s = 0; s < n_samples; s++) {
+                int32_t* out = w->ibuf + (size_t)s * width;
+                int n = st->len[s] > 0 ? st->len[s] : 0;
+                if (n > 0) memcpy(out, st->ivals + st->off[s], n * sizeof(int32_t));
+                if (n == 0) out[n++] = bcf_int32_missing;
+                for (; n < width; n++) out[n] = bcf_int32_vector_end;
+            }
+            ret = bcf_update_format_int32(w->hdr, rec, b->key, w->ibuf, width * n_samples);
+        } else if (b->type == BCF_HT_REAL) {
+            if (ensure_fbuf(w, (size_t)width * n_samples) != 0) return ENOMEM;
+            for (int s = 0; s < n_samples; s++) {
+                float* out = w->fbuf + (size_t)s * width;
+                int n = st->len[s] > 0 ? st->len[s] : 0;
+                if (n > 0) memcpy(out, st->fvals + st->off[s], n * sizeof(float));
+                if (n == 0) bcf_float_set_missing(out[n++]);
+                for (; n < width; n++) bcf_float_set_vector_end(out[n]);
+            }
+            ret = bcf_update_format_float(w->hdr, rec, b->key, w->fbuf, width * n_samples);
+        }
+        if (ret < 0) return EIO;
+    }
+    return 0;
+}
+
+/**
+ * Whether a record starting at rec->rid/rec->pos with key w->key keeps the
+ * rows variant-major: positions never go back within a contig, a contig is
+ * never revisited, and no variant repeats at one position.
+ */
+static int tidy_in_order(vcf_writer_t* w, const bcf1_t* rec) {
+    if (rec->rid != w->last_rid) {
+        if (w->last_rid >= 0) w->contig_done[w->last_rid] = 1;
+        if (w->contig_done[rec->rid]) return 0;
+        w->pos_keys.l = 0;
+    } else if (rec->pos < w->last_pos) {
+        return 0;
+    } else if (rec->pos > w->last_pos) {
+        w->pos_keys.l = 0;
+    } else {
+        // Keys written at this position, each followed by '\n'
+        size_t n = w->key.l;
+        for (size_t p = 0; p < w->pos_keys.l;) {
+            const char* line = w->pos_keys.s + p;
+            const char* nl = (const char*)memchr(line, '\n', w->pos_keys.l - p);
+            size_t len = (size_t)(nl - line);
+            if (len == n && memcmp(line, w->key.s, n) == 0) return 0;
+            p += len + 1;
+        }
+    }
+    w->last_rid = (int)rec->rid;
+    w->last_pos = rec->pos;
+    kputsn(w->key.s, w->key.l, &w->pos_keys);
+    kputc('\n', &w->pos_keys);
+    return 1;
+}
+
+/**
+ * Write the open tidy record and clear its stages.
+ */
+static int tidy_flush(vcf_writer_t* w, htsFile* fp, bcf1_t* rec, int64_t* n_records,
+                      char* error_msg, size_t error_len) {
+    if (!w->group_open) return 0;
+    w->group_open = 0;
+
+    // Without an output file the rows are only checked for order
+    if (fp) {
+        int ret = tidy_fill_format(w, rec);
+        if (ret != 0) {
+            snprintf(error_msg, error_len, "Failed to encode record at %s:%lld",
+                     bcf_seqname_safe(w->hdr, rec), (long long)rec->pos + 1);
+            return ret;
+        }
+        if (bcf_write(fp, w->hdr, rec) < 0) {
+            snprintf(error_msg, error_len, "Failed to write record at %s:%lld",
+                     bcf_seqname_safe(w->hdr, rec), (long long)rec->pos + 1);
+            return EIO;
+        }
+    }
+    (*n_records)++;
+
+    for (int t = 0; t < w->n_format; t++) {
+        tidy_stage_t* st = &w->stage[t];
+        st->n_vals = 0;
+        st->text.l = 0;
+        for (int s = 0; s < w->n_samples; s++) st->len[s] = -1;
+    }
+    memset(w->seen, 0, w->n_samples > 0 ? w->n_samples : 1);
+    return 0;
+}
+
+/**
+ * Add tidy row @p i: start a new record when the variant changes or the
+ * sample has already been staged, then stage the row's FORMAT values.
+ */
+static int tidy_add_row(vcf_writer_t* w, htsFile* fp, bcf1_t* rec, int64_t i,
+                        int64_t* n_records, char* error_msg, size_t error_len) {
+    arrow_col_t* col = w->sample_col;
+    if (arrow_is_null(&col->leaf, i)) {
+        snprintf(error_msg, error_len, "Missing SAMPLE_ID in tidy row");
+        return EINVAL;
+    }
+    int64_t len;
+    const char* str = arrow_get_string(&col->leaf, i, &len);
+    w->str.l = 0;
+    kputsn(str, len, &w->str);
+    int s = bcf_hdr_id2int(w->hdr, BCF_DT_SAMPLE, w->str.s);
+    if (s < 0) {
+        snprintf(error_msg, error_len, "Sample '%s' is not declared in the header", w->str.s);
+        return EINVAL;
+    }
+
+    // Variant key: CHROM, POS and alleles
+    w->key.l = 0;
+    col = w->core[CORE_CHROM];
+    if (!arrow_is_null(&col->leaf, i)) {
+        str = arrow_get_string(&col->leaf, i, &len);
+        kputsn(str, len, &w->key);
+    }
+    kputc('\t', &w->key);
+    col = w->core[CORE_POS];
+    if (!arrow_is_null(&col->leaf, i)) kputll(arrow_get_int(&col->leaf, i), &w->key);
+    kputc('\t', &w->key);
+    append_alleles(w, i, &w->key);
+
+    if (!w->group_open || w->seen[s] || w->key.l != w->group_key.l ||
+        memcmp(w->key.s, w->group_key.s, w->key.l) != 0) {
+        int ret = tidy_flush(w, fp, rec, n_records, error_msg, error_len);
+        if (ret != 0) return ret;
+        ret = fill_record(w, rec, i, error_msg, error_len);
+        if (ret != 0) return ret;
+        if (w->check_order && !tidy_in_order(w, rec)) {
+            snprintf(error_msg, error_len, "Tidy rows are not sorted by variant at %s:%lld",
+                     w->chrom.s, (long long)rec->pos + 1);
+            return VCF_ARROW_WRITER_UNORDERED;
+        }
+        w->group_key.l = 0;
+        kputsn(w->key.s, w->key.l, &w->group_key);
+        w->group_open = 1;
+    }
+
+    w->seen[s] = 1;
+    return tidy_stage_row(w, s, i);
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+int vcf_arrow_write_stream(struct ArrowArrayStream* stream,
+                           const char* header_text,
+                           const char* filename,
+                           const vcf_arrow_writer_options_t* opts,
+                           int64_t* n_written,
+                           char* error_msg,
+                           size_t error_len) {
+    vcf_writer_t w;
+    memset(&w, 0, sizeof(w));
+    struct ArrowSchema schema;
+    memset(&schema, 0, sizeof(schema));
+    htsFile* fp = NULL;
+    bcf1_t* rec = NULL;
+    char* fnidx = NULL;
+    int indexing = 0;
+    int opened = 0;
+    int64_t n_records = 0;
+    int ret = 0;
+
+    error_msg[0] = '\0';
+    if (n_written) *n_written = 0;
+
+    // Header (bcf_hdr_parse modifies its input)
+    size_t text_len = strlen(header_text);
+    char* text = (char*)malloc(text_len + 2);
+    if (!text) return ENOMEM;
+    memcpy(text, header_text, text_len + 1);
+    if (text_len == 0 || text[text_len - 1] != '\n') {
+        text[text_len] = '\n';
+        text[text_len + 1] = '\0';
+    }
+    w.hdr = bcf_hdr_init("r");
+    if (!w.hdr || bcf_hdr_parse(w.hdr, text) != 0) {
+        free(text);
+        snprintf(error_msg, error_len, "Failed to parse the VCF header");
+        ret = EINVAL;
+        goto cleanup;
+    }
+    free(text);
+    w.n_samples = bcf_hdr_nsamples(w.hdr);
+    w.tidy = opts->tidy;
+    w.check_order = opts->tidy && (opts->check_order || !filename);
+
+    if (stream->get_schema(stream, &schema) != 0) {
+        snprintf(error_msg, error_len, "Failed to get Arrow schema: %s",
+                 stream->get_last_error ? stream->get_last_error(stream) : "unknown error");
+        ret = EIO;
+        goto cleanup;
+    }
+    ret = writer_bind_schema(&w, &schema, error_msg, error_len);
+    if (ret != 0) {
+        if (!error_msg[0]) snprintf(error_msg, error_len, "Failed to bind the Arrow schema");
+        goto cleanup;
+    }
+
+    // Output, unless only checking the order of tidy rows
+    if (filename) {
+        const char* mode = opts->mode == 'b' ? "wb" : (opts->mode == 'z' ? "wz" : "w");
+        // The index path is also where a stale index is removed on failure
+        fnidx = (char*)malloc(strlen(filename) + 5);
+        if (!fnidx) {
+            ret = ENOMEM;
+            goto cleanup;
+        }
+        sprintf(fnidx, "%s.csi", filename);
+        fp = hts_open(filename, mode);
+        if (!fp) {
+            snprintf(error_msg, error_len, "Failed to open output file: %s", filename);
+            ret = EIO;
+            goto cleanup;
+        }
+        opened = strcmp(filename, "-") != 0;
+        if (opts->threads > 1 && opts->mode != 'v') {
+            hts_set_threads(fp, opts->threads);
+        }
+        if (bcf_hdr_write(fp, w.hdr) < 0) {
+            snprintf(error_msg, error_len, "Failed to write the VCF header");
+            ret = EIO;
+            goto cleanup;
+        }
+        // htslib keeps the index path and opens it in bcf_idx_save()
+        if (opts->write_index && opts->mode != 'v') {
+            if (bcf_idx_init(fp, w.hdr, VCF_WRITER_CSI_MIN_SHIFT, fnidx) < 0) {
+                snprintf(error_msg, error_len, "Failed to initialise the index for %s",
+                         filename);
+                ret = EIO;
+                goto cleanup;
+            }
+            indexing = 1;
+        }
+    } else if (!w.tidy) {
+        snprintf(error_msg, error_len, "An output file is required");
+        ret = EINVAL;
+        goto cleanup;
+    }
+
+    rec = bcf_init();
+    if (!rec) {
+        ret = ENOMEM;
+        goto cleanup;
+    }
+
+    // Records
+    for (;;) {
+        struct ArrowArray batch;
+        memset(&batch, 0, sizeof(batch));
+        if (stream->get_next(stream, &batch) != 0) {
+            snprintf(error_msg, error_len, "Failed to read Arrow batch: %s",
+                     stream->get_last_error ? stream->get_last_error(stream) : "unknown error");
+            ret = EIO;
+            break;
+        }
+        if (!batch.release) break;
+
+        ret = writer_bind_batch(&w, &batch, error_msg, error_len);
+        for (int64_t r = 0; ret == 0 && r < batch.length; r++) {
+            if (w.tidy) {
+                ret = tidy_add_row(&w, fp, rec, batch.offset + r, &n_records,
+                                   error_msg, error_len);
+                continue;
+            }
+            ret = fill_record(&w, rec, batch.offset + r, error_msg, error_len);
+            if (ret != 0) break;
+            if (bcf_write(fp, w.hdr, rec) < 0) {
+                snprintf(error_msg, error_len, "Failed to write record at %s:%lld",
+                         w.chrom.s, (long long)rec->pos + 1);
+                ret = EIO;
+            } else {
+                n_records++;
+            }
+        }
+        batch.release(&batch);
+        if (ret != 0) break;
+    }
+
+    if (ret == 0 && w.tidy) {
+        ret = tidy_flush(&w, fp, rec, &n_records, error_msg, error_len);
+    }
+    if (ret == 0 && indexing && bcf_idx_save(fp) < 0) {
+        snprintf(error_msg, error_len, "Failed to save the index for %s", filename);
+        ret = EIO;
+    }
+
+cleanup:
+    if (rec) bcf_destroy(rec);
+    if (fp && hts_close(fp) != 0 && ret == 0) {
+        snprintf(error_msg, error_len, "Failed to close output file: %s", filename);
+        ret = EIO;
+    }
+    // No truncated output, nor an index left over from an earlier file
+    if (ret != 0 && opened) {
+        unlink(filename);
+        unlink(fnidx);
+    }
+    free(fnidx);
+    if (schema.release) schema.release(&schema);
+    writer_free(&w);
+    if (ret == 0 && n_written) *n_written = n_records;
+    if (ret == ENOMEM && !error_msg[0]) {
+        snprintf(error_msg, error_len, "Out of memory");
+    }
+    return ret;
+}
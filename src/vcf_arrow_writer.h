@@ -0,0 +1,75 @@
+// Arrow Stream to VCF/BCF Writer
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#ifndef VCF_ARROW_WRITER_H
+#define VCF_ARROW_WRITER_H
+
+#include "vcf_arrow_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Options for vcf_arrow_write_stream()
+ */
+typedef struct {
+    char mode;              // 'v' VCF, 'z' BGZF VCF, 'b' BCF
+    int threads;            // htslib compression threads (0 or 1 = none)
+    int write_index;        // Build a CSI index while writing ('z' and 'b' only)
+    int tidy;               // One row per variant and sample (SAMPLE_ID, FORMAT_<tag>)
+    int check_order;        // Tidy only: stop with VCF_ARROW_WRITER_UNORDERED when
+                            // the rows are not sorted variant-major
+} vcf_arrow_writer_options_t;
+
+/** Returned by vcf_arrow_write_stream() when check_order finds unsorted tidy rows */
+#define VCF_ARROW_WRITER_UNORDERED (-1)
+
+/**
+ * @brief Write the batches of an Arrow stream as VCF/BCF records
+ *
+ * Columns are matched by name against @p header_text, using the layout of
+ * the bcf_reader extension and vcf_open_arrow(): CHROM, POS, ID, REF, ALT,
+ * QUAL, FILTER, INFO_<tag> and FORMAT_<tag>_<sample> for the INFO and FORMAT
+ * tags and samples declared in the header. Other columns are ignored. Each
+ * record is filled with the bcf_update_*() functions and written directly,
+ * without formatting VCF text first. Records must arrive grouped by contig
+ * and sorted by POS within a contig when an index is built.
+ *
+ * With @c opts->tidy, each row holds one sample of a variant (SAMPLE_ID and
+ * FORMAT_<tag> columns, as written by bcf_read(tidy_format := true)). Rows
+ * are pivoted in a single pass: consecutive rows with the same CHROM, POS,
+ * REF and ALT are staged per sample and written as one record when the next
+ * variant starts, so the input must be variant-major. A sample seen twice
+ * also starts a new record. With @c opts->check_order, a position that goes
+ * backwards, a contig that reappears or a variant that reappears at the same
+ * position stops the write with VCF_ARROW_WRITER_UNORDERED. With a NULL
+ * @p filename, tidy rows are only checked for that order and nothing is
+ * written, so the caller can pick the row order before the one export;
+ * only the CHROM, POS, REF, ALT and SAMPLE_ID columns are needed for that.
+ *
+ * On failure the output file and its index are removed.
+ *
+ * @param stream Arrow stream of struct batches (consumed, not released)
+ * @param header_text Full VCF header, ##fileformat through the #CHROM line
+ * @param filename Output path, or NULL to check the order of tidy rows
+ * @param opts Output mode, threads and indexing
+ * @param n_written Number of records written, or checked (output, may be NULL)
+ * @param error_msg Buffer receiving an error message
+ * @param error_len Size of @p error_msg
+ * @return 0 on success, VCF_ARROW_WRITER_UNORDERED, or errno-style code on error
+ */
+int vcf_arrow_write_stream(struct ArrowArrayStream* stream,
+                           const char* header_text,
+                           const char* filename,
+                           const vcf_arrow_writer_options_t* opts,
+                           int64_t* n_written,
+                           char* error_msg,
+                           size_t error_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_ARROW_WRITER_H
@@ -0,0 +1,78 @@
+// Persistent VCF/BCF file handles
+// Keeps a file open with its header and index so that repeated metadata
+// queries neither re-read the header nor re-fetch the index.
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_handle.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+vcf_handle_t* vcf_handle_open(const char* filename, const char* index, int* err) {
+    vcf_handle_t* h = (vcf_handle_t*)calloc(1, sizeof(*h));
+    if (!h) {
+        *err = ENOMEM;
+        return NULL;
+    }
+
+    h->filename = strdup(filename);
+    h->index = index ? strdup(index) : NULL;
+    if (!h->filename || (index && !h->index)) {
+        *err = ENOMEM;
+        vcf_handle_close(h);
+        return NULL;
+    }
+
+    h->fp = hts_open(filename, "r");
+    if (!h->fp) {
+        *err = ENOENT;
+        vcf_handle_close(h);
+        return NULL;
+    }
+    h->hdr = bcf_hdr_read(h->fp);
+    if (!h->hdr) {
+        *err = EIO;
+        vcf_handle_close(h);
+        return NULL;
+    }
+
+    h->refs = 1;
+    *err = 0;
+    return h;
+}
+
+hts_idx_t* vcf_handle_index(vcf_handle_t* h) {
+    if (h->index_loaded) return h->idx;
+    h->index_loaded = 1;
+
+    // HTS_IDX_SAVE_REMOTE caches remote indexes locally
+    int flags = HTS_IDX_SAVE_REMOTE | HTS_IDX_SILENT_FAIL;
+    if (h->fp->format.format == vcf) {
+        h->tbx = tbx_index_load3(h->filename, h->index, flags);
+        if (h->tbx) {
+            h->idx = h->tbx->idx;
+            return h->idx;
+        }
+    }
+    h->idx = bcf_index_load3(h->filename, h->index, flags);
+    return h->idx;
+}
+
+void vcf_handle_ref(vcf_handle_t* h) {
+    __atomic_add_fetch(&h->refs, 1, __ATOMIC_ACQ_REL);
+}
+
+void vcf_handle_close(vcf_handle_t* h) {
+    if (!h) return;
+    // Handles that failed to open never got past refs == 0
+    if (h->refs > 0 && __atomic_sub_fetch(&h->refs, 1, __ATOMIC_ACQ_REL) > 0) return;
+    // tbx_destroy() frees its own idx
+    if (h->tbx) tbx_destroy(h->tbx);
+    else if (h->idx) hts_idx_destroy(h->idx);
+    if (h->hdr) bcf_hdr_destroy(h->hdr);
+    if (h->fp) hts_close(h->fp);
+    free(h->filename);
+    free(h->index);
+    free(h);
+}
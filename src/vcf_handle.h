@@ -0,0 +1,73 @@
+// Persistent VCF/BCF file handles
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#ifndef VCF_HANDLE_H
+#define VCF_HANDLE_H
+
+#include "htslib/hts.h"
+#include "htslib/tbx.h"
+#include "htslib/vcf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An open file with its header and (lazily loaded) index.
+ *
+ * Metadata probes (contigs, index presence, per-contig counts, region plans)
+ * all need the header and most need the index. Opening the file once and
+ * keeping both avoids re-reading the header, and on remote files the round
+ * trips, for every probe.
+ */
+typedef struct {
+    char* filename;
+    char* index;          // Explicit index path, or NULL for auto-detection
+    htsFile* fp;
+    bcf_hdr_t* hdr;       // Read-only; streams work on their own copies
+    hts_idx_t* idx;       // NULL until loaded, or when the file is unindexed
+    tbx_t* tbx;           // Tabix wrapper around idx (VCF with TBI)
+    int index_loaded;     // Index lookup done (idx may still be NULL)
+    int refs;             // R object plus streams borrowing the index
+} vcf_handle_t;
+
+/**
+ * @brief Open a file and read its header
+ *
+ * @param filename Path or URL of a VCF/BCF file
+ * @param index Optional explicit index path (or NULL)
+ * @param err Set to ENOENT if the file cannot be opened, EIO if the header
+ *            cannot be read, ENOMEM on allocation failure
+ * @return Handle, or NULL on failure
+ */
+vcf_handle_t* vcf_handle_open(const char* filename, const char* index, int* err);
+
+/**
+ * @brief The index of the file, loaded on first use
+ *
+ * VCF files try TBI first, then CSI; BCF files use CSI only.
+ *
+ * @return The index (owned by the handle), or NULL if there is none
+ */
+hts_idx_t* vcf_handle_index(vcf_handle_t* h);
+
+/**
+ * @brief Take a reference, e.g. for a stream that borrows the index
+ *
+ * Streams may be released on another thread than the one that opened the
+ * handle, so the count is atomic.
+ */
+void vcf_handle_ref(vcf_handle_t* h);
+
+/**
+ * @brief Drop a reference; the last one closes the file and frees the
+ *        handle (NULL is a no-op)
+ */
+void vcf_handle_close(vcf_handle_t* h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_HANDLE_H
@@ -0,0 +1,225 @@
+// On-the-fly CSI/TBI index building for VCF/BCF readers
+// Mirrors bcf_index_build3()/tbx_index_build3() record by record, so a
+// sequential reader can leave an index behind without a second pass.
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_index_build.h"
+#include "htslib/bgzf.h"
+#include "htslib/tbx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// TBI is fixed at 14-bit bins over 5 levels
+#define VCF_INDEX_TBI_MIN_SHIFT 14
+#define VCF_INDEX_TBI_N_LVLS 5
+
+struct vcf_index_builder_t {
+    hts_idx_t* idx;
+    BGZF* bgzf;
+    const bcf_hdr_t* hdr;
+    int fmt;                  // HTS_FMT_CSI or HTS_FMT_TBI
+    int is_vcf;               // Text VCF: tabix contig ids and metadata
+    int* rid2tid;             // VCF: header rid -> tabix id (-1 unseen)
+    int* tid2rid;             // VCF: tabix id -> header rid
+    int m_rid;                // Capacity of both maps
+    int n_tid;
+    char* fn;
+    char* fnidx;
+    int64_t n_records;
+    int failed;
+};
+
+// Levels needed to cover the longest header contig (as bcftools index does)
+static int index_n_lvls(const bcf_hdr_t* hdr, int min_shift, int64_t* max_len_out) {
+    int64_t max_len = 0;
+    for (int i = 0; i < hdr->n[BCF_DT_CTG]; i++) {
+        if (!hdr->id[BCF_DT_CTG][i].val) continue;
+        int64_t len = (int64_t)hdr->id[BCF_DT_CTG][i].val->info[0];
+        if (len > max_len) max_len = len;
+    }
+    if (!max_len) max_len = ((int64_t)1 << 31) - 1;  // Contig lines without length
+    max_len += 256;
+    *max_len_out = max_len;
+
+    int n_lvls = 0;
+    for (int64_t s = (int64_t)1 << min_shift; max_len > s; n_lvls++, s <<= 3) {}
+    return n_lvls;
+}
+
+static void put_le32(uint8_t* p, int32_t v) {
+    uint32_t u = (uint32_t)v;
+    p[0] = u & 0xff;
+    p[1] = (u >> 8) & 0xff;
+    p[2] = (u >> 16) & 0xff;
+    p[3] = (u >> 24) & 0xff;
+}
+
+// Tabix metadata: the VCF preset followed by contig names in tabix id order
+static int index_set_tbx_meta(vcf_index_builder_t* b) {
+    size_t l_nm = 0;
+    for (int t = 0; t < b->n_tid; t++) {
+        l_nm += strlen(bcf_hdr_id2name(b->hdr, b->tid2rid[t])) + 1;
+    }
+    uint8_t* meta = (uint8_t*)malloc(28 + l_nm);
+    if (!meta) return -1;
+
+    put_le32(meta, tbx_conf_vcf.preset);
+    put_le32(meta + 4, tbx_conf_vcf.sc);
+    put_le32(meta + 8, tbx_conf_vcf.bc);
+    put_le32(meta + 12, tbx_conf_vcf.ec);
+    put_le32(meta + 16, tbx_conf_vcf.meta_char);
+    put_le32(meta + 20, tbx_conf_vcf.line_skip);
+    put_le32(meta + 24, (int32_t)l_nm);
+    size_t l = 28;
+    for (int t = 0; t < b->n_tid; t++) {
+        const char* name = bcf_hdr_id2name(b->hdr, b->tid2rid[t]);
+        size_t n = strlen(name) + 1;
+        memcpy(meta + l, name, n);
+        l += n;
+    }
+    // The index takes ownership of meta
+    if (hts_idx_set_meta(b->idx, (uint32_t)l, meta, 0) < 0) {
+        free(meta);
+        return -1;
+    }
+    return 0;
+}
+
+// Contigs missing from a VCF header are added while parsing, so the rid
+// space can grow during the read
+static int index_grow_maps(vcf_index_builder_t* b, int n) {
+    if (n <= b->m_rid) return 0;
+    int* rid2tid = (int*)realloc(b->rid2tid, n * sizeof(int));
+    if (!rid2tid) return -1;
+    b->rid2tid = rid2tid;
+    int* tid2rid = (int*)realloc(b->tid2rid, n * sizeof(int));
+    if (!tid2rid) return -1;
+    b->tid2rid = tid2rid;
+    for (int i = b->m_rid; i < n; i++) b->rid2tid[i] = -1;
+    b->m_rid = n;
+    return 0;
+}
+
+vcf_index_builder_t* vcf_index_builder_init(htsFile* fp, const bcf_hdr_t* hdr,
+                                            const char* filename, const char* fnidx,
+                                            char* error_msg, size_t error_len) {
+    const htsFormat* format = hts_get_format(fp);
+    if (format->compression != bgzf ||
+        (format->format != vcf && format->format != bcf)) {
+        snprintf(error_msg, error_len,
+                 "Only bgzip-compressed VCF and BCF files can be indexed");
+        return NULL;
+    }
+
+    vcf_index_builder_t* b = (vcf_index_builder_t*)calloc(1, sizeof(*b));
+    if (!b) {
+        snprintf(error_msg, error_len, "Out of memory");
+        return NULL;
+    }
+    b->bgzf = hts_get_bgzfp(fp);
+    b->hdr = hdr;
+    b->is_vcf = format->format == vcf;
+
+    int64_t max_len = 0;
+    int min_shift = VCF_INDEX_CSI_MIN_SHIFT;
+    int n_lvls = index_n_lvls(hdr, min_shift, &max_len);
+    int n_ids = hdr->n[BCF_DT_CTG];
+
+    if (b->is_vcf) {
+        // Same default as tabix -p vcf, unless a contig is out of TBI range
+        if (max_len <= hts_bin_maxpos(VCF_INDEX_TBI_MIN_SHIFT, VCF_INDEX_TBI_N_LVLS)) {
+            b->fmt = HTS_FMT_TBI;
+            min_shift = VCF_INDEX_TBI_MIN_SHIFT;
+            n_lvls = VCF_INDEX_TBI_N_LVLS;
+        } else {
+            b->fmt = HTS_FMT_CSI;
+        }
+        if (index_grow_maps(b, n_ids > 0 ? n_ids : 1) < 0) goto fail_oom;
+        // Tabix assigns ids on first appearance
+        n_ids = 0;
+    } else {
+        b->fmt = HTS_FMT_CSI;
+    }
+
+    b->fn = strdup(filename);
+    if (!b->fn) goto fail_oom;
+    if (fnidx) {
+        b->fnidx = strdup(fnidx);
+        if (!b->fnidx) goto fail_oom;
+    }
+
+    b->idx = hts_idx_init(n_ids, b->fmt, bgzf_tell(b->bgzf), min_shift, n_lvls);
+    if (!b->idx) goto fail_oom;
+    return b;
+
+fail_oom:
+    snprintf(error_msg, error_len, "Out of memory");
+    vcf_index_builder_destroy(b);
+    return NULL;
+}
+
+int vcf_index_builder_push(vcf_index_builder_t* b, const bcf1_t* rec) {
+    if (b->failed) return -1;
+
+    int tid = rec->rid;
+    if (b->is_vcf) {
+        if (rec->rid < 0 || index_grow_maps(b, rec->rid + 1) < 0) {
+            b->failed = 1;
+            return -1;
+        }
+        tid = b->rid2tid[rec->rid];
+        if (tid < 0) {
+            tid = b->n_tid++;
+            b->rid2tid[rec->rid] = tid;
+            b->tid2rid[tid] = rec->rid;
+        }
+    }
+
+    if (hts_idx_push(b->idx, tid, rec->pos, rec->pos + rec->rlen,
+                     bgzf_tell(b->bgzf), 1) < 0) {
+        b->failed = 1;
+        return -1;
+    }
+    b->n_records++;
+    return 0;
+}
+
+int vcf_index_builder_save(vcf_index_builder_t* b, char* error_msg, size_t error_len) {
+    if (b->failed || hts_idx_finish(b->idx, bgzf_tell(b->bgzf)) < 0) {
+        b->failed = 1;
+        snprintf(error_msg, error_len, "Failed to index %s (is it sorted?)", b->fn);
+        return -1;
+    }
+    if (b->is_vcf && index_set_tbx_meta(b) < 0) {
+        b->failed = 1;
+        snprintf(error_msg, error_len, "Out of memory");
+        return -1;
+    }
+    if (hts_idx_save_as(b->idx, b->fn, b->fnidx, b->fmt) < 0) {
+        b->failed = 1;
+        if (b->fnidx) {
+            snprintf(error_msg, error_len, "Failed to write the index: %s", b->fnidx);
+        } else {
+            snprintf(error_msg, error_len, "Failed to write the index: %s.%s", b->fn,
+                     b->fmt == HTS_FMT_TBI ? "tbi" : "csi");
+        }
+        return -1;
+    }
+    return 0;
+}
+
+int64_t vcf_index_builder_records(const vcf_index_builder_t* b) {
+    return b->n_records;
+}
+
+void vcf_index_builder_destroy(vcf_index_builder_t* b) {
+    if (!b) return;
+    if (b->idx) hts_idx_destroy(b->idx);
+    free(b->rid2tid);
+    free(b->tid2rid);
+    free(b->fn);
+    free(b->fnidx);
+    free(b);
+}
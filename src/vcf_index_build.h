@@ -0,0 +1,81 @@
+// On-the-fly CSI/TBI index building for VCF/BCF readers
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#ifndef VCF_INDEX_BUILD_H
+#define VCF_INDEX_BUILD_H
+
+#include <stdint.h>
+#include "htslib/hts.h"
+#include "htslib/vcf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Minimum bin shift of CSI indexes (the bcftools/tabix default) */
+#define VCF_INDEX_CSI_MIN_SHIFT 14
+
+/**
+ * Index accumulated from the records of a sequential read.
+ *
+ * A reader that decodes every record of a bgzip-compressed file anyway can
+ * push each one here and save an index at EOF, instead of running a second
+ * pass with bcftools index or tabix.
+ */
+typedef struct vcf_index_builder_t vcf_index_builder_t;
+
+/**
+ * @brief Start an index for a file whose header has just been read
+ *
+ * BCF gets a CSI index; bgzipped VCF gets a TBI index (CSI when a contig is
+ * longer than TBI can address) with the tabix VCF metadata, so the result
+ * loads with tbx_index_load() like one written by tabix.
+ *
+ * @param fp Open file, positioned right after the header
+ * @param hdr Header of @p fp (must outlive the builder)
+ * @param filename Path of @p fp
+ * @param fnidx Index path, or NULL for the file name plus .csi/.tbi
+ * @param error_msg Buffer for an error message
+ * @param error_len Size of @p error_msg
+ * @return Builder, or NULL if @p fp is not BGZF-compressed or on allocation failure
+ */
+vcf_index_builder_t* vcf_index_builder_init(htsFile* fp, const bcf_hdr_t* hdr,
+                                            const char* filename, const char* fnidx,
+                                            char* error_msg, size_t error_len);
+
+/**
+ * @brief Add the record just read from the builder's file
+ *
+ * Must be called immediately after each bcf_read(). After a failure (e.g.
+ * unsorted input) further pushes are ignored and nothing will be saved.
+ *
+ * @return 0 on success, -1 once the builder has failed
+ */
+int vcf_index_builder_push(vcf_index_builder_t* b, const bcf1_t* rec);
+
+/**
+ * @brief Finish the index at EOF and write it
+ *
+ * @param b Builder
+ * @param error_msg Buffer for an error message
+ * @param error_len Size of @p error_msg
+ * @return 0 on success, -1 on failure or if a push failed
+ */
+int vcf_index_builder_save(vcf_index_builder_t* b, char* error_msg, size_t error_len);
+
+/**
+ * @brief Records pushed so far
+ */
+int64_t vcf_index_builder_records(const vcf_index_builder_t* b);
+
+/**
+ * @brief Free a builder (NULL is a no-op)
+ */
+void vcf_index_builder_destroy(vcf_index_builder_t* b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_INDEX_BUILD_H
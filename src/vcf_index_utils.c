@@ -5,106 +5,259 @@
 #define R_NO_REMAP
 #include <R.h>
 #include <Rinternals.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "htslib/vcf.h"
 #include "htslib/tbx.h"
 #include "htslib/hts.h"
+#include "vcf_handle.h"
+#include "vcf_memory.h"
+#include "vcf_region_plan.h"
+
+// =============================================================================
+// File Handles
+// =============================================================================
+
+static void vcf_handle_finalize(SEXP handle_sexp) {
+    vcf_handle_close((vcf_handle_t*)R_ExternalPtrAddr(handle_sexp));
+    R_ClearExternalPtr(handle_sexp);
+}
 
 /**
- * Check if a VCF/BCF file has an index
- * Uses htslib's index loading mechanism which handles:
- * - Local and remote files (S3, GCS, HTTP)
- * - ##idx## syntax for custom index paths
- * - Auto-detection of .tbi, .csi indexes
- * 
- * @param filename_sexp Path to VCF/BCF file
- * @param index_sexp Optional explicit index path (or R_NilValue)
- * @return Logical: TRUE if index exists and can be loaded, FALSE otherwise
+ * The handle behind a vcf_handle external pointer
+ * Errors if the object is not a handle or has been closed.
  */
-SEXP RC_vcf_has_index(SEXP filename_sexp, SEXP index_sexp) {
-    if (TYPEOF(filename_sexp) != STRSXP || Rf_length(filename_sexp) != 1) {
-        Rf_error("filename must be a single character string");
+vcf_handle_t* vcf_handle_from_sexp(SEXP handle_sexp) {
+    if (TYPEOF(handle_sexp) != EXTPTRSXP ||
+        R_ExternalPtrTag(handle_sexp) != Rf_install("vcf_handle")) {
+        Rf_error("not a vcf_handle");
+    }
+    vcf_handle_t* h = (vcf_handle_t*)R_ExternalPtrAddr(handle_sexp);
+    if (!h) {
+        Rf_error("vcf_handle is closed");
+    }
+    return h;
+}
+
+/**
+ * Resolve a filename or vcf_handle argument
+ * A filename opens a temporary handle (*owned = 1) that the caller closes
+ * with vcf_source_close(); a vcf_handle is borrowed as is, and index_sexp is
+ * ignored in favour of the index the handle was opened with.
+ */
+static vcf_handle_t* vcf_source_open(SEXP file_sexp, SEXP index_sexp, int* owned) {
+    if (TYPEOF(file_sexp) == EXTPTRSXP) {
+        *owned = 0;
+        return vcf_handle_from_sexp(file_sexp);
+    }
+    if (TYPEOF(file_sexp) != STRSXP || Rf_length(file_sexp) != 1) {
+        Rf_error("filename must be a single character string or a vcf_handle");
     }
     
-    const char* filename = CHAR(STRING_ELT(filename_sexp, 0));
+    const char* filename = CHAR(STRING_ELT(file_sexp, 0));
     const char* index_path = NULL;
-    
     if (!Rf_isNull(index_sexp) && TYPEOF(index_sexp) == STRSXP) {
         index_path = CHAR(STRING_ELT(index_sexp, 0));
     }
     
-    // Try to open the file
-    htsFile* fp = hts_open(filename, "r");
-    if (!fp) {
-        return Rf_ScalarLogical(0);  // File can't be opened
+    int err = 0;
+    vcf_handle_t* h = vcf_handle_open(filename, index_path, &err);
+    if (!h) {
+        if (err == EIO) Rf_error("Failed to read VCF/BCF header");
+        if (err == ENOMEM) Rf_error("Out of memory opening %s", filename);
+        Rf_error("Failed to open VCF/BCF file: %s", filename);
     }
+    *owned = 1;
+    return h;
+}
+
+static void vcf_source_close(vcf_handle_t* h, int owned) {
+    if (owned) vcf_handle_close(h);
+}
+
+/**
+ * Open a persistent handle on a VCF/BCF file
+ * 
+ * @param filename_sexp Path or URL of a VCF/BCF file
+ * @param index_sexp Optional explicit index path (or R_NilValue)
+ * @return External pointer tagged "vcf_handle", closed by its finalizer
+ */
+SEXP RC_vcf_handle_open(SEXP filename_sexp, SEXP index_sexp) {
+    if (TYPEOF(filename_sexp) != STRSXP || Rf_length(filename_sexp) != 1) {
+        Rf_error("filename must be a single character string");
+    }
+    int owned = 0;
+    vcf_handle_t* h = vcf_source_open(filename_sexp, index_sexp, &owned);
     
+    SEXP handle_sexp = PROTECT(R_MakeExternalPtr(h, Rf_install("vcf_handle"), R_NilValue));
+    R_RegisterCFinalizerEx(handle_sexp, vcf_handle_finalize, TRUE);
+    UNPROTECT(1);
+    return handle_sexp;
+}
+
+/**
+ * Close a handle now rather than at garbage collection
+ * 
+ * @param handle_sexp vcf_handle external pointer
+ * @return TRUE if the handle was open
+ */
+SEXP RC_vcf_handle_close(SEXP handle_sexp) {
+    if (TYPEOF(handle_sexp) != EXTPTRSXP) {
+        Rf_error("not a vcf_handle");
+    }
+    int was_open = R_ExternalPtrAddr(handle_sexp) != NULL;
+    vcf_handle_finalize(handle_sexp);
+    return Rf_ScalarLogical(was_open);
+}
+
+// =============================================================================
+// Record Counting
+// =============================================================================
+
+/**
+ * Count the records returned by an index iterator
+ * Records are read but never unpacked (BCF) or parsed (VCF text).
+ * 
+ * @return Record count, or -1 on a read error
+ */
+static int64_t vcf_count_iter(htsFile* fp, tbx_t* tbx, hts_itr_t* itr) {
+    int64_t n = 0;
+    int ret;
+    if (tbx) {
+        kstring_t line = {0, 0, NULL};
+        while ((ret = tbx_itr_next(fp, tbx, itr, &line)) >= 0) n++;
+        free(line.s);
+    } else {
+        bcf1_t* rec = bcf_init();
+        if (!rec) return -1;
+        while ((ret = bcf_itr_next(fp, itr, rec)) >= 0) n++;
+        bcf_destroy(rec);
+    }
+    return ret < -1 ? -1 : n;
+}
+
+/**
+ * Records on one indexed contig: index statistics when present, otherwise
+ * an iterator over the whole contig
+ * 
+ * @return Record count, or -1 on error
+ */
+static int64_t vcf_count_contig(vcf_handle_t* h, int tid) {
+    uint64_t mapped = 0, unmapped = 0;
+    if (hts_idx_get_stat(h->idx, tid, &mapped, &unmapped) == 0) {
+        return (int64_t)mapped;
+    }
+    hts_itr_t* itr = h->tbx ? tbx_itr_queryi(h->tbx, tid, 0, HTS_POS_MAX)
+                            : bcf_itr_queryi(h->idx, tid, 0, HTS_POS_MAX);
+    if (!itr) return 0;  // contig has no records
+    int64_t n = vcf_count_iter(h->fp, h->tbx, itr);
+    hts_itr_destroy(itr);
+    return n;
+}
+
+/**
+ * Count every record of an unindexed file
+ * Reads through a fresh file handle so that a shared handle keeps its
+ * position; BCF records are not unpacked and VCF lines are not parsed.
+ * 
+ * @return Record count, or -1 on error
+ */
+static int64_t vcf_count_scan(const vcf_handle_t* h) {
+    htsFile* fp = hts_open(h->filename, "r");
+    if (!fp) return -1;
     bcf_hdr_t* hdr = bcf_hdr_read(fp);
     if (!hdr) {
         hts_close(fp);
-        return Rf_ScalarLogical(0);
+        return -1;
     }
     
-    
-    // Try to load the index
-    hts_idx_t* idx = NULL;
-    tbx_t* tbx = NULL;
-    
-    // For VCF files, try TBI first (tabix), then CSI
+    int64_t n = 0;
+    int ret = -1;
     if (fp->format.format == vcf) {
-        tbx = tbx_index_load3(filename, index_path, HTS_IDX_SAVE_REMOTE | HTS_IDX_SILENT_FAIL);
-        if (tbx) {
-            idx = tbx->idx;  // TBI found
-        } else {
-            // Try CSI as fallback
-            idx = bcf_index_load3(filename, index_path, HTS_IDX_SAVE_REMOTE | HTS_IDX_SILENT_FAIL);
+        kstring_t line = {0, 0, NULL};
+        while ((ret = hts_getline(fp, '\n', &line)) >= 0) {
+            if (line.l > 0 && line.s[0] != '#') n++;
         }
+        free(line.s);
     } else {
-        // BCF files use CSI only
-        idx = bcf_index_load3(filename, index_path, HTS_IDX_SAVE_REMOTE | HTS_IDX_SILENT_FAIL);
+        bcf1_t* rec = bcf_init();
+        if (rec) {
+            while ((ret = bcf_read(fp, hdr, rec)) >= 0) n++;
+            bcf_destroy(rec);
+        } else {
+            ret = -2;
+        }
     }
     
-    int has_idx = (idx != NULL);
-    
-    // Clean up
-    if (tbx) tbx_destroy(tbx);
-    else if (idx) hts_idx_destroy(idx);
     bcf_hdr_destroy(hdr);
     hts_close(fp);
-    
-    return Rf_ScalarLogical(has_idx);
+    return ret < -1 ? -1 : n;
 }
 
+// =============================================================================
+// R-callable Metadata Functions
+// =============================================================================
+// Each takes a filename or a vcf_handle as its first argument.
+
 /**
- * Get list of contig names from VCF/BCF header
+ * Check if a VCF/BCF file has an index
+ * Uses htslib's index loading mechanism which handles:
+ * - Local and remote files (S3, GCS, HTTP)
+ * - ##idx## syntax for custom index paths
+ * - Auto-detection of .tbi, .csi indexes
  * 
- * @param filename_sexp Path to VCF/BCF file
- * @return Character vector of contig names
+ * @param filename_sexp Path to VCF/BCF file, or a vcf_handle
+ * @param index_sexp Optional explicit index path (or R_NilValue)
+ * @return Logical: TRUE if index exists and can be loaded, FALSE otherwise
  */
-SEXP RC_vcf_get_contigs(SEXP filename_sexp) {
+SEXP RC_vcf_has_index(SEXP filename_sexp, SEXP index_sexp) {
+    if (TYPEOF(filename_sexp) == EXTPTRSXP) {
+        return Rf_ScalarLogical(vcf_handle_index(vcf_handle_from_sexp(filename_sexp)) != NULL);
+    }
     if (TYPEOF(filename_sexp) != STRSXP || Rf_length(filename_sexp) != 1) {
         Rf_error("filename must be a single character string");
     }
     
     const char* filename = CHAR(STRING_ELT(filename_sexp, 0));
+    const char* index_path = NULL;
     
-    htsFile* fp = hts_open(filename, "r");
-    if (!fp) {
-        Rf_error("Failed to open VCF/BCF file: %s", filename);
+    if (!Rf_isNull(index_sexp) && TYPEOF(index_sexp) == STRSXP) {
+        index_path = CHAR(STRING_ELT(index_sexp, 0));
     }
     
-    bcf_hdr_t* hdr = bcf_hdr_read(fp);
-    if (!hdr) {
-        hts_close(fp);
-        Rf_error("Failed to read VCF/BCF header");
+    // A file that can't be opened or has no header has no usable index
+    int err = 0;
+    vcf_handle_t* h = vcf_handle_open(filename, index_path, &err);
+    if (!h) {
+        return Rf_ScalarLogical(0);
     }
     
+    int has_idx = vcf_handle_index(h) != NULL;
+    vcf_handle_close(h);
+    
+    return Rf_ScalarLogical(has_idx);
+}
+
+/**
+ * Get list of contig names from VCF/BCF header
+ * 
+ * @param filename_sexp Path to VCF/BCF file, or a vcf_handle
+ * @return Character vector of contig names
+ */
+SEXP RC_vcf_get_contigs(SEXP filename_sexp) {
+    int owned = 0;
+    vcf_handle_t* h = vcf_source_open(filename_sexp, R_NilValue, &owned);
+    
     // Get number of sequences
     int nseq = 0;
-    const char** seqnames = bcf_hdr_seqnames(hdr, &nseq);
+    const char** seqnames = bcf_hdr_seqnames(h->hdr, &nseq);
     
     if (nseq == 0 || !seqnames) {
-        bcf_hdr_destroy(hdr);
-        hts_close(fp);
+        free(seqnames);
+        vcf_source_close(h, owned);
         return Rf_allocVector(STRSXP, 0);  // Empty vector
     }
     
@@ -116,8 +269,7 @@ SEXP RC_vcf_get_contigs(SEXP filename_sexp) {
     
     // Clean up
     free(seqnames);
-    bcf_hdr_destroy(hdr);
-    hts_close(fp);
+    vcf_source_close(h, owned);
     
     UNPROTECT(1);
     return result;
@@ -126,33 +278,19 @@ SEXP RC_vcf_get_contigs(SEXP filename_sexp) {
 /**
  * Get contig lengths from VCF/BCF header
  * 
- * @param filename_sexp Path to VCF/BCF file
+ * @param filename_sexp Path to VCF/BCF file, or a vcf_handle
  * @return Named integer vector: names are contigs, values are lengths
  */
 SEXP RC_vcf_get_contig_lengths(SEXP filename_sexp) {
-    if (TYPEOF(filename_sexp) != STRSXP || Rf_length(filename_sexp) != 1) {
-        Rf_error("filename must be a single character string");
-    }
-    
-    const char* filename = CHAR(STRING_ELT(filename_sexp, 0));
-    
-    htsFile* fp = hts_open(filename, "r");
-    if (!fp) {
-        Rf_error("Failed to open VCF/BCF file: %s", filename);
-    }
-    
-    bcf_hdr_t* hdr = bcf_hdr_read(fp);
-    if (!hdr) {
-        hts_close(fp);
-        Rf_error("Failed to read VCF/BCF header");
-    }
+    int owned = 0;
+    vcf_handle_t* h = vcf_source_open(filename_sexp, R_NilValue, &owned);
     
     int nseq = 0;
-    const char** seqnames = bcf_hdr_seqnames(hdr, &nseq);
+    const char** seqnames = bcf_hdr_seqnames(h->hdr, &nseq);
     
     if (nseq == 0 || !seqnames) {
-        bcf_hdr_destroy(hdr);
-        hts_close(fp);
+        free(seqnames);
+        vcf_source_close(h, owned);
         return Rf_allocVector(INTSXP, 0);
     }
     
@@ -164,7 +302,7 @@ SEXP RC_vcf_get_contig_lengths(SEXP filename_sexp) {
         SET_STRING_ELT(names, i, Rf_mkChar(seqnames[i]));
         
         // Get sequence length from header
-        int len = bcf_hdr_id2length(hdr, BCF_DT_CTG, i);
+        int len = bcf_hdr_id2length(h->hdr, BCF_DT_CTG, i);
         INTEGER(result)[i] = len;
     }
     
@@ -172,9 +310,304 @@ SEXP RC_vcf_get_contig_lengths(SEXP filename_sexp) {
     
     // Clean up
     free(seqnames);
-    bcf_hdr_destroy(hdr);
-    hts_close(fp);
+    vcf_source_close(h, owned);
+    
+    UNPROTECT(2);
+    return result;
+}
+
+/**
+ * Plan size-balanced regions for a parallel scan
+ * 
+ * @param filename_sexp Path to an indexed VCF/BCF file, or a vcf_handle
+ * @param index_sexp Optional explicit index path (or R_NilValue)
+ * @param threads_sexp Number of workers to plan for
+ * @return List with region, contig, start, end (NA = contig end), bytes
+ *         and records, largest region first
+ */
+SEXP RC_vcf_region_plan(SEXP filename_sexp, SEXP index_sexp, SEXP threads_sexp) {
+    int n_threads = Rf_asInteger(threads_sexp);
+    if (n_threads == NA_INTEGER || n_threads < 1) n_threads = 1;
+    
+    int owned = 0;
+    vcf_handle_t* h = vcf_source_open(filename_sexp, index_sexp, &owned);
+    
+    if (!vcf_handle_index(h)) {
+        SEXP filename = PROTECT(Rf_mkChar(h->filename));
+        vcf_source_close(h, owned);
+        Rf_error("File must be indexed to plan regions: %s", CHAR(filename));
+    }
+    
+    vcf_region_plan_t plan;
+    int ret = vcf_region_plan_build(h->idx, h->tbx, h->hdr, n_threads, &plan);
+    
+    vcf_source_close(h, owned);
+    
+    if (ret != 0) {
+        Rf_error("Failed to plan regions from the index");
+    }
+    
+    int n = plan.n_units;
+    SEXP result = PROTECT(Rf_allocVector(VECSXP, 6));
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, 6));
+    SEXP region = PROTECT(Rf_allocVector(STRSXP, n));
+    SEXP contig = PROTECT(Rf_allocVector(STRSXP, n));
+    SEXP start = PROTECT(Rf_allocVector(REALSXP, n));
+    SEXP end = PROTECT(Rf_allocVector(REALSXP, n));
+    SEXP bytes = PROTECT(Rf_allocVector(REALSXP, n));
+    SEXP records = PROTECT(Rf_allocVector(REALSXP, n));
+    
+    for (int i = 0; i < n; i++) {
+        const vcf_region_unit_t* unit = &plan.units[i];
+        SET_STRING_ELT(region, i, Rf_mkChar(unit->region));
+        SET_STRING_ELT(contig, i, Rf_mkChar(unit->contig));
+        REAL(start)[i] = (double)unit->beg + 1;
+        REAL(end)[i] = unit->end == HTS_POS_MAX ? NA_REAL : (double)unit->end;
+        REAL(bytes)[i] = (double)unit->bytes;
+        REAL(records)[i] = (double)unit->records;
+    }
+    vcf_region_plan_destroy(&plan);
+    
+    SET_VECTOR_ELT(result, 0, region);
+    SET_VECTOR_ELT(result, 1, contig);
+    SET_VECTOR_ELT(result, 2, start);
+    SET_VECTOR_ELT(result, 3, end);
+    SET_VECTOR_ELT(result, 4, bytes);
+    SET_VECTOR_ELT(result, 5, records);
+    SET_STRING_ELT(names, 0, Rf_mkChar("region"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("contig"));
+    SET_STRING_ELT(names, 2, Rf_mkChar("start"));
+    SET_STRING_ELT(names, 3, Rf_mkChar("end"));
+    SET_STRING_ELT(names, 4, Rf_mkChar("bytes"));
+    SET_STRING_ELT(names, 5, Rf_mkChar("records"));
+    Rf_setAttrib(result, R_NamesSymbol, names);
+    
+    UNPROTECT(8);
+    return result;
+}
+
+/**
+ * Per-contig record counts from the index
+ * Uses the record counts stored in TBI/CSI indexes; a contig whose index
+ * lacks them is counted by iterating it. Contigs without records are omitted.
+ * 
+ * @param filename_sexp Path to an indexed VCF/BCF file, or a vcf_handle
+ * @param index_sexp Optional explicit index path (or R_NilValue)
+ * @return Named integer vector of record counts, in index order
+ */
+SEXP RC_vcf_count_per_contig(SEXP filename_sexp, SEXP index_sexp) {
+    int owned = 0;
+    vcf_handle_t* h = vcf_source_open(filename_sexp, index_sexp, &owned);
+    
+    if (!vcf_handle_index(h)) {
+        SEXP filename = PROTECT(Rf_mkChar(h->filename));
+        vcf_source_close(h, owned);
+        Rf_error("File must be indexed to get per-contig counts: %s", CHAR(filename));
+    }
+    
+    // TBI numbers contigs in its own dictionary, CSI by header id
+    int nseq = hts_idx_nseq(h->idx);
+    int n_tbx_names = 0;
+    const char** tbx_names = h->tbx ? tbx_seqnames(h->tbx, &n_tbx_names) : NULL;
+    
+    int64_t* counts = (int64_t*)R_alloc(nseq > 0 ? nseq : 1, sizeof(int64_t));
+    int n_nonzero = 0;
+    int failed = 0;
+    for (int tid = 0; tid < nseq; tid++) {
+        counts[tid] = vcf_count_contig(h, tid);
+        if (counts[tid] < 0) {
+            failed = 1;
+            break;
+        }
+        if (counts[tid] > 0) n_nonzero++;
+    }
+    
+    SEXP result = PROTECT(Rf_allocVector(INTSXP, failed ? 0 : n_nonzero));
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, failed ? 0 : n_nonzero));
+    for (int tid = 0, i = 0; !failed && tid < nseq; tid++) {
+        if (counts[tid] == 0) continue;
+        const char* name = h->tbx ? (tid < n_tbx_names ? tbx_names[tid] : NULL)
+                                  : bcf_hdr_id2name(h->hdr, tid);
+        SET_STRING_ELT(names, i, name ? Rf_mkChar(name) : NA_STRING);
+        INTEGER(result)[i] = counts[tid] > INT_MAX ? NA_INTEGER : (int)counts[tid];
+        i++;
+    }
+    Rf_setAttrib(result, R_NamesSymbol, names);
+    
+    free(tbx_names);
+    
+    if (failed) {
+        SEXP filename = PROTECT(Rf_mkChar(h->filename));
+        vcf_source_close(h, owned);
+        Rf_error("Failed to read records while counting: %s", CHAR(filename));
+    }
     
+    vcf_source_close(h, owned);
     UNPROTECT(2);
     return result;
 }
+
+/**
+ * Count records in a VCF/BCF file or in regions of it
+ * Without regions, an indexed file is counted from its index statistics and
+ * an unindexed file by reading every record (BCF records are not unpacked,
+ * VCF lines are not parsed). Regions are read through a multi-region index
+ * iterator, so a record overlapping several regions is counted once.
+ * 
+ * @param filename_sexp Path to VCF/BCF file, or a vcf_handle
+ * @param regions_sexp Character vector of regions (or R_NilValue)
+ * @param index_sexp Optional explicit index path (or R_NilValue)
+ * @return Record count as a double
+ */
+SEXP RC_vcf_count_records(SEXP filename_sexp, SEXP regions_sexp, SEXP index_sexp) {
+    if (!Rf_isNull(regions_sexp) && TYPEOF(regions_sexp) != STRSXP) {
+        Rf_error("regions must be a character vector or NULL");
+    }
+    int n_regions = Rf_isNull(regions_sexp) ? 0 : Rf_length(regions_sexp);
+    
+    int owned = 0;
+    vcf_handle_t* h = vcf_source_open(filename_sexp, index_sexp, &owned);
+    hts_idx_t* idx = vcf_handle_index(h);
+    
+    int64_t n = 0;
+    const char* error = NULL;
+    
+    if (n_regions > 0) {
+        if (!idx) {
+            error = "File must be indexed to count records in a region";
+        } else if (h->fp->format.format == vcf && !h->tbx) {
+            error = "VCF region counts need a tabix-compatible index";
+        } else {
+            char** regarray = (char**)R_alloc(n_regions, sizeof(char*));
+            for (int i = 0; i < n_regions; i++) {
+                regarray[i] = (char*)CHAR(STRING_ELT(regions_sexp, i));
+            }
+            hts_itr_t* itr = h->tbx ? tbx_itr_regarray(h->tbx, regarray, n_regions)
+                                    : bcf_itr_regarray(idx, h->hdr, regarray, n_regions);
+            if (itr) {
+                n = vcf_count_iter(h->fp, h->tbx, itr);
+                hts_itr_destroy(itr);
+            }
+            // No iterator means none of the regions names a contig in the index
+        }
+    } else if (idx) {
+        int nseq = hts_idx_nseq(idx);
+        for (int tid = 0; tid < nseq && n >= 0; tid++) {
+            int64_t n_tid = vcf_count_contig(h, tid);
+            n = n_tid < 0 ? -1 : n + n_tid;
+        }
+    } else {
+        n = vcf_count_scan(h);
+    }
+    
+    SEXP filename = PROTECT(Rf_mkChar(h->filename));
+    vcf_source_close(h, owned);
+    
+    if (error) {
+        Rf_error("%s: %s", error, CHAR(filename));
+    }
+    if (n < 0) {
+        Rf_error("Failed to read records while counting: %s", CHAR(filename));
+    }
+    
+    UNPROTECT(1);
+    return Rf_ScalarReal((double)n);
+}
+
+/**
+ * Build a CSI or TBI index for a bgzip-compressed VCF/BCF file
+ * Uses bcf_index_build3(), which decompresses with a pool of BGZF threads.
+ * 
+ * @param filename_sexp Path to a local bgzipped VCF or BCF file
+ * @param index_sexp Optional output index path (or R_NilValue)
+ * @param min_shift_sexp CSI minimum bin shift; 0 writes TBI (VCF only)
+ * @param threads_sexp Number of decompression threads
+ * @return Path of the written index
+ */
+SEXP RC_vcf_index(SEXP filename_sexp, SEXP index_sexp, SEXP min_shift_sexp,
+                  SEXP threads_sexp) {
+    if (TYPEOF(filename_sexp) != STRSXP || Rf_length(filename_sexp) != 1) {
+        Rf_error("filename must be a single character string");
+    }
+    
+    const char* filename = CHAR(STRING_ELT(filename_sexp, 0));
+    int min_shift = Rf_asInteger(min_shift_sexp);
+    if (min_shift == NA_INTEGER || min_shift < 0) {
+        Rf_error("min_shift must be a non-negative integer");
+    }
+    int n_threads = Rf_asInteger(threads_sexp);
+    if (n_threads == NA_INTEGER || n_threads < 0) n_threads = 0;
+    
+    const char* fnidx;
+    if (!Rf_isNull(index_sexp) && TYPEOF(index_sexp) == STRSXP) {
+        fnidx = CHAR(STRING_ELT(index_sexp, 0));
+    } else {
+        size_t len = strlen(filename) + 5;
+        char* path = R_alloc(len, 1);
+        snprintf(path, len, "%s.%s", filename, min_shift > 0 ? "csi" : "tbi");
+        fnidx = path;
+    }
+    
+    int ret = bcf_index_build3(filename, fnidx, min_shift, n_threads);
+    switch (ret) {
+        case 0:
+            break;
+        case -2:
+            Rf_error("Failed to open VCF/BCF file: %s", filename);
+        case -3:
+            Rf_error("Only bgzip-compressed VCF and BCF files can be indexed: %s", filename);
+        case -4:
+            Rf_error("Failed to write the index: %s", fnidx);
+        default:
+            Rf_error("Failed to index %s%s", filename,
+                     min_shift == 0 ? " (TBI needs a sorted bgzipped VCF)" : " (is it sorted?)");
+    }
+    
+    return Rf_mkString(fnidx);
+}
+
+// =============================================================================
+// Memory
+// =============================================================================
+
+/**
+ * Resident and peak resident memory of the R process
+ * 
+ * @param reset_sexp TRUE to reset the peak to the current RSS first, so the
+ *        next call reports the peak of whatever ran in between
+ * @return Named numeric: rss and peak_rss in bytes (NA if unknown), and
+ *         peak_reset (1 if the peak was reset, 0 otherwise)
+ */
+SEXP RC_vcf_memory_usage(SEXP reset_sexp) {
+    int reset = Rf_asLogical(reset_sexp) == TRUE && vcf_memory_reset_peak() == 0;
+    int64_t rss = vcf_memory_rss();
+    int64_t peak = vcf_memory_peak_rss();
+    
+    SEXP result = PROTECT(Rf_allocVector(REALSXP, 3));
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, 3));
+    REAL(result)[0] = rss < 0 ? NA_REAL : (double)rss;
+    REAL(result)[1] = peak < 0 ? NA_REAL : (double)peak;
+    REAL(result)[2] = reset;
+    SET_STRING_ELT(names, 0, Rf_mkChar("rss"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("peak_rss"));
+    SET_STRING_ELT(names, 2, Rf_mkChar("peak_reset"));
+    Rf_setAttrib(result, R_NamesSymbol, names);
+    UNPROTECT(2);
+    return result;
+}
+
+/**
+ * Estimated in-memory bytes per output row, from the header
+ * 
+ * @param file_sexp Filename or vcf_handle
+ * @param index_sexp Optional explicit index path (ignored for handles)
+ * @param tidy_sexp TRUE for one row per variant and sample
+ * @return Bytes per row (numeric)
+ */
+SEXP RC_vcf_row_bytes(SEXP file_sexp, SEXP index_sexp, SEXP tidy_sexp) {
+    int owned = 0;
+    vcf_handle_t* h = vcf_source_open(file_sexp, index_sexp, &owned);
+    int64_t bytes = vcf_memory_row_bytes(h->hdr, Rf_asLogical(tidy_sexp) == TRUE);
+    vcf_source_close(h, owned);
+    return Rf_ScalarReal((double)bytes);
+}
@@ -0,0 +1,144 @@
+// Process memory probes and Arrow row size estimates
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+// =============================================================================
+// Process memory
+// =============================================================================
+
+#ifdef __linux__
+// A "VmXXX:   1234 kB" line of /proc/self/status
+static int64_t proc_status_kb(const char* key) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f) return -1;
+    char line[256];
+    size_t len = strlen(key);
+    int64_t kb = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, len) == 0 && line[len] == ':') {
+            kb = strtoll(line + len + 1, NULL, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return kb;
+}
+#endif
+
+int64_t vcf_memory_rss(void) {
+#if defined(__linux__)
+    int64_t kb = proc_status_kb("VmRSS");
+    return kb < 0 ? -1 : kb * 1024;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return -1;
+    }
+    return (int64_t)info.resident_size;
+#else
+    return -1;
+#endif
+}
+
+int64_t vcf_memory_peak_rss(void) {
+#ifdef __linux__
+    int64_t kb = proc_status_kb("VmHWM");
+    if (kb >= 0) return kb * 1024;
+#endif
+#ifndef _WIN32
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#ifdef __APPLE__
+    return (int64_t)ru.ru_maxrss;          // bytes
+#else
+    return (int64_t)ru.ru_maxrss * 1024;   // kilobytes
+#endif
+#else
+    return -1;
+#endif
+}
+
+int vcf_memory_reset_peak(void) {
+#ifdef __linux__
+    // "5" resets VmHWM to the current RSS (Linux 4.0+)
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (!f) return -1;
+    int ok = fputs("5", f) >= 0;
+    if (fclose(f) != 0) ok = 0;
+    return ok ? 0 : -1;
+#else
+    return -1;
+#endif
+}
+
+// =============================================================================
+// Row size estimate
+// =============================================================================
+
+// Column value sizes, as DuckDB vectors hold them (16-byte strings and list
+// entries); Arrow buffers are smaller, so this errs on the safe side
+#define ROW_FIXED_BYTES 8
+#define ROW_STRING_BYTES 24   // Inline string plus a short payload
+#define ROW_LIST_BYTES 16
+
+// Typical number of values of a field, for sizing lists
+static int field_typical_count(const bcf_hdr_t* hdr, int hl, int id) {
+    switch (bcf_hdr_id2length(hdr, hl, id)) {
+    case BCF_VL_FIXED: {
+        int n = bcf_hdr_id2number(hdr, hl, id);
+        return n > 0 ? n : 1;
+    }
+    case BCF_VL_A: return 1;
+    case BCF_VL_R: return 2;
+    case BCF_VL_G: return 3;
+    default:       return 2;
+    }
+}
+
+static int64_t field_bytes(const bcf_hdr_t* hdr, int hl, int id) {
+    int type = bcf_hdr_id2type(hdr, hl, id);
+    if (type == BCF_HT_FLAG) return 1;
+    int64_t value = type == BCF_HT_STR ? ROW_STRING_BYTES : ROW_FIXED_BYTES;
+
+    // GT is a single string; other multi-valued fields are lists
+    int fixed_one = bcf_hdr_id2length(hdr, hl, id) == BCF_VL_FIXED &&
+                    bcf_hdr_id2number(hdr, hl, id) == 1;
+    if (fixed_one || (hl == BCF_HL_FMT && strcmp(hdr->id[BCF_DT_ID][id].key, "GT") == 0)) {
+        return value;
+    }
+    return ROW_LIST_BYTES + value * field_typical_count(hdr, hl, id);
+}
+
+int64_t vcf_memory_row_bytes(const bcf_hdr_t* hdr, int tidy) {
+    // CHROM, ID, REF strings; POS, QUAL; ALT and FILTER lists
+    int64_t core = 3 * ROW_STRING_BYTES + 2 * ROW_FIXED_BYTES +
+                   2 * (ROW_LIST_BYTES + ROW_STRING_BYTES);
+    int64_t info = 0, format = 0;
+
+    for (int i = 0; i < hdr->n[BCF_DT_ID]; i++) {
+        const bcf_idinfo_t* val = hdr->id[BCF_DT_ID][i].val;
+        if (!val) continue;
+        if (val->hrec[BCF_HL_INFO]) info += field_bytes(hdr, BCF_HL_INFO, i);
+        if (val->hrec[BCF_HL_FMT]) format += field_bytes(hdr, BCF_HL_FMT, i);
+    }
+
+    int n_samples = bcf_hdr_nsamples(hdr);
+    if (n_samples == 0) return core + info;
+    if (tidy) return core + info + ROW_STRING_BYTES + format;
+    return core + info + (int64_t)n_samples * format;
+}
@@ -0,0 +1,61 @@
+// Process memory probes and Arrow row size estimates
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#ifndef VCF_MEMORY_H
+#define VCF_MEMORY_H
+
+#include <stdint.h>
+#include "htslib/vcf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Resident set size of the current process
+ *
+ * @return Bytes, or -1 where the platform offers no cheap probe
+ */
+int64_t vcf_memory_rss(void);
+
+/**
+ * @brief Peak resident set size of the current process
+ *
+ * Since the last successful vcf_memory_reset_peak(), or since the process
+ * started.
+ *
+ * @return Bytes, or -1 if unknown
+ */
+int64_t vcf_memory_peak_rss(void);
+
+/**
+ * @brief Reset the peak RSS to the current RSS
+ *
+ * Lets a caller measure the peak of one stage of a pipeline rather than of
+ * the whole process. Only Linux supports this (/proc/self/clear_refs).
+ *
+ * @return 0 on success, -1 if the peak cannot be reset
+ */
+int vcf_memory_reset_peak(void);
+
+/**
+ * @brief Estimate the in-memory size of one output row
+ *
+ * A rough upper estimate of the bytes an Arrow batch or DuckDB vector needs
+ * per row, from the header alone: core columns, every INFO field and, per
+ * sample, every FORMAT field. Variable-length values are sized at a typical
+ * count (Number=A one value, R two, G three). Used to size batches and
+ * threads to a memory budget before reading anything.
+ *
+ * @param hdr Header
+ * @param tidy Nonzero for one row per variant and sample
+ * @return Estimated bytes per row
+ */
+int64_t vcf_memory_row_bytes(const bcf_hdr_t* hdr, int tidy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_MEMORY_H
@@ -0,0 +1,92 @@
+// Batched multi-region queries for VCF/BCF readers
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#ifndef VCF_REGION_BATCH_H
+#define VCF_REGION_BATCH_H
+
+#include <stdint.h>
+#include "htslib/hts.h"
+#include "htslib/tbx.h"
+#include "htslib/vcf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A set of regions read through a single multi-region iterator.
+ *
+ * Querying regions one by one starts a fresh iterator per region, and
+ * regions sharing BGZF blocks (neighbouring genes, overlapping windows)
+ * decompress those blocks again each time. A batch hands all regions to
+ * htslib at once: they are sorted and merged, the index chunks are unioned,
+ * and every block is decompressed once. Each record read is then matched
+ * back to every input region it overlaps, so a reader can emit it once per
+ * region, tagged with the region's id.
+ */
+typedef struct vcf_region_batch_t vcf_region_batch_t;
+
+/**
+ * @brief Parse regions against a header
+ *
+ * @param hdr Header of the file to query (contig names)
+ * @param regions Region strings ("chr1", "chr1:1000-2000", ...)
+ * @param n_regions Number of regions; ids are their 1-based positions
+ * @param error_msg Buffer for an error message
+ * @param error_len Size of @p error_msg
+ * @return Batch, or NULL if a region does not parse or names a contig
+ *         missing from the header, or on allocation failure
+ */
+vcf_region_batch_t* vcf_region_batch_init(const bcf_hdr_t* hdr,
+                                          const char* const* regions, int n_regions,
+                                          char* error_msg, size_t error_len);
+
+/**
+ * @brief Multi-region iterator over the union of the batch's regions
+ *
+ * Records overlapping several regions are returned once; use
+ * vcf_region_batch_match() to fan them out. Read with bcf_itr_next() or
+ * tbx_itr_next(), which handle multi-region iterators.
+ *
+ * @param b Batch
+ * @param idx Loaded index
+ * @param tbx Tabix wrapper around @p idx, or NULL for CSI
+ * @param hdr Header (CSI contig names)
+ * @return Iterator (free with hts_itr_destroy()), or NULL on failure
+ */
+hts_itr_t* vcf_region_batch_itr(const vcf_region_batch_t* b, const hts_idx_t* idx,
+                                tbx_t* tbx, bcf_hdr_t* hdr);
+
+/**
+ * @brief Find the regions a record overlaps
+ *
+ * Records from merged chunks can fall between regions, in which case there
+ * is no match and the record should be dropped.
+ *
+ * @return Number of overlapping regions; their ids are read with
+ *         vcf_region_batch_hit() until the next call
+ */
+int vcf_region_batch_match(vcf_region_batch_t* b, const bcf1_t* rec);
+
+/**
+ * @brief Id (1-based input position) of the i-th region matched by the last
+ *        vcf_region_batch_match(), in increasing order
+ */
+int32_t vcf_region_batch_hit(const vcf_region_batch_t* b, int i);
+
+/**
+ * @brief Number of regions in the batch
+ */
+int vcf_region_batch_size(const vcf_region_batch_t* b);
+
+/**
+ * @brief Free a batch (NULL is a no-op)
+ */
+void vcf_region_batch_destroy(vcf_region_batch_t* b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_REGION_BATCH_H
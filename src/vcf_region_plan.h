@@ -0,0 +1,75 @@
+// Size-balanced region planning for parallel VCF/BCF scans
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#ifndef VCF_REGION_PLAN_H
+#define VCF_REGION_PLAN_H
+
+#include <stdint.h>
+#include "htslib/hts.h"
+#include "htslib/tbx.h"
+#include "htslib/vcf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Units planned per worker when splitting large contigs */
+#define VCF_PLAN_UNITS_PER_THREAD 4
+
+/** Contigs are never split into pieces smaller than this (compressed bytes) */
+#ifndef VCF_PLAN_MIN_SPLIT_BYTES
+#define VCF_PLAN_MIN_SPLIT_BYTES (4 << 20)
+#endif
+
+/**
+ * One unit of work: a whole contig or a window of one.
+ *
+ * Windows are start-owned: a reader of [beg, end) must skip records with
+ * POS < beg so that records spanning a window boundary are returned once.
+ */
+typedef struct {
+    char* contig;        // Contig name (owned)
+    char* region;        // Region string for *_itr_querys (owned)
+    hts_pos_t beg;       // 0-based start
+    hts_pos_t end;       // 0-based exclusive end, HTS_POS_MAX for contig end
+    uint64_t bytes;      // Estimated compressed bytes from index chunk offsets
+    uint64_t records;    // Records from index stats (pro-rated for windows)
+} vcf_region_unit_t;
+
+typedef struct {
+    vcf_region_unit_t* units;  // Largest first
+    int n_units;
+    uint64_t total_bytes;
+} vcf_region_plan_t;
+
+/**
+ * @brief Plan a largest-first (LPT) schedule over the indexed contigs
+ *
+ * Estimates each contig's compressed size from the CSI/TBI chunk offsets
+ * and skips contigs without indexed records. Contigs larger than
+ * total / (n_threads * VCF_PLAN_UNITS_PER_THREAD) (and at least
+ * VCF_PLAN_MIN_SPLIT_BYTES) are split into windows of about that size, with
+ * boundaries found by bisection on the index. Units are sorted by size,
+ * largest first, ties broken by header order.
+ *
+ * @param idx Loaded index
+ * @param tbx Tabix wrapper around @p idx, or NULL for CSI
+ * @param hdr VCF header (contig names for CSI, contig lengths)
+ * @param n_threads Number of workers the plan is for; 1 disables splitting
+ * @param plan Output plan, free with vcf_region_plan_destroy()
+ * @return 0 on success, ENOMEM on allocation failure
+ */
+int vcf_region_plan_build(const hts_idx_t* idx, tbx_t* tbx, const bcf_hdr_t* hdr,
+                          int n_threads, vcf_region_plan_t* plan);
+
+/**
+ * @brief Free the units of a plan
+ */
+void vcf_region_plan_destroy(vcf_region_plan_t* plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_REGION_PLAN_H
@@ -0,0 +1,856 @@
+// Polygenic scores over indexed VCF/BCF files
+// The dosage computation and effect allele matching follow the bcftools
+// +score plugin (plugins/score.c, MIT, Giulio Genovese); records are read
+// directly with htslib on a pool of workers over index regions, each summing
+// into its own arrays.
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_score.h"
+#include "vcf_region_plan.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "htslib/khash.h"
+#include "htslib/kstring.h"
+#include "htslib/tbx.h"
+
+// webR/Emscripten builds have no pthreads; regions are then read sequentially
+#ifndef __EMSCRIPTEN__
+#define VCF_SCORE_USE_THREADS 1
+#include <pthread.h>
+#endif
+
+KHASH_MAP_INIT_INT64(score_pos, int64_t)
+KHASH_MAP_INIT_STR(score_id, int64_t)
+
+// =============================================================================
+// Types
+// =============================================================================
+
+typedef struct {
+    const vcf_score_options_t* opts;
+    const char* filename;
+    const char* index;
+    int use_tag;
+    int n_samples;
+
+    // Marker lookup: first marker of each key, then a chain through next[]
+    khash_t(score_pos)* by_pos;
+    khash_t(score_id)* by_id;
+    int64_t* next;
+    uint8_t* contig_has_markers;     // Per header contig (position matching)
+    int n_contigs;
+
+    // Regions, claimed in order by the workers
+    hts_idx_t* idx;
+    tbx_t* tbx;
+    int owns_index;
+    char** regions;
+    int n_regions;
+    int next_region;
+    int stop;
+#ifdef VCF_SCORE_USE_THREADS
+    pthread_mutex_t lock;
+#endif
+} score_ctx_t;
+
+typedef struct {
+    score_ctx_t* ctx;
+    htsFile* fp;
+    bcf_hdr_t* hdr;
+    bcf1_t* rec;
+    kstring_t kstr;
+
+    // FORMAT buffers, reused across records
+    int32_t* int32_arr;
+    int m_int32;
+    float* float_arr;
+    int m_float;
+    float* aps;                      // Dosage of each allele per sample
+    int m_aps;
+    uint8_t* missing;
+
+    int64_t* matched;                // Matched (marker, allele) pairs of a record
+    int* matched_allele;
+    int m_matched;
+
+    // Per-worker accumulators, summed at the end
+    double* scores;
+    int32_t* counts;
+    int64_t* n_matched;
+    int64_t n_records;
+
+    int failed;
+    char error[512];
+} score_worker_t;
+
+static inline int score_is_missing(float f) {
+    return isnan(f) || bcf_float_is_missing(f) || bcf_float_is_vector_end(f);
+}
+
+static inline int64_t score_pos_key(int rid, hts_pos_t pos) {
+    return (((int64_t)rid) << 44) + pos;
+}
+
+static void score_error(char* err, size_t len, const char* fmt, ...) {
+    if (!err || len == 0) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(err, len, fmt, ap);
+    va_end(ap);
+}
+
+// =============================================================================
+// Options
+// =============================================================================
+
+void vcf_score_options_init(vcf_score_options_t* opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->use_tag = VCF_SCORE_AUTO;
+    opts->threads = 1;
+}
+
+const char* vcf_score_tag_name(int tag) {
+    switch (tag) {
+    case VCF_SCORE_GT: return "GT";
+    case VCF_SCORE_DS: return "DS";
+    case VCF_SCORE_HDS: return "HDS";
+    case VCF_SCORE_AP: return "AP";
+    case VCF_SCORE_GP: return "GP";
+    case VCF_SCORE_AS: return "AS";
+    default: return NULL;
+    }
+}
+
+static int score_has_format(const bcf_hdr_t* hdr, const char* tag) {
+    int id = bcf_hdr_id2int(hdr, BCF_DT_ID, tag);
+    return bcf_hdr_idinfo_exists(hdr, BCF_HL_FMT, id);
+}
+
+/**
+ * The FORMAT field to use: the requested one if present, otherwise the
+ * first of DS, GP, AP1/AP2, HDS, GT found (the order of bcftools +score)
+ */
+static int score_resolve_tag(const bcf_hdr_t* hdr, int tag) {
+    int has_ap = score_has_format(hdr, "AP1") && score_has_format(hdr, "AP2");
+    switch (tag) {
+    case VCF_SCORE_AUTO:
+        if (score_has_format(hdr, "DS")) return VCF_SCORE_DS;
+        if (score_has_format(hdr, "GP")) return VCF_SCORE_GP;
+        if (has_ap) return VCF_SCORE_AP;
+        if (score_has_format(hdr, "HDS")) return VCF_SCORE_HDS;
+        if (score_has_format(hdr, "GT")) return VCF_SCORE_GT;
+        return -1;
+    case VCF_SCORE_AP:
+        return has_ap ? tag : -1;
+    default:
+        return vcf_score_tag_name(tag) && score_has_format(hdr, vcf_score_tag_name(tag)) ? tag : -1;
+    }
+}
+
+// =============================================================================
+// Marker lookup
+// =============================================================================
+
+static int score_build_lookup(score_ctx_t* ctx, const bcf_hdr_t* hdr) {
+    const vcf_score_options_t* opts = ctx->opts;
+    int by_id = opts->id != NULL;
+
+    ctx->next = (int64_t*)malloc((opts->n_markers > 0 ? opts->n_markers : 1) * sizeof(int64_t));
+    if (!ctx->next) return ENOMEM;
+    if (by_id) {
+        ctx->by_id = kh_init(score_id);
+        if (!ctx->by_id) return ENOMEM;
+    } else {
+        ctx->by_pos = kh_init(score_pos);
+        ctx->n_contigs = hdr->n[BCF_DT_CTG];
+        ctx->contig_has_markers = (uint8_t*)calloc(ctx->n_contigs > 0 ? ctx->n_contigs : 1, 1);
+        if (!ctx->by_pos || !ctx->contig_has_markers) return ENOMEM;
+    }
+
+    // Markers are chained in reverse, so walk backwards to keep input order
+    for (int64_t m = opts->n_markers - 1; m >= 0; m--) {
+        ctx->next[m] = -1;
+        if (!opts->effect_allele[m] || !opts->effect_allele[m][0]) continue;
+
+        int absent;
+        khint_t k;
+        if (by_id) {
+            if (!opts->id[m] || !opts->id[m][0] || strcmp(opts->id[m], ".") == 0) continue;
+            k = kh_put(score_id, ctx->by_id, opts->id[m], &absent);
+            if (absent < 0) return ENOMEM;
+            ctx->next[m] = absent ? -1 : kh_val(ctx->by_id, k);
+            kh_val(ctx->by_id, k) = m;
+        } else {
+            if (!opts->chrom[m] || opts->pos[m] < 1) continue;
+            int rid = bcf_hdr_name2id(hdr, opts->chrom[m]);
+            if (rid < 0) continue;  // Contig not in this file: never matched
+            ctx->contig_has_markers[rid] = 1;
+            k = kh_put(score_pos, ctx->by_pos, score_pos_key(rid, opts->pos[m] - 1), &absent);
+            if (absent < 0) return ENOMEM;
+            ctx->next[m] = absent ? -1 : kh_val(ctx->by_pos, k);
+            kh_val(ctx->by_pos, k) = m;
+        }
+    }
+    return 0;
+}
+
+static int64_t score_first_marker(const score_ctx_t* ctx, const bcf1_t* rec) {
+    khint_t k;
+    if (ctx->by_id) {
+        if (!rec->d.id || strcmp(rec->d.id, ".") == 0) return -1;
+        k = kh_get(score_id, ctx->by_id, rec->d.id);
+        return k == kh_end(ctx->by_id) ? -1 : kh_val(ctx->by_id, k);
+    }
+    // Contigs missing from the header (added while parsing VCF) have no markers
+    if (rec->rid < 0 || rec->rid >= ctx->n_contigs || !ctx->contig_has_markers[rec->rid]) return -1;
+    k = kh_get(score_pos, ctx->by_pos, score_pos_key(rec->rid, rec->pos));
+    return k == kh_end(ctx->by_pos) ? -1 : kh_val(ctx->by_pos, k);
+}
+
+// =============================================================================
+// Dosages
+// =============================================================================
+
+/**
+ * Fill w->aps with the dosage of every allele for every sample (allele a of
+ * sample k at aps[a * n + k]) and w->missing, as bcftools +score does.
+ * Returns 0, or -1 when the record has no value for the tag.
+ */
+static int score_dosages(score_worker_t* w, bcf1_t* rec) {
+    const bcf_hdr_t* hdr = w->hdr;
+    int n = w->ctx->n_samples;
+    int n_allele = rec->n_allele;
+    int number;
+
+    if (n_allele * n > w->m_aps) {
+        float* aps = (float*)realloc(w->aps, (size_t)n_allele * n * sizeof(float));
+        if (!aps) return -2;
+        w->aps = aps;
+        w->m_aps = n_allele * n;
+    }
+    float* aps = w->aps;
+    uint8_t* missing = w->missing;
+    memset(aps, 0, (size_t)n_allele * n * sizeof(float));
+    memset(missing, 0, n);
+
+    switch (w->ctx->use_tag) {
+    case VCF_SCORE_GT:
+        number = bcf_get_genotypes(hdr, rec, &w->int32_arr, &w->m_int32);
+        if (number <= 0) return -1;
+        number /= n;
+        // Any ploidy; a missing allele makes the genotype missing
+        for (int k = 0; k < n; k++) {
+            int32_t* ptr = w->int32_arr + (size_t)number * k;
+            for (int j = 0; j < number && ptr[j] != bcf_int32_vector_end; j++) {
+                if (bcf_gt_is_missing(ptr[j])) {
+                    missing[k] = 1;
+                    break;
+                }
+            }
+            if (missing[k]) continue;
+            for (int j = 0; j < number && ptr[j] != bcf_int32_vector_end; j++) {
+                int allele = bcf_gt_allele(ptr[j]);
+                if (allele >= 0 && allele < n_allele) aps[(size_t)allele * n + k]++;
+            }
+        }
+        return 0;
+
+    case VCF_SCORE_DS:
+        number = bcf_get_format_float(hdr, rec, "DS", &w->float_arr, &w->m_float);
+        if (number <= 0) return -1;
+        number /= n;
+        if (number != n_allele - 1) return -1;
+        for (int k = 0; k < n; k++) {
+            float* ptr = w->float_arr + (size_t)number * k;
+            aps[k] += 2.0f;
+            for (int a = 0; a < number; a++) {
+                if (score_is_missing(ptr[a])) {
+                    missing[k] = 1;
+                } else {
+                    aps[k] -= ptr[a];
+                    aps[(size_t)(a + 1) * n + k] += ptr[a];
+                }
+            }
+        }
+        return 0;
+
+    case VCF_SCORE_HDS:  // Minimac4, biallelic
+        number = bcf_get_format_float(hdr, rec, "HDS", &w->float_arr, &w->m_float);
+        if (number <= 0) return -1;
+        number /= n;
+        if (n_allele != 2 || number < 1 || number > 2) return -1;
+        for (int k = 0; k < n; k++) {
+            float* ptr = w->float_arr + (size_t)number * k;
+            float ds = 0.0f;
+            int ploidy = 0;
+            for (int j = 0; j < number && !bcf_float_is_vector_end(ptr[j]); j++) {
+                if (score_is_missing(ptr[j])) missing[k] = 1;
+                ds += ptr[j];
+                ploidy++;
+            }
+            if (missing[k] || ploidy == 0) {
+                missing[k] = 1;
+                continue;
+            }
+            aps[k] += (float)ploidy - ds;
+            aps[n + k] += ds;
+        }
+        return 0;
+
+    case VCF_SCORE_AP: {
+        const char* ap_tags[] = {"AP1", "AP2"};
+        int found = 0;
+        for (int h = 0; h < 2; h++) {
+            number = bcf_get_format_float(hdr, rec, ap_tags[h], &w->float_arr, &w->m_float);
+            if (number <= 0) continue;
+            number /= n;
+            if (number != n_allele - 1) continue;
+            found = 1;
+            for (int k = 0; k < n; k++) {
+                float* ptr = w->float_arr + (size_t)number * k;
+                aps[k] += 1.0f;
+                for (int a = 0; a < number; a++) {
+                    if (score_is_missing(ptr[a])) {
+                        missing[k] = 1;
+                    } else {
+                        aps[k] -= ptr[a];
+                        aps[(size_t)(a + 1) * n + k] += ptr[a];
+                    }
+                }
+            }
+        }
+        return found ? 0 : -1;
+    }
+
+    case VCF_SCORE_GP:
+        number = bcf_get_format_float(hdr, rec, "GP", &w->float_arr, &w->m_float);
+        if (number <= 0) return -1;
+        number /= n;
+        if (number != n_allele * (n_allele + 1) / 2) return -1;
+        for (int k = 0; k < n; k++) {
+            float* ptr = w->float_arr + (size_t)number * k;
+            // Diploid ordering of the VCF specification: genotype a/b (a <= b)
+            // at b(b+1)/2 + a
+            for (int b = 0; b < n_allele; b++) {
+                for (int a = 0; a <= b; a++) {
+                    float p = ptr[b * (b + 1) / 2 + a];
+                    if (score_is_missing(p)) {
+                        missing[k] = 1;
+                    } else {
+                        aps[(size_t)a * n + k] += p;
+                        aps[(size_t)b * n + k] += p;
+                    }
+                }
+            }
+        }
+        return 0;
+
+    case VCF_SCORE_AS:
+        number = bcf_get_format_int32(hdr, rec, "AS", &w->int32_arr, &w->m_int32);
+        if (number <= 0) return -1;
+        number /= n;
+        if (number != 1 || n_allele != 2) return -1;
+        for (int k = 0; k < n; k++) {
+            int32_t as = w->int32_arr[k];
+            if (as == 0 || as == bcf_int32_missing) {
+                missing[k] = 1;
+            } else {
+                aps[k] -= (float)as;
+                aps[n + k] += (float)as;
+            }
+        }
+        return 0;
+    }
+    return -1;
+}
+
+// =============================================================================
+// Records
+// =============================================================================
+
+static int score_record(score_worker_t* w, bcf1_t* rec) {
+    score_ctx_t* ctx = w->ctx;
+    const vcf_score_options_t* opts = ctx->opts;
+
+    w->n_records++;
+    if (bcf_unpack(rec, BCF_UN_STR) < 0) return -1;
+
+    int64_t m = score_first_marker(ctx, rec);
+    if (m < 0) return 0;
+
+    // Markers at this site whose effect allele is one of the record's
+    int n_matched = 0;
+    for (; m >= 0; m = ctx->next[m]) {
+        int a;
+        for (a = 0; a < rec->n_allele; a++) {
+            if (strcasecmp(opts->effect_allele[m], rec->d.allele[a]) == 0) break;
+        }
+        if (a == rec->n_allele) continue;
+        if (n_matched == w->m_matched) {
+            int cap = w->m_matched ? 2 * w->m_matched : 4;
+            int64_t* markers = (int64_t*)realloc(w->matched, cap * sizeof(int64_t));
+            if (markers) w->matched = markers;
+            int* alleles = (int*)realloc(w->matched_allele, cap * sizeof(int));
+            if (alleles) w->matched_allele = alleles;
+            if (!markers || !alleles) return -2;
+            w->m_matched = cap;
+        }
+        w->matched[n_matched] = m;
+        w->matched_allele[n_matched] = a;
+        n_matched++;
+    }
+    if (n_matched == 0) return 0;
+
+    // Only matched records get their FORMAT fields decoded
+    int ret = score_dosages(w, rec);
+    if (ret == -1) return 0;
+    if (ret < 0) return ret;
+
+    int n = ctx->n_samples;
+    for (int i = 0; i < n_matched; i++) {
+        const float* dosage = w->aps + (size_t)w->matched_allele[i] * n;
+        for (int s = 0; s < opts->n_scores; s++) {
+            double weight = opts->weights[(size_t)s * opts->n_markers + w->matched[i]];
+            if (isnan(weight)) continue;
+            w->n_matched[s]++;
+            double* scores = w->scores + (size_t)s * n;
+            int32_t* counts = w->counts + (size_t)s * n;
+            for (int k = 0; k < n; k++) {
+                if (w->missing[k]) continue;
+                scores[k] += weight * dosage[k];
+                counts[k]++;
+            }
+        }
+    }
+    return 0;
+}
+
+// =============================================================================
+// Workers
+// =============================================================================
+
+static int score_worker_init(score_worker_t* w, score_ctx_t* ctx) {
+    memset(w, 0, sizeof(*w));
+    w->ctx = ctx;
+    int n = ctx->n_samples, n_scores = ctx->opts->n_scores;
+
+    w->fp = hts_open(ctx->filename, "r");
+    if (!w->fp) {
+        snprintf(w->error, sizeof(w->error), "Failed to open file: %s", ctx->filename);
+        return ENOENT;
+    }
+    // Each worker parses against its own header, subset like the main one
+    w->hdr = bcf_hdr_read(w->fp);
+    if (!w->hdr) {
+        snprintf(w->error, sizeof(w->error), "Failed to read VCF/BCF header");
+        return EIO;
+    }
+    if (ctx->opts->samples && bcf_hdr_set_samples(w->hdr, ctx->opts->samples, 0) != 0) {
+        snprintf(w->error, sizeof(w->error), "Failed to set samples filter");
+        return EINVAL;
+    }
+    w->rec = bcf_init();
+    w->missing = (uint8_t*)calloc(n > 0 ? n : 1, 1);
+    w->scores = (double*)calloc((size_t)n * n_scores + 1, sizeof(double));
+    w->counts = (int32_t*)calloc((size_t)n * n_scores + 1, sizeof(int32_t));
+    w->n_matched = (int64_t*)calloc(n_scores + 1, sizeof(int64_t));
+    if (!w->rec || !w->missing || !w->scores || !w->counts || !w->n_matched) {
+        snprintf(w->error, sizeof(w->error), "Out of memory");
+        return ENOMEM;
+    }
+    return 0;
+}
+
+static void score_worker_destroy(score_worker_t* w) {
+    if (w->rec) bcf_destroy(w->rec);
+    if (w->hdr) bcf_hdr_destroy(w->hdr);
+    if (w->fp) hts_close(w->fp);
+    free(w->kstr.s);
+    free(w->int32_arr);
+    free(w->float_arr);
+    free(w->aps);
+    free(w->missing);
+    free(w->matched);
+    free(w->matched_allele);
+    free(w->scores);
+    free(w->counts);
+    free(w->n_matched);
+    memset(w, 0, sizeof(*w));
+}
+
+static int score_check_record(score_worker_t* w, int ret, int rec_ret, const char* where) {
+    if (rec_ret == -2) {
+        snprintf(w->error, sizeof(w->error), "Out of memory");
+        return ENOMEM;
+    }
+    if (rec_ret < 0 || ret < -1) {
+        snprintf(w->error, sizeof(w->error), "Failed to read a record%s%s",
+                 where ? " in " : "", where ? where : "");
+        return EIO;
+    }
+    return 0;
+}
+
+/**
+ * Score the records of one region; windows are start-owned, so records
+ * starting before the window (read again by the previous one) are skipped
+ */
+static int score_worker_region(score_worker_t* w, const char* region) {
+    score_ctx_t* ctx = w->ctx;
+    hts_itr_t* itr = ctx->tbx ? tbx_itr_querys(ctx->tbx, region)
+                              : bcf_itr_querys(ctx->idx, w->hdr, region);
+    if (!itr) {
+        snprintf(w->error, sizeof(w->error), "Failed to query region: %s", region);
+        return EINVAL;
+    }
+    hts_pos_t beg = itr->beg;
+    int ret, rec_ret = 0;
+    for (;;) {
+        if (ctx->tbx) {
+            ret = tbx_itr_next(w->fp, ctx->tbx, itr, &w->kstr);
+            if (ret >= 0) {
+                ret = vcf_parse1(&w->kstr, w->hdr, w->rec);
+                w->kstr.l = 0;
+            }
+        } else {
+            ret = bcf_itr_next(w->fp, itr, w->rec);
+            // Region reads skip the sample subsetting bcf_read() does
+            if (ret >= 0 && w->hdr->keep_samples) ret = bcf_subset_format(w->hdr, w->rec);
+        }
+        if (ret < 0) break;
+        if (w->rec->pos < beg) continue;
+        rec_ret = score_record(w, w->rec);
+        if (rec_ret < 0) break;
+    }
+    hts_itr_destroy(itr);
+    return score_check_record(w, ret, rec_ret, region);
+}
+
+static int score_worker_all(score_worker_t* w) {
+    int ret, rec_ret = 0;
+    while ((ret = bcf_read(w->fp, w->hdr, w->rec)) >= 0) {
+        rec_ret = score_record(w, w->rec);
+        if (rec_ret < 0) break;
+    }
+    return score_check_record(w, ret, rec_ret, NULL);
+}
+
+/**
+ * Claim regions until none are left (or another worker failed)
+ */
+static void score_worker_run(score_worker_t* w) {
+    score_ctx_t* ctx = w->ctx;
+    for (;;) {
+#ifdef VCF_SCORE_USE_THREADS
+        pthread_mutex_lock(&ctx->lock);
+#endif
+        int r = ctx->stop ? ctx->n_regions : ctx->next_region++;
+#ifdef VCF_SCORE_USE_THREADS
+        pthread_mutex_unlock(&ctx->lock);
+#endif
+        if (r >= ctx->n_regions) return;
+        if (score_worker_region(w, ctx->regions[r]) != 0) {
+            w->failed = 1;
+#ifdef VCF_SCORE_USE_THREADS
+            pthread_mutex_lock(&ctx->lock);
+#endif
+            ctx->stop = 1;
+#ifdef VCF_SCORE_USE_THREADS
+            pthread_mutex_unlock(&ctx->lock);
+#endif
+            return;
+        }
+    }
+}
+
+#ifdef VCF_SCORE_USE_THREADS
+static void* score_worker_main(void* arg) {
+    score_worker_run((score_worker_t*)arg);
+    return NULL;
+}
+#endif
+
+// =============================================================================
+// Regions
+// =============================================================================
+
+static void score_load_index(score_ctx_t* ctx, htsFile* fp) {
+    const vcf_score_options_t* opts = ctx->opts;
+    if (opts->handle) {
+        if (vcf_handle_index(opts->handle)) {
+            ctx->idx = opts->handle->idx;
+            ctx->tbx = opts->handle->tbx;
+        }
+        return;
+    }
+    int flags = HTS_IDX_SAVE_REMOTE | HTS_IDX_SILENT_FAIL;
+    if (fp->format.format == vcf) {
+        ctx->tbx = tbx_index_load3(ctx->filename, ctx->index, flags);
+        if (ctx->tbx) {
+            ctx->idx = ctx->tbx->idx;
+            ctx->owns_index = 1;
+            return;
+        }
+    }
+    ctx->idx = bcf_index_load3(ctx->filename, ctx->index, flags);
+    ctx->owns_index = ctx->idx != NULL;
+}
+
+/**
+ * Size-balanced regions of the contigs that can hold a marker
+ */
+static int score_plan_regions(score_ctx_t* ctx, const bcf_hdr_t* hdr, int n_threads) {
+    vcf_region_plan_t plan;
+    int ret = vcf_region_plan_build(ctx->idx, ctx->tbx, hdr, n_threads, &plan);
+    if (ret != 0) return ret;
+
+    ctx->regions = (char**)calloc(plan.n_units > 0 ? plan.n_units : 1, sizeof(char*));
+    if (!ctx->regions) {
+        vcf_region_plan_destroy(&plan);
+        return ENOMEM;
+    }
+    for (int i = 0; i < plan.n_units; i++) {
+        if (ctx->contig_has_markers) {
+            int rid = bcf_hdr_name2id(hdr, plan.units[i].contig);
+            if (rid < 0 || !ctx->contig_has_markers[rid]) continue;
+        }
+        ctx->regions[ctx->n_regions++] = plan.units[i].region;
+        plan.units[i].region = NULL;
+    }
+    vcf_region_plan_destroy(&plan);
+    return 0;
+}
+
+static void score_ctx_destroy(score_ctx_t* ctx) {
+    if (ctx->by_pos) kh_destroy(score_pos, ctx->by_pos);
+    if (ctx->by_id) kh_destroy(score_id, ctx->by_id);
+    free(ctx->next);
+    free(ctx->contig_has_markers);
+    for (int i = 0; i < ctx->n_regions; i++) free(ctx->regions[i]);
+    free(ctx->regions);
+    if (ctx->owns_index) {
+        if (ctx->tbx) tbx_destroy(ctx->tbx);
+        else if (ctx->idx) hts_idx_destroy(ctx->idx);
+    }
+}
+
+// =============================================================================
+// Entry point
+// =============================================================================
+
+void vcf_score_result_free(vcf_score_result_t* result) {
+    if (!result) return;
+    if (result->samples) {
+        for (int i = 0; i < result->n_samples; i++) free(result->samples[i]);
+        free(result->samples);
+    }
+    free(result->scores);
+    free(result->counts);
+    free(result->n_matched);
+    memset(result, 0, sizeof(*result));
+}
+
+int vcf_score_run(const char* filename, const vcf_score_options_t* opts,
+                  vcf_score_result_t* result, char* err, size_t err_len) {
+    memset(result, 0, sizeof(*result));
+    if (err && err_len) err[0] = '\0';
+    if (opts->n_scores < 1 || !opts->effect_allele || !opts->weights ||
+        (!opts->id && (!opts->chrom || !opts->pos))) {
+        score_error(err, err_len, "Weights need effect alleles, weights, and CHROM/POS or ID");
+        return EINVAL;
+    }
+
+    score_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.opts = opts;
+    ctx.filename = opts->handle ? opts->handle->filename : filename;
+    ctx.index = opts->handle ? opts->handle->index : opts->index;
+
+    score_worker_t* workers = NULL;
+    int n_workers = 0;
+    int ret = 0;
+
+    // The main reader: header, tag, lookup and, without an index, the scan
+    score_worker_t main_w;
+    memset(&main_w, 0, sizeof(main_w));
+    htsFile* fp = hts_open(ctx.filename, "r");
+    bcf_hdr_t* hdr = fp ? bcf_hdr_read(fp) : NULL;
+    if (!fp) {
+        score_error(err, err_len, "Failed to open file: %s", ctx.filename);
+        ret = ENOENT;
+        goto done;
+    }
+    if (!hdr) {
+        score_error(err, err_len, "Failed to read VCF/BCF header");
+        ret = EIO;
+        goto done;
+    }
+    if (opts->samples) {
+        int r = bcf_hdr_set_samples(hdr, opts->samples, 0);
+        if (r != 0) {
+            if (r > 0) score_error(err, err_len, "Sample #%d not found in the header", r);
+            else score_error(err, err_len, "Failed to set samples filter");
+            ret = EINVAL;
+            goto done;
+        }
+    }
+    ctx.n_samples = bcf_hdr_nsamples(hdr);
+    if (ctx.n_samples == 0) {
+        score_error(err, err_len, "The file has no samples to score");
+        ret = EINVAL;
+        goto done;
+    }
+    ctx.use_tag = score_resolve_tag(hdr, opts->use_tag);
+    if (ctx.use_tag < 0) {
+        if (opts->use_tag == VCF_SCORE_AUTO) {
+            score_error(err, err_len, "The file has none of the GT, DS, HDS, AP1/AP2 or GP FORMAT fields");
+        } else if (opts->use_tag == VCF_SCORE_AP) {
+            score_error(err, err_len, "The file does not have the AP1 and AP2 FORMAT fields");
+        } else {
+            score_error(err, err_len, "The file does not have the %s FORMAT field",
+                        vcf_score_tag_name(opts->use_tag) ? vcf_score_tag_name(opts->use_tag) : "requested");
+        }
+        ret = EINVAL;
+        goto done;
+    }
+    ret = score_build_lookup(&ctx, hdr);
+    if (ret != 0) {
+        score_error(err, err_len, "Out of memory building the marker lookup");
+        goto done;
+    }
+
+    int n_threads = opts->threads > 0 ? opts->threads : 1;
+    score_load_index(&ctx, fp);
+
+    if (!ctx.idx) {
+        // Sequential scan on the main reader
+        main_w.ctx = &ctx;
+        main_w.fp = fp;
+        main_w.hdr = hdr;
+        fp = NULL;
+        hdr = NULL;
+        n_workers = 1;
+        workers = &main_w;
+        main_w.rec = bcf_init();
+        int n = ctx.n_samples;
+        main_w.missing = (uint8_t*)calloc(n, 1);
+        main_w.scores = (double*)calloc((size_t)n * opts->n_scores, sizeof(double));
+        main_w.counts = (int32_t*)calloc((size_t)n * opts->n_scores, sizeof(int32_t));
+        main_w.n_matched = (int64_t*)calloc(opts->n_scores, sizeof(int64_t));
+        if (!main_w.rec || !main_w.missing || !main_w.scores || !main_w.counts || !main_w.n_matched) {
+            score_error(err, err_len, "Out of memory");
+            ret = ENOMEM;
+            goto done;
+        }
+        ret = score_worker_all(&main_w);
+        if (ret != 0) {
+            score_error(err, err_len, "%s", main_w.error);
+            goto done;
+        }
+    } else {
+        ret = score_plan_regions(&ctx, hdr, n_threads);
+        if (ret != 0) {
+            score_error(err, err_len, "Failed to plan regions from the index");
+            goto done;
+        }
+        n_workers = n_threads < ctx.n_regions ? n_threads : ctx.n_regions;
+        if (n_workers < 1) n_workers = 1;
+        workers = (score_worker_t*)calloc(n_workers, sizeof(score_worker_t));
+        if (!workers) {
+            score_error(err, err_len, "Out of memory");
+            ret = ENOMEM;
+            n_workers = 0;
+            goto done;
+        }
+        for (int i = 0; i < n_workers; i++) {
+            ret = score_worker_init(&workers[i], &ctx);
+            if (ret != 0) {
+                score_error(err, err_len, "%s", workers[i].error);
+                goto done;
+            }
+        }
+
+#ifdef VCF_SCORE_USE_THREADS
+        pthread_mutex_init(&ctx.lock, NULL);
+        pthread_t* threads = n_workers > 1 ? (pthread_t*)calloc(n_workers - 1, sizeof(pthread_t)) : NULL;
+        int n_started = 0;
+        if (threads) {
+            for (; n_started < n_workers - 1; n_started++) {
+                if (pthread_create(&threads[n_started], NULL, score_worker_main,
+                                   &workers[n_started + 1]) != 0) {
+                    break;
+                }
+            }
+        }
+        // The calling thread is the first worker
+        score_worker_run(&workers[0]);
+        for (int i = 0; i < n_started; i++) pthread_join(threads[i], NULL);
+        free(threads);
+        pthread_mutex_destroy(&ctx.lock);
+#else
+        score_worker_run(&workers[0]);
+#endif
+        for (int i = 0; i < n_workers; i++) {
+            if (workers[i].failed) {
+                score_error(err, err_len, "%s", workers[i].error);
+                ret = EIO;
+                goto done;
+            }
+        }
+    }
+
+    // Sum the per-worker arrays
+    {
+        int n = ctx.n_samples, n_scores = opts->n_scores;
+        size_t cells = (size_t)n * n_scores;
+        result->n_samples = n;
+        result->n_scores = n_scores;
+        result->use_tag = ctx.use_tag;
+        result->samples = (char**)calloc(n, sizeof(char*));
+        result->scores = (double*)calloc(cells, sizeof(double));
+        result->counts = (int32_t*)calloc(cells, sizeof(int32_t));
+        result->n_matched = (int64_t*)calloc(n_scores, sizeof(int64_t));
+        if (!result->samples || !result->scores || !result->counts || !result->n_matched) {
+            score_error(err, err_len, "Out of memory");
+            ret = ENOMEM;
+            goto done;
+        }
+        const bcf_hdr_t* shdr = workers[0].hdr;
+        for (int k = 0; k < n; k++) {
+            result->samples[k] = strdup(shdr->samples[k]);
+            if (!result->samples[k]) {
+                score_error(err, err_len, "Out of memory");
+                ret = ENOMEM;
+                goto done;
+            }
+        }
+        for (int i = 0; i < n_workers; i++) {
+            const score_worker_t* w = &workers[i];
+            for (size_t c = 0; c < cells; c++) {
+                result->scores[c] += w->scores[c];
+                result->counts[c] += w->counts[c];
+            }
+            for (int s = 0; s < n_scores; s++) result->n_matched[s] += w->n_matched[s];
+            result->n_records += w->n_records;
+        }
+    }
+
+done:
+    if (workers) {
+        for (int i = 0; i < n_workers; i++) score_worker_destroy(&workers[i]);
+        if (workers != &main_w) free(workers);
+    }
+    if (hdr) bcf_hdr_destroy(hdr);
+    if (fp) hts_close(fp);
+    score_ctx_destroy(&ctx);
+    if (ret != 0) vcf_score_result_free(result);
+    return ret;
+}
@@ -0,0 +1,107 @@
+// Polygenic scores over indexed VCF/BCF files
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#ifndef VCF_SCORE_H
+#define VCF_SCORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "vcf_handle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** FORMAT fields a dosage can be computed from (numbering of bcftools +score) */
+#define VCF_SCORE_AUTO 0
+#define VCF_SCORE_GT 1    // Genotypes
+#define VCF_SCORE_DS 2    // Genotype dosages, Number=A
+#define VCF_SCORE_HDS 3   // Haploid dosages (Minimac4), Number=2
+#define VCF_SCORE_AP 4    // ALT probabilities of each haplotype, AP1 and AP2
+#define VCF_SCORE_GP 5    // Genotype probabilities, Number=G
+#define VCF_SCORE_AS 6    // Allelic shifts (1/-1)
+
+/**
+ * Weights and reading options.
+ *
+ * Markers are matched either by CHROM and POS (@c chrom and @c pos set) or
+ * by the ID column (@c id set). Several markers may share a position (split
+ * multiallelic sites); each is matched on its effect allele, which may be
+ * the REF or any ALT allele.
+ */
+typedef struct {
+    int64_t n_markers;
+    const char** chrom;          // Per marker, or NULL to match by ID
+    const int64_t* pos;          // 1-based positions
+    const char** id;             // Per marker, or NULL to match by position
+    const char** effect_allele;  // Matched case-insensitively
+    const double* weights;       // n_markers x n_scores, column-major; NaN
+                                 // leaves the marker out of that score
+    int n_scores;
+
+    int use_tag;                 // VCF_SCORE_*; AUTO picks DS, GP, AP, HDS
+                                 // then GT, as bcftools +score does
+    const char* samples;         // Comma-separated subset, or NULL for all
+    const char* index;           // Explicit index path, or NULL
+    vcf_handle_t* handle;        // Optional handle whose index is borrowed
+    int threads;                 // Worker threads over index regions
+} vcf_score_options_t;
+
+typedef struct {
+    int n_samples;
+    char** samples;              // Sample names (owned)
+    int n_scores;
+    double* scores;              // n_samples x n_scores, column-major
+    int32_t* counts;             // Markers contributing to each score
+    int64_t* n_matched;          // Markers matched per score
+    int use_tag;                 // FORMAT field used
+    int64_t n_records;           // Records read
+} vcf_score_result_t;
+
+/**
+ * @brief Defaults: all samples, tag detected from the header, one thread
+ */
+void vcf_score_options_init(vcf_score_options_t* opts);
+
+/**
+ * @brief Name of a VCF_SCORE_* tag ("GT", "DS", ...), or NULL
+ */
+const char* vcf_score_tag_name(int tag);
+
+/**
+ * @brief Compute polygenic scores in one pass over a VCF/BCF file
+ *
+ * Ports the dosage and weight matching of the bcftools +score plugin. For
+ * each record whose position (or ID) and allele match a marker, the dosage
+ * of the effect allele is taken from @c use_tag for every sample and added,
+ * times each weight, to the sample's scores; samples with a missing value
+ * are left out of that marker. FORMAT fields are only decoded for matched
+ * records.
+ *
+ * With an index, the contigs that hold markers (all contigs when matching
+ * by ID) are split into size-balanced regions (see vcf_region_plan_build())
+ * that @c threads workers claim in turn, each with its own file handle and
+ * its own score and count arrays; these are summed once all regions are
+ * read. Without an index the file is read sequentially.
+ *
+ * @param filename Path or URL (ignored when opts->handle is set)
+ * @param opts Weights and options
+ * @param result Output, free with vcf_score_result_free()
+ * @param err Buffer for an error message
+ * @param err_len Size of @p err
+ * @return 0 on success, non-zero (errno value) on failure
+ */
+int vcf_score_run(const char* filename, const vcf_score_options_t* opts,
+                  vcf_score_result_t* result, char* err, size_t err_len);
+
+/**
+ * @brief Free the arrays of a result
+ */
+void vcf_score_result_free(vcf_score_result_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_SCORE_H
@@ -0,0 +1,124 @@
+/**
+ * vcf_score_r.c - R bindings for polygenic scores over VCF/BCF files
+ *
+ * Copyright (c) 2026 RBCFTools Authors
+ * Licensed under MIT License
+ */
+
+#define R_NO_REMAP
+#include <R.h>
+#include <Rinternals.h>
+#include <string.h>
+#include "vcf_score.h"
+
+extern vcf_handle_t* vcf_handle_from_sexp(SEXP handle_sexp);
+
+// Character vector as C strings, NA as NULL
+static const char** score_strings(SEXP x, R_xlen_t n, const char* what) {
+    if (TYPEOF(x) != STRSXP || XLENGTH(x) != n) {
+        Rf_error("%s must be a character vector with one entry per marker", what);
+    }
+    const char** out = (const char**)R_alloc(n > 0 ? n : 1, sizeof(char*));
+    for (R_xlen_t i = 0; i < n; i++) {
+        SEXP s = STRING_ELT(x, i);
+        out[i] = s == NA_STRING ? NULL : CHAR(s);
+    }
+    return out;
+}
+
+/**
+ * RC_vcf_score - Polygenic scores of the samples of a VCF/BCF file
+ *
+ * @param file_sexp Path to a VCF/BCF file, or a vcf_handle
+ * @param index_sexp Explicit index path (or R_NilValue)
+ * @param chrom_sexp Marker contigs (or R_NilValue to match by ID)
+ * @param pos_sexp Marker 1-based positions (numeric)
+ * @param id_sexp Marker IDs (or R_NilValue to match by position)
+ * @param allele_sexp Effect alleles
+ * @param weights_sexp Numeric matrix, one row per marker and one column per
+ *        score; NA leaves a marker out of a score
+ * @param tag_sexp FORMAT field (VCF_SCORE_* code, 0 to detect)
+ * @param samples_sexp Comma-separated sample subset (or R_NilValue)
+ * @param threads_sexp Number of worker threads
+ * @return List with samples, scores and counts (matrices), n_matched,
+ *         tag and n_records
+ */
+SEXP RC_vcf_score(SEXP file_sexp, SEXP index_sexp, SEXP chrom_sexp, SEXP pos_sexp,
+                  SEXP id_sexp, SEXP allele_sexp, SEXP weights_sexp, SEXP tag_sexp,
+                  SEXP samples_sexp, SEXP threads_sexp) {
+    vcf_score_options_t opts;
+    vcf_score_options_init(&opts);
+
+    const char* filename = NULL;
+    if (TYPEOF(file_sexp) == EXTPTRSXP) {
+        opts.handle = vcf_handle_from_sexp(file_sexp);
+    } else if (TYPEOF(file_sexp) == STRSXP && Rf_length(file_sexp) == 1) {
+        filename = CHAR(STRING_ELT(file_sexp, 0));
+    } else {
+        Rf_error("filename must be a single character string or a vcf_handle");
+    }
+    if (!Rf_isNull(index_sexp) && TYPEOF(index_sexp) == STRSXP) {
+        opts.index = CHAR(STRING_ELT(index_sexp, 0));
+    }
+
+    if (TYPEOF(weights_sexp) != REALSXP || !Rf_isMatrix(weights_sexp)) {
+        Rf_error("weights must be a numeric matrix");
+    }
+    R_xlen_t n_markers = Rf_nrows(weights_sexp);
+    opts.n_markers = n_markers;
+    opts.n_scores = Rf_ncols(weights_sexp);
+    opts.weights = REAL(weights_sexp);
+    opts.effect_allele = score_strings(allele_sexp, n_markers, "effect_allele");
+
+    if (!Rf_isNull(id_sexp)) {
+        opts.id = score_strings(id_sexp, n_markers, "ID");
+    } else {
+        opts.chrom = score_strings(chrom_sexp, n_markers, "CHROM");
+        if (TYPEOF(pos_sexp) != REALSXP || XLENGTH(pos_sexp) != n_markers) {
+            Rf_error("POS must be a numeric vector with one entry per marker");
+        }
+        int64_t* pos = (int64_t*)R_alloc(n_markers > 0 ? n_markers : 1, sizeof(int64_t));
+        for (R_xlen_t i = 0; i < n_markers; i++) {
+            double p = REAL(pos_sexp)[i];
+            pos[i] = ISNAN(p) ? 0 : (int64_t)p;
+        }
+        opts.pos = pos;
+    }
+
+    opts.use_tag = Rf_asInteger(tag_sexp);
+    if (opts.use_tag == NA_INTEGER) opts.use_tag = VCF_SCORE_AUTO;
+    if (!Rf_isNull(samples_sexp)) opts.samples = CHAR(STRING_ELT(samples_sexp, 0));
+    opts.threads = Rf_asInteger(threads_sexp);
+    if (opts.threads == NA_INTEGER || opts.threads < 1) opts.threads = 1;
+
+    vcf_score_result_t res;
+    char error_msg[1024];
+    if (vcf_score_run(filename, &opts, &res, error_msg, sizeof(error_msg)) != 0) {
+        Rf_error("%s", error_msg);
+    }
+
+    // Copy the result into R objects, then free it
+    int n = res.n_samples, n_scores = res.n_scores;
+    SEXP samples = PROTECT(Rf_allocVector(STRSXP, n));
+    SEXP scores = PROTECT(Rf_allocMatrix(REALSXP, n, n_scores));
+    SEXP counts = PROTECT(Rf_allocMatrix(INTSXP, n, n_scores));
+    SEXP matched = PROTECT(Rf_allocVector(REALSXP, n_scores));
+    for (int k = 0; k < n; k++) SET_STRING_ELT(samples, k, Rf_mkChar(res.samples[k]));
+    memcpy(REAL(scores), res.scores, (size_t)n * n_scores * sizeof(double));
+    memcpy(INTEGER(counts), res.counts, (size_t)n * n_scores * sizeof(int32_t));
+    for (int s = 0; s < n_scores; s++) REAL(matched)[s] = (double)res.n_matched[s];
+    SEXP tag = PROTECT(Rf_mkString(vcf_score_tag_name(res.use_tag)));
+    SEXP n_records = PROTECT(Rf_ScalarReal((double)res.n_records));
+    vcf_score_result_free(&res);
+
+    const char* names[] = {"samples", "scores", "counts", "n_matched", "tag", "n_records", ""};
+    SEXP out = PROTECT(Rf_mkNamed(VECSXP, names));
+    SET_VECTOR_ELT(out, 0, samples);
+    SET_VECTOR_ELT(out, 1, scores);
+    SET_VECTOR_ELT(out, 2, counts);
+    SET_VECTOR_ELT(out, 3, matched);
+    SET_VECTOR_ELT(out, 4, tag);
+    SET_VECTOR_ELT(out, 5, n_records);
+    UNPROTECT(7);
+    return out;
+}
@@ -0,0 +1,545 @@
+// Synthetic VCF/BCF generator for scale tests
+// Writes sorted records with configurable samples, ploidy, missingness,
+// FORMAT fields, INFO/CSQ density and contigs through htslib, one record at
+// a time, so 10k-100k sample files can be produced without biobank data.
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#include "vcf_simulate.h"
+#include "vcf_index_build.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "htslib/hts.h"
+#include "htslib/kstring.h"
+#include "htslib/vcf.h"
+
+// GRCh38 autosomes
+static const char* default_contigs[] = {
+    "chr1", "chr2", "chr3", "chr4", "chr5", "chr6", "chr7", "chr8",
+    "chr9", "chr10", "chr11", "chr12", "chr13", "chr14", "chr15", "chr16",
+    "chr17", "chr18", "chr19", "chr20", "chr21", "chr22"
+};
+static const int64_t default_lengths[] = {
+    248956422, 242193529, 198295559, 190214555, 181538259, 170805979,
+    159345973, 145138636, 138394717, 133797422, 135086622, 133275309,
+    114364328, 107043718, 101991189, 90338345, 83257441, 80373285,
+    58617616, 64444167, 46709983, 50818468
+};
+
+#define SIM_MAX_PLOIDY 8
+#define SIM_MAX_ALLELES 3
+
+#define SIM_CSQ_FORMAT "Allele|Consequence|IMPACT|SYMBOL|Gene|Feature_type|Feature|" \
+                       "BIOTYPE|EXON|INTRON|HGVSc|HGVSp|cDNA_position|CDS_position|" \
+                       "Protein_position|Amino_acids|Codons|Existing_variation|AF|gnomADe_AF"
+
+void vcf_simulate_options_init(vcf_simulate_options_t* opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->n_records = 10000;
+    opts->n_samples = 100;
+    opts->ploidy = 2;
+    opts->missing_rate = 0.01;
+    opts->multiallelic_rate = 0.1;
+    opts->format_fields = VCF_SIM_FMT_GT | VCF_SIM_FMT_AD | VCF_SIM_FMT_DP |
+                          VCF_SIM_FMT_GQ | VCF_SIM_FMT_PL;
+    opts->n_info = 4;
+    opts->csq_rate = 0.0;
+    opts->n_csq = 3;
+    opts->seed = 1;
+    opts->threads = 0;
+    opts->write_index = 0;
+}
+
+// =============================================================================
+// Random numbers
+// =============================================================================
+
+// xorshift64*: fast, and reproducible across platforms for a given seed
+typedef struct {
+    uint64_t state;
+} sim_rng_t;
+
+static void sim_seed(sim_rng_t* rng, uint64_t seed) {
+    // splitmix64 so that small seeds still give a well-mixed nonzero state
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    rng->state = (z ^ (z >> 31)) | 1;
+}
+
+static uint32_t sim_rand(sim_rng_t* rng) {
+    rng->state ^= rng->state >> 12;
+    rng->state ^= rng->state << 25;
+    rng->state ^= rng->state >> 27;
+    return (uint32_t)((rng->state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// Uniform in [0, 1)
+static double sim_unif(sim_rng_t* rng) {
+    return sim_rand(rng) / 4294967296.0;
+}
+
+// =============================================================================
+// Header
+// =============================================================================
+
+static bcf_hdr_t* sim_header(const vcf_simulate_options_t* o, const char* const* contigs,
+                             const int64_t* lengths) {
+    bcf_hdr_t* hdr = bcf_hdr_init("w");
+    if (!hdr) return NULL;
+    kstring_t line = {0, 0, NULL};
+    int ret = 0;
+
+    bcf_hdr_append(hdr, "##source=RBCFTools::vcf_simulate");
+    bcf_hdr_append(hdr, "##FILTER=<ID=LowQual,Description=\"Low quality\">");
+    for (int i = 0; i < o->n_contigs && ret == 0; i++) {
+        line.l = 0;
+        ksprintf(&line, "##contig=<ID=%s,length=%lld>", contigs[i], (long long)lengths[i]);
+        ret = bcf_hdr_append(hdr, line.s);
+    }
+
+    bcf_hdr_append(hdr, "##INFO=<ID=AF,Number=A,Type=Float,Description=\"Allele frequency\">");
+    if (o->n_samples > 0 && (o->format_fields & VCF_SIM_FMT_GT)) {
+        bcf_hdr_append(hdr, "##INFO=<ID=AC,Number=A,Type=Integer,"
+                            "Description=\"Allele count in genotypes\">");
+        bcf_hdr_append(hdr, "##INFO=<ID=AN,Number=1,Type=Integer,"
+                            "Description=\"Total number of alleles in called genotypes\">");
+    }
+    for (int i = 0; i < o->n_info && ret == 0; i++) {
+        line.l = 0;
+        switch (i % 4) {
+        case 0:
+            ksprintf(&line, "##INFO=<ID=I%d,Number=1,Type=Integer,Description=\"Integer\">", i);
+            break;
+        case 1:
+            ksprintf(&line, "##INFO=<ID=F%d,Number=A,Type=Float,Description=\"Per-allele float\">", i);
+            break;
+        case 2:
+            ksprintf(&line, "##INFO=<ID=S%d,Number=1,Type=String,Description=\"String\">", i);
+            break;
+        default:
+            ksprintf(&line, "##INFO=<ID=G%d,Number=0,Type=Flag,Description=\"Flag\">", i);
+            break;
+        }
+        ret = bcf_hdr_append(hdr, line.s);
+    }
+    if (o->csq_rate > 0 && o->n_csq > 0) {
+        bcf_hdr_append(hdr, "##INFO=<ID=CSQ,Number=.,Type=String,Description=\"Consequence "
+                            "annotations from Ensembl VEP. Format: " SIM_CSQ_FORMAT "\">");
+    }
+
+    if (o->n_samples > 0) {
+        if (o->format_fields & VCF_SIM_FMT_GT)
+            bcf_hdr_append(hdr, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">");
+        if (o->format_fields & VCF_SIM_FMT_AD)
+            bcf_hdr_append(hdr, "##FORMAT=<ID=AD,Number=R,Type=Integer,Description=\"Allelic depths\">");
+        if (o->format_fields & VCF_SIM_FMT_DP)
+            bcf_hdr_append(hdr, "##FORMAT=<ID=DP,Number=1,Type=Integer,Description=\"Read depth\">");
+        if (o->format_fields & VCF_SIM_FMT_GQ)
+            bcf_hdr_append(hdr, "##FORMAT=<ID=GQ,Number=1,Type=Integer,Description=\"Genotype quality\">");
+        if (o->format_fields & VCF_SIM_FMT_PL)
+            bcf_hdr_append(hdr, "##FORMAT=<ID=PL,Number=G,Type=Integer,"
+                                "Description=\"Phred-scaled genotype likelihoods\">");
+        for (int i = 0; i < o->n_samples && ret == 0; i++) {
+            line.l = 0;
+            ksprintf(&line, "S%06d", i + 1);
+            ret = bcf_hdr_add_sample(hdr, line.s);
+        }
+    }
+    free(line.s);
+
+    if (ret < 0 || bcf_hdr_add_sample(hdr, NULL) < 0 || bcf_hdr_sync(hdr) < 0) {
+        bcf_hdr_destroy(hdr);
+        return NULL;
+    }
+    return hdr;
+}
+
+// =============================================================================
+// Records
+// =============================================================================
+
+// Genotypes of `ploidy` alleles drawn from n_all alleles (Number=G)
+static int sim_n_genotypes(int n_all, int ploidy) {
+    // C(n_all + ploidy - 1, ploidy)
+    int64_t n = 1;
+    for (int k = 1; k <= ploidy; k++) n = n * (n_all - 1 + k) / k;
+    return (int)n;
+}
+
+static void sim_csq(sim_rng_t* rng, kstring_t* s, int n_csq, const char* alt) {
+    static const char* consequences[] = {
+        "missense_variant", "synonymous_variant", "intron_variant",
+        "upstream_gene_variant", "3_prime_UTR_variant", "stop_gained"
+    };
+    static const char* impacts[] = {"MODERATE", "LOW", "MODIFIER", "MODIFIER",
+                                    "MODIFIER", "HIGH"};
+
+    s->l = 0;
+    for (int t = 0; t < n_csq; t++) {
+        int k = sim_rand(rng) % 6;
+        uint32_t gene = sim_rand(rng) % 20000;
+        if (t > 0) kputc(',', s);
+        ksprintf(s, "%s|%s|%s|GENE%u|ENSG%011u|Transcript|ENST%011u|protein_coding|"
+                    "%d/12||ENST%011u.1:c.%uA>G|ENSP%011u.1:p.Lys%uGlu|%u|%u|%u|K/E|"
+                    "Aag/Gag|rs%u|0.%04u|0.%04u",
+                 alt, consequences[k], impacts[k], gene, gene, gene * 10 + t,
+                 1 + t % 12, gene * 10 + t, sim_rand(rng) % 3000,
+                 gene * 10 + t, sim_rand(rng) % 1000, sim_rand(rng) % 3000,
+                 sim_rand(rng) % 3000, sim_rand(rng) % 1000, sim_rand(rng),
+                 sim_rand(rng) % 10000, sim_rand(rng) % 10000);
+    }
+}
+
+typedef struct {
+    int32_t* gt;
+    int32_t* ad;
+    int32_t* dp;
+    int32_t* gq;
+    int32_t* pl;
+    float* fvals;
+    kstring_t str;
+} sim_buffers_t;
+
+static void sim_buffers_free(sim_buffers_t* b) {
+    free(b->gt);
+    free(b->ad);
+    free(b->dp);
+    free(b->gq);
+    free(b->pl);
+    free(b->fvals);
+    free(b->str.s);
+}
+
+static int sim_buffers_init(sim_buffers_t* b, int n_samples, int ploidy) {
+    memset(b, 0, sizeof(*b));
+    size_t ns = n_samples > 0 ? (size_t)n_samples : 1;
+    size_t n_gt = (size_t)sim_n_genotypes(SIM_MAX_ALLELES, ploidy);
+    b->gt = (int32_t*)malloc(ns * ploidy * sizeof(int32_t));
+    b->ad = (int32_t*)malloc(ns * SIM_MAX_ALLELES * sizeof(int32_t));
+    b->dp = (int32_t*)malloc(ns * sizeof(int32_t));
+    b->gq = (int32_t*)malloc(ns * sizeof(int32_t));
+    b->pl = (int32_t*)malloc(ns * n_gt * sizeof(int32_t));
+    b->fvals = (float*)malloc(SIM_MAX_ALLELES * sizeof(float));
+    if (!b->gt || !b->ad || !b->dp || !b->gq || !b->pl || !b->fvals) {
+        sim_buffers_free(b);
+        return -1;
+    }
+    return 0;
+}
+
+// Per-sample FORMAT values. Genotypes follow the site's allele frequencies;
+// depths and likelihoods are consistent with the genotype, which is enough
+// for filters and aggregations to return plausible results.
+static int sim_format(sim_rng_t* rng, const vcf_simulate_options_t* o, bcf_hdr_t* hdr,
+                      bcf1_t* rec, sim_buffers_t* b, const double* af, int n_alt) {
+    int ns = o->n_samples;
+    int ploidy = o->ploidy;
+    int n_all = n_alt + 1;
+    int n_gt = sim_n_genotypes(n_all, ploidy);
+    int32_t ac[SIM_MAX_ALLELES] = {0};
+    int32_t an = 0;
+
+    for (int s = 0; s < ns; s++) {
+        int32_t* gt = b->gt + (size_t)s * ploidy;
+        int32_t* ad = b->ad + (size_t)s * n_all;
+        int32_t* pl = b->pl + (size_t)s * n_gt;
+
+        if (o->missing_rate > 0 && sim_unif(rng) < o->missing_rate) {
+            for (int p = 0; p < ploidy; p++) gt[p] = bcf_gt_missing;
+            ad[0] = bcf_int32_missing;
+            for (int a = 1; a < n_all; a++) ad[a] = bcf_int32_vector_end;
+            pl[0] = bcf_int32_missing;
+            for (int g = 1; g < n_gt; g++) pl[g] = bcf_int32_vector_end;
+            b->dp[s] = bcf_int32_missing;
+            b->gq[s] = bcf_int32_missing;
+            continue;
+        }
+
+        int counts[SIM_MAX_ALLELES] = {0};
+        for (int p = 0; p < ploidy; p++) {
+            double u = sim_unif(rng);
+            int allele = 0;
+            for (int a = 0; a < n_alt; a++) {
+                if (u < af[a]) {
+                    allele = a + 1;
+                    break;
+                }
+                u -= af[a];
+            }
+            gt[p] = bcf_gt_unphased(allele);
+            counts[allele]++;
+        }
+        for (int a = 1; a < n_all; a++) ac[a] += counts[a];
+        an += ploidy;
+
+        int depth = 0;
+        for (int a = 0; a < n_all; a++) {
+            ad[a] = counts[a] ? (int32_t)(counts[a] * (8 + sim_rand(rng) % 16)) : (int32_t)(sim_rand(rng) % 2);
+            depth += ad[a];
+        }
+        b->dp[s] = depth;
+        b->gq[s] = 20 + sim_rand(rng) % 80;
+
+        // Called genotype gets PL 0 (haploid and diploid; higher ploidies
+        // only mark hom-ref, which keeps the G ordering out of the way)
+        for (int g = 0; g < n_gt; g++) pl[g] = 10 + (int32_t)(sim_rand(rng) % 90);
+        if (ploidy == 1) {
+            pl[bcf_gt_allele(gt[0])] = 0;
+        } else if (ploidy == 2) {
+            pl[bcf_alleles2gt(bcf_gt_allele(gt[0]), bcf_gt_allele(gt[1]))] = 0;
+        } else if (counts[0] == ploidy) {
+            pl[0] = 0;
+        }
+    }
+
+    int ret = 0;
+    if (o->format_fields & VCF_SIM_FMT_GT) {
+        ret |= bcf_update_genotypes(hdr, rec, b->gt, ns * ploidy);
+        ret |= bcf_update_info_int32(hdr, rec, "AC", ac + 1, n_alt);
+        ret |= bcf_update_info_int32(hdr, rec, "AN", &an, 1);
+    }
+    if (o->format_fields & VCF_SIM_FMT_AD)
+        ret |= bcf_update_format_int32(hdr, rec, "AD", b->ad, ns * n_all);
+    if (o->format_fields & VCF_SIM_FMT_DP)
+        ret |= bcf_update_format_int32(hdr, rec, "DP", b->dp, ns);
+    if (o->format_fields & VCF_SIM_FMT_GQ)
+        ret |= bcf_update_format_int32(hdr, rec, "GQ", b->gq, ns);
+    if (o->format_fields & VCF_SIM_FMT_PL)
+        ret |= bcf_update_format_int32(hdr, rec, "PL", b->pl, ns * n_gt);
+    return ret < 0 ? -1 : 0;
+}
+
+static int sim_info(sim_rng_t* rng, const vcf_simulate_options_t* o, bcf_hdr_t* hdr,
+                    bcf1_t* rec, sim_buffers_t* b, int n_alt, const char* alt) {
+    char key[32];
+    int ret = 0;
+
+    for (int i = 0; i < o->n_info; i++) {
+        int32_t ival;
+        switch (i % 4) {
+        case 0:
+            snprintf(key, sizeof(key), "I%d", i);
+            ival = sim_rand(rng) % 1000;
+            ret |= bcf_update_info_int32(hdr, rec, key, &ival, 1);
+            break;
+        case 1:
+            snprintf(key, sizeof(key), "F%d", i);
+            for (int a = 0; a < n_alt; a++) b->fvals[a] = (float)(sim_rand(rng) % 1000) / 1000.0f;
+            ret |= bcf_update_info_float(hdr, rec, key, b->fvals, n_alt);
+            break;
+        case 2:
+            snprintf(key, sizeof(key), "S%d", i);
+            b->str.l = 0;
+            ksprintf(&b->str, "value_%u", sim_rand(rng) % 100);
+            ret |= bcf_update_info_string(hdr, rec, key, b->str.s);
+            break;
+        default:
+            snprintf(key, sizeof(key), "G%d", i);
+            if (sim_rand(rng) % 2) ret |= bcf_update_info_flag(hdr, rec, key, NULL, 1);
+            break;
+        }
+    }
+    if (o->csq_rate > 0 && o->n_csq > 0 && sim_unif(rng) < o->csq_rate) {
+        sim_csq(rng, &b->str, o->n_csq, alt);
+        ret |= bcf_update_info_string(hdr, rec, "CSQ", b->str.s);
+    }
+    return ret < 0 ? -1 : 0;
+}
+
+// =============================================================================
+// Writer
+// =============================================================================
+
+static int sim_has_suffix(const char* s, const char* suffix) {
+    size_t ls = strlen(s), lx = strlen(suffix);
+    return ls >= lx && strcmp(s + ls - lx, suffix) == 0;
+}
+
+static int sim_check_options(const vcf_simulate_options_t* o, char* error_msg, size_t error_len) {
+    if (o->n_records < 0) {
+        snprintf(error_msg, error_len, "n_records must be non-negative");
+    } else if (o->n_samples < 0) {
+        snprintf(error_msg, error_len, "n_samples must be non-negative");
+    } else if (o->ploidy < 1 || o->ploidy > SIM_MAX_PLOIDY) {
+        snprintf(error_msg, error_len, "ploidy must be between 1 and %d", SIM_MAX_PLOIDY);
+    } else if (!(o->missing_rate >= 0 && o->missing_rate <= 1) ||
+               !(o->multiallelic_rate >= 0 && o->multiallelic_rate <= 1) ||
+               !(o->csq_rate >= 0 && o->csq_rate <= 1)) {
+        snprintf(error_msg, error_len, "Rates must be between 0 and 1");
+    } else if (o->n_info < 0 || o->n_csq < 0) {
+        snprintf(error_msg, error_len, "n_info and n_csq must be non-negative");
+    } else if (o->contigs && o->n_contigs <= 0) {
+        snprintf(error_msg, error_len, "At least one contig is required");
+    } else {
+        for (int i = 0; o->contigs && i < o->n_contigs; i++) {
+            if (!o->contigs[i] || !*o->contigs[i] || !o->contig_lengths ||
+                o->contig_lengths[i] < 1) {
+                snprintf(error_msg, error_len, "Contigs need a name and a positive length");
+                return -1;
+            }
+        }
+        return 0;
+    }
+    return -1;
+}
+
+int64_t vcf_simulate_write(const char* path, const vcf_simulate_options_t* opts,
+                           char* error_msg, size_t error_len) {
+    vcf_simulate_options_t o = *opts;
+    if (sim_check_options(&o, error_msg, error_len) < 0) return -1;
+    if (!o.contigs) {
+        o.contigs = default_contigs;
+        o.contig_lengths = default_lengths;
+        o.n_contigs = (int)(sizeof(default_contigs) / sizeof(default_contigs[0]));
+    }
+    if (o.n_samples == 0) o.format_fields = 0;
+
+    const char* mode = sim_has_suffix(path, ".bcf") ? "wb"
+                     : (sim_has_suffix(path, ".vcf.gz") || sim_has_suffix(path, ".vcf.bgz")) ? "wz"
+                     : "w";
+    if (o.write_index && strcmp(mode, "w") == 0) {
+        snprintf(error_msg, error_len,
+                 "Only bgzipped output (.bcf, .vcf.gz) can be indexed: %s", path);
+        return -1;
+    }
+
+    htsFile* fp = hts_open(path, mode);
+    if (!fp) {
+        snprintf(error_msg, error_len, "Cannot create %s: %s", path, strerror(errno));
+        return -1;
+    }
+    if (o.threads > 1) hts_set_threads(fp, o.threads);
+
+    bcf_hdr_t* hdr = sim_header(&o, o.contigs, o.contig_lengths);
+    if (!hdr || bcf_hdr_write(fp, hdr) < 0) {
+        snprintf(error_msg, error_len, hdr ? "Failed to write the header of %s"
+                                           : "Failed to build the header for %s", path);
+        if (hdr) bcf_hdr_destroy(hdr);
+        hts_close(fp);
+        unlink(path);
+        return -1;
+    }
+
+    // Must outlive the file handle until bcf_idx_save()
+    kstring_t fnidx = {0, 0, NULL};
+    if (o.write_index) {
+        ksprintf(&fnidx, "%s.csi", path);
+        if (bcf_idx_init(fp, hdr, VCF_INDEX_CSI_MIN_SHIFT, fnidx.s) < 0) {
+            snprintf(error_msg, error_len, "Failed to start the index of %s", path);
+            free(fnidx.s);
+            bcf_hdr_destroy(hdr);
+            hts_close(fp);
+            unlink(path);
+            return -1;
+        }
+    }
+
+    sim_buffers_t buf;
+    bcf1_t* rec = bcf_init();
+    if (sim_buffers_init(&buf, o.n_samples, o.ploidy) < 0 || !rec) {
+        snprintf(error_msg, error_len, "Out of memory");
+        if (rec) bcf_destroy(rec);
+        free(fnidx.s);
+        bcf_hdr_destroy(hdr);
+        hts_close(fp);
+        unlink(path);
+        return -1;
+    }
+
+    sim_rng_t rng;
+    sim_seed(&rng, o.seed);
+
+    double total_len = 0;
+    for (int c = 0; c < o.n_contigs; c++) total_len += (double)o.contig_lengths[c];
+
+    static const char* bases[] = {"A", "C", "G", "T"};
+    int pass = bcf_hdr_id2int(hdr, BCF_DT_ID, "PASS");
+    int lowqual = bcf_hdr_id2int(hdr, BCF_DT_ID, "LowQual");
+    int64_t written = 0;
+    double cum_len = 0;
+    int ret = 0;
+
+    for (int c = 0; c < o.n_contigs && ret == 0; c++) {
+        // Records proportional to contig length; positions evenly spread
+        // with jitter, so they stay sorted and within the contig
+        int64_t first = (int64_t)(o.n_records * (cum_len / total_len));
+        cum_len += (double)o.contig_lengths[c];
+        int64_t last = c == o.n_contigs - 1 ? o.n_records
+                                            : (int64_t)(o.n_records * (cum_len / total_len));
+        int64_t n = last - first;
+        int64_t len = o.contig_lengths[c];
+        int64_t step = n > 0 ? len / n : len;
+        if (step < 1) step = 1;
+        int rid = bcf_hdr_name2id(hdr, o.contigs[c]);
+
+        for (int64_t i = 0; i < n && ret == 0; i++) {
+            bcf_clear(rec);
+            rec->rid = rid;
+            int64_t pos = (int64_t)((double)i * len / n) + sim_rand(&rng) % step;
+            rec->pos = pos < len ? pos : len - 1;
+            rec->qual = (float)(sim_rand(&rng) % 10000) / 10.0f;
+
+            int n_alt = sim_unif(&rng) < o.multiallelic_rate ? 2 : 1;
+            int ref = sim_rand(&rng) % 4;
+            buf.str.l = 0;
+            kputs(bases[ref], &buf.str);
+            for (int a = 1; a <= n_alt; a++) {
+                kputc(',', &buf.str);
+                kputs(bases[(ref + a) % 4], &buf.str);
+            }
+            ret |= bcf_update_alleles_str(hdr, rec, buf.str.s);
+            if (sim_rand(&rng) % 3 == 0) {
+                buf.str.l = 0;
+                ksprintf(&buf.str, "rs%lld", (long long)(written + 1));
+                ret |= bcf_update_id(hdr, rec, buf.str.s);
+            }
+            ret |= bcf_update_filter(hdr, rec, rec->qual < 20 ? &lowqual : &pass, 1);
+
+            // Skewed towards rare variants, as in real cohorts
+            double af[SIM_MAX_ALLELES - 1];
+            float af_out[SIM_MAX_ALLELES - 1];
+            for (int a = 0; a < n_alt; a++) {
+                double u = sim_unif(&rng);
+                af[a] = (0.001 + 0.499 * u * u * u) / n_alt;
+                af_out[a] = (float)af[a];
+            }
+            ret |= bcf_update_info_float(hdr, rec, "AF", af_out, n_alt);
+
+            ret |= sim_info(&rng, &o, hdr, rec, &buf, n_alt, bases[(ref + 1) % 4]);
+            if (o.n_samples > 0 && o.format_fields) {
+                ret |= sim_format(&rng, &o, hdr, rec, &buf, af, n_alt);
+            }
+
+            if (ret == 0 && bcf_write(fp, hdr, rec) < 0) ret = -1;
+            if (ret == 0) written++;
+        }
+    }
+
+    if (ret != 0) {
+        snprintf(error_msg, error_len, "Failed to write record %lld to %s",
+                 (long long)written + 1, path);
+    } else if (o.write_index && bcf_idx_save(fp) < 0) {
+        snprintf(error_msg, error_len, "Failed to write the index %s", fnidx.s);
+        ret = -1;
+    }
+
+    sim_buffers_free(&buf);
+    bcf_destroy(rec);
+    bcf_hdr_destroy(hdr);
+    if (hts_close(fp) != 0 && ret == 0) {
+        snprintf(error_msg, error_len, "Failed to close %s", path);
+        ret = -1;
+    }
+    if (ret != 0) {
+        unlink(path);
+        if (fnidx.s) unlink(fnidx.s);
+    }
+    free(fnidx.s);
+    return ret == 0 ? written : -1;
+}
@@ -0,0 +1,78 @@
+// Synthetic VCF/BCF generator for scale tests
+// Copyright (c) 2026 RBCFTools Authors
+// Licensed under MIT License
+
+#ifndef VCF_SIMULATE_H
+#define VCF_SIMULATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * FORMAT fields the generator knows how to fill
+ */
+typedef enum {
+    VCF_SIM_FMT_GT = 1 << 0,   // Genotype, drawn from a per-site allele frequency
+    VCF_SIM_FMT_AD = 1 << 1,   // Allelic depths (Number=R)
+    VCF_SIM_FMT_DP = 1 << 2,   // Read depth
+    VCF_SIM_FMT_GQ = 1 << 3,   // Genotype quality
+    VCF_SIM_FMT_PL = 1 << 4    // Phred-scaled likelihoods (Number=G)
+} vcf_simulate_format_t;
+
+/**
+ * Options for vcf_simulate_write()
+ */
+typedef struct {
+    int64_t n_records;         // Records, spread over the contigs by length
+    int n_samples;             // 0 writes a sites-only file
+    int ploidy;                // Alleles per genotype (1..8)
+    double missing_rate;       // Probability a sample's FORMAT values are missing
+    double multiallelic_rate;  // Probability a site has two ALT alleles
+    int format_fields;         // Bitmask of vcf_simulate_format_t
+    int n_info;                // Extra INFO fields (Integer, Float, String, Flag in turn)
+    double csq_rate;           // Probability a record carries a CSQ annotation
+    int n_csq;                 // Transcripts per annotated record
+    const char* const* contigs;     // Contig names (NULL: chr1..chr22)
+    const int64_t* contig_lengths;  // Contig lengths (NULL with contigs == NULL)
+    int n_contigs;
+    uint64_t seed;             // Same seed and options give the same file
+    int threads;               // BGZF compression threads
+    int write_index;           // Write a CSI index alongside (bgzipped output only)
+} vcf_simulate_options_t;
+
+/**
+ * @brief Initialize options with defaults
+ *
+ * 10000 records, 100 diploid samples with GT:AD:DP:GQ:PL, 1% missing
+ * samples, 10% multiallelic sites, four INFO fields, no CSQ, chr1..chr22
+ * with GRCh38 lengths, seed 1, single-threaded, no index.
+ */
+void vcf_simulate_options_init(vcf_simulate_options_t* opts);
+
+/**
+ * @brief Write a synthetic VCF/BCF file
+ *
+ * Records are generated and written one at a time, so memory stays at one
+ * record's worth of FORMAT data however large the file. The output type
+ * follows the file name: ".bcf" is BGZF-compressed BCF, ".vcf.gz" and
+ * ".vcf.bgz" bgzipped VCF, anything else plain VCF. Records are sorted, so
+ * bgzipped output can be indexed.
+ *
+ * @param path Output path
+ * @param opts Options
+ * @param error_msg Buffer for an error message
+ * @param error_len Size of @p error_msg
+ * @return Records written, or -1 on error (the partial file is removed)
+ */
+int64_t vcf_simulate_write(const char* path, const vcf_simulate_options_t* opts,
+                           char* error_msg, size_t error_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VCF_SIMULATE_H
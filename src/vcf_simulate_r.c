@@ -0,0 +1,97 @@
+/**
+ * vcf_simulate_r.c - R bindings for the synthetic VCF/BCF generator
+ *
+ * Copyright (c) 2026 RBCFTools Authors
+ * Licensed under MIT License
+ */
+
+#define R_NO_REMAP
+#include <R.h>
+#include <Rinternals.h>
+#include <string.h>
+#include "vcf_simulate.h"
+
+static int format_field_bit(const char* name) {
+    if (strcmp(name, "GT") == 0) return VCF_SIM_FMT_GT;
+    if (strcmp(name, "AD") == 0) return VCF_SIM_FMT_AD;
+    if (strcmp(name, "DP") == 0) return VCF_SIM_FMT_DP;
+    if (strcmp(name, "GQ") == 0) return VCF_SIM_FMT_GQ;
+    if (strcmp(name, "PL") == 0) return VCF_SIM_FMT_PL;
+    return 0;
+}
+
+/**
+ * RC_vcf_simulate - Write a synthetic VCF/BCF file
+ *
+ * @param path_sexp Output path (type from the extension)
+ * @param format_sexp Character vector of FORMAT fields (GT, AD, DP, GQ, PL)
+ * @param contigs_sexp Named numeric vector of contig lengths, or NULL
+ * @return Number of records written
+ */
+SEXP RC_vcf_simulate(SEXP path_sexp, SEXP n_records_sexp, SEXP n_samples_sexp,
+                     SEXP ploidy_sexp, SEXP missing_rate_sexp,
+                     SEXP multiallelic_rate_sexp, SEXP format_sexp, SEXP n_info_sexp,
+                     SEXP csq_rate_sexp, SEXP n_csq_sexp, SEXP contigs_sexp,
+                     SEXP seed_sexp, SEXP threads_sexp, SEXP index_sexp) {
+    if (TYPEOF(path_sexp) != STRSXP || Rf_length(path_sexp) != 1) {
+        Rf_error("output must be a single character string");
+    }
+
+    vcf_simulate_options_t opts;
+    vcf_simulate_options_init(&opts);
+
+    double n_records = Rf_asReal(n_records_sexp);
+    if (ISNAN(n_records) || n_records < 0) Rf_error("n_records must be non-negative");
+    opts.n_records = (int64_t)n_records;
+    opts.n_samples = Rf_asInteger(n_samples_sexp);
+    opts.ploidy = Rf_asInteger(ploidy_sexp);
+    opts.missing_rate = Rf_asReal(missing_rate_sexp);
+    opts.multiallelic_rate = Rf_asReal(multiallelic_rate_sexp);
+    opts.n_info = Rf_asInteger(n_info_sexp);
+    opts.csq_rate = Rf_asReal(csq_rate_sexp);
+    opts.n_csq = Rf_asInteger(n_csq_sexp);
+    opts.seed = (uint64_t)Rf_asReal(seed_sexp);
+    opts.threads = Rf_asInteger(threads_sexp);
+    opts.write_index = Rf_asLogical(index_sexp) == TRUE;
+    if (opts.n_samples == NA_INTEGER || opts.ploidy == NA_INTEGER ||
+        opts.n_info == NA_INTEGER || opts.n_csq == NA_INTEGER) {
+        Rf_error("n_samples, ploidy, n_info and n_csq must not be NA");
+    }
+    if (opts.threads == NA_INTEGER) opts.threads = 0;
+
+    opts.format_fields = 0;
+    if (!Rf_isNull(format_sexp)) {
+        if (TYPEOF(format_sexp) != STRSXP) Rf_error("format must be a character vector");
+        for (R_xlen_t i = 0; i < XLENGTH(format_sexp); i++) {
+            const char* name = CHAR(STRING_ELT(format_sexp, i));
+            int bit = format_field_bit(name);
+            if (!bit) Rf_error("Unsupported FORMAT field: %s (use GT, AD, DP, GQ, PL)", name);
+            opts.format_fields |= bit;
+        }
+    }
+
+    if (!Rf_isNull(contigs_sexp)) {
+        SEXP names = Rf_getAttrib(contigs_sexp, R_NamesSymbol);
+        int n = Rf_length(contigs_sexp);
+        if (TYPEOF(contigs_sexp) != REALSXP || Rf_isNull(names) || n == 0) {
+            Rf_error("contigs must be a named numeric vector of lengths");
+        }
+        const char** contigs = (const char**)R_alloc(n, sizeof(char*));
+        int64_t* lengths = (int64_t*)R_alloc(n, sizeof(int64_t));
+        for (int i = 0; i < n; i++) {
+            contigs[i] = CHAR(STRING_ELT(names, i));
+            double len = REAL(contigs_sexp)[i];
+            lengths[i] = ISNAN(len) ? 0 : (int64_t)len;
+        }
+        opts.contigs = contigs;
+        opts.contig_lengths = lengths;
+        opts.n_contigs = n;
+    }
+
+    char error_msg[512];
+    int64_t written = vcf_simulate_write(CHAR(STRING_ELT(path_sexp, 0)), &opts,
+                                         error_msg, sizeof(error_msg));
+    if (written < 0) Rf_error("%s", error_msg);
+
+    return Rf_ScalarReal((double)written);
+}